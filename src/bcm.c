@@ -0,0 +1,228 @@
+/** ***************************************************************************
+ * @file
+ * @brief Binary code modulation (BCM) of GPIO outputs
+ *
+ * Software PWM for channels without a spare hardware timer, e.g. amber.
+ *
+ * A period is split into BCM_BITS time slices with binary weights
+ * (MSB first: 128, 64, ... 1 LSB for 8 bits).
+ * In each slice an output is on, if the corresponding bit of its value is set.
+ * So the average equals the value, independent of the number of channels,
+ * with only BCM_BITS interrupts per period instead of one per edge.
+ *
+ * The slices are timed with the SysTick timer of the core,
+ * reloaded with the length of the next slice in each interrupt.
+ * @n For each slice the port masks of all channels are precomputed,
+ * so the interrupt writes the outputs with one DOUTSET and one DOUTCLR store.
+ * New masks are double buffered and take effect at the next period.
+ *
+ * @note All channels have to be on the same port (BCM_PORT).
+ * @n The shortest slice must be longer than the interrupt:
+ * at 32 MHz, 500 Hz and 8 bits the LSB is 251 core cycles.
+ * @n SysTick stops in EM2, the energy mode manager uses EM1 while running.
+ *
+ * The ISR load is measured once per period, see BCM_GetLoad():
+ * the exception entry with the SysTick counter (cycles since its reload),
+ * the handler with the cycle counter. Only the exit (12 cycles) is missing.
+ * @n It is measured for the compiled BCM_BITS, for a curve over the
+ * resolution build with other BCM_BITS and query "bcm" each time.
+ * Estimated, not measured, at 32 MHz and 500 Hz: about 60 cycles per
+ * interrupt, i.e. about 0.1 % load per bit (8 bits: 0.75 %).
+ * The LSB slice is the limit: 251 cycles at 8 bits, 125 at 9, 62 at 10,
+ * from 10 bits the interrupt is longer than the LSB.
+ *
+ * Prefix: BCM
+ *
+ * Board:  Starter Kit EFM32-G8XX-STK
+ * Device: EFM32G890F128 (Gecko)
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#include <string.h>
+
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_gpio.h"
+#include "em_core.h"
+
+#include "bcm.h"
+#include "globals.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define BCM_PERIOD_LSB		((1u << BCM_BITS) - 1)	///< period in LSB slices
+
+/** Pins of the channels on BCM_PORT */
+static const uint8_t BCM_pin[BCM_CHANNEL_COUNT] = {
+	BCM_AMBER_PIN,							// BCM_AMBER
+};
+
+/** Precomputed port masks for all slices */
+typedef struct {
+	uint32_t set[BCM_BITS];					///< outputs on in this slice
+	uint32_t clr[BCM_BITS];					///< outputs off in this slice
+} BCM_masks_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+static uint32_t BCM_value[BCM_CHANNEL_COUNT];	///< set points of the channels
+static BCM_masks_t BCM_masks[2];			///< double buffered port masks
+static volatile uint32_t BCM_active = 0;	///< buffer used by the interrupt
+static volatile bool BCM_pending = false;	///< other buffer has new masks
+static volatile bool BCM_running = false;	///< SysTick is running
+static uint32_t BCM_lsb = 0;				///< length of the LSB in core cycles
+static uint32_t BCM_slice = 0;				///< current slice, 0 = MSB
+static uint32_t BCM_isr_cycles = 0;			///< cycles in ISR this period
+static volatile uint32_t BCM_load = 0;		///< ISR load last period in 1/1000
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Length of a slice in core cycles
+ * @param [in] slice 0 = MSB ... BCM_BITS-1 = LSB
+ *****************************************************************************/
+static inline uint32_t BCM_slice_length(uint32_t slice) {
+	return BCM_lsb << (BCM_BITS - 1 - slice);
+}
+
+/** ***************************************************************************
+ * @brief Setup the outputs of all channels
+ *****************************************************************************/
+void BCM_Init(void) {
+	CMU_ClockEnable(cmuClock_GPIO, true);
+	for (uint32_t channel = 0; channel < BCM_CHANNEL_COUNT; channel++) {
+		GPIO_PinModeSet(BCM_PORT, BCM_pin[channel], gpioModePushPull, 0);
+	}
+	BCM_Retune();
+}
+
+/** ***************************************************************************
+ * @brief Recalculate the slice length after the core clock has changed
+ *****************************************************************************/
+void BCM_Retune(void) {
+	BCM_lsb = CMU_ClockFreqGet(cmuClock_CORE) / (BCM_FREQUENCY * BCM_PERIOD_LSB);
+}
+
+/** ***************************************************************************
+ * @brief Set the value of a channel
+ * @param [in] channel number
+ * @param [in] value 0 ... 2^BCM_BITS-1
+ *
+ * The masks of all slices are recalculated.
+ * @n The SysTick is started with the first channel on
+ * and stopped with the last channel off.
+ * @note Called by the main loop and, during a colour stream,
+ * by TIMER0_IRQHandler(). The values, the masks built from them
+ * and the start or stop are therefore one critical section,
+ * a few hundred cycles at most.
+ *****************************************************************************/
+void BCM_Set(uint32_t channel, uint32_t value) {
+	if (channel >= BCM_CHANNEL_COUNT) {
+		return;
+	}
+	if (value > BCM_PERIOD_LSB) { value = BCM_PERIOD_LSB; }
+
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+	BCM_value[channel] = value;
+
+	/* precompute the port masks */
+	BCM_masks_t masks;
+	uint32_t any = 0;
+	for (uint32_t slice = 0; slice < BCM_BITS; slice++) {
+		uint32_t bit = 1u << (BCM_BITS - 1 - slice);
+		masks.set[slice] = 0;
+		masks.clr[slice] = 0;
+		for (uint32_t ch = 0; ch < BCM_CHANNEL_COUNT; ch++) {
+			if (BCM_value[ch] & bit) {
+				masks.set[slice] |= 1u << BCM_pin[ch];
+			} else {
+				masks.clr[slice] |= 1u << BCM_pin[ch];
+			}
+		}
+		any |= masks.set[slice];
+	}
+
+	if (!BCM_running) {
+		if (any) {							// start with the first slice
+			memcpy(&BCM_masks[BCM_active], &masks, sizeof(masks));
+			BCM_pending = false;
+			BCM_running = true;
+			/* a dark lead-in as long as slice 0, the first interrupt
+			 * starts slice 0 and writes the length of slice 1 */
+			BCM_slice = 0;
+			BCM_isr_cycles = 0;
+			SysTick->LOAD = BCM_slice_length(0) - 1;
+			SysTick->VAL = 0;				// reload with the next clock
+			SysTick->CTRL = SysTick_CTRL_CLKSOURCE_Msk | SysTick_CTRL_TICKINT_Msk
+					| SysTick_CTRL_ENABLE_Msk;
+		}
+	} else if (!any) {						// all channels off
+		SysTick->CTRL = 0;
+		BCM_running = false;
+		GPIO->P[BCM_PORT].DOUTCLR = masks.clr[0];
+		BCM_load = 0;
+	} else {								// new masks for the next period
+		memcpy(&BCM_masks[BCM_active ^ 1], &masks, sizeof(masks));
+		BCM_pending = true;
+	}
+	CORE_EXIT_CRITICAL();
+}
+
+/** ***************************************************************************
+ * @brief Check if the BCM is running
+ * @return true = at least one channel is on, the SysTick is needed
+ *****************************************************************************/
+bool BCM_Running(void) {
+	return BCM_running;
+}
+
+/** ***************************************************************************
+ * @brief Get the measured interrupt load
+ * @return CPU time used by SysTick_Handler() in the last period in 1/1000,
+ * entry included, exit not included
+ *****************************************************************************/
+uint32_t BCM_GetLoad(void) {
+	return BCM_load;
+}
+
+/** ***************************************************************************
+ * @brief SysTick interrupt handler: start of the next slice
+ *
+ * The SysTick has just been reloaded with the length of this slice,
+ * so the length of the following slice is written to LOAD now.
+ * @note This interrupt handler is time critical,
+ * it must be shorter than the LSB slice.
+ *****************************************************************************/
+void SysTick_Handler(void) {
+	uint32_t entry = SysTick->LOAD - SysTick->VAL;	// cycles since the reload
+	uint32_t start = G_Cycles();
+	uint32_t slice = BCM_slice;
+	if (0 == slice) {						// start of a period
+		if (BCM_pending) {
+			BCM_active ^= 1;
+			BCM_pending = false;
+		}
+		BCM_load = BCM_isr_cycles * 1000 / (BCM_lsb * BCM_PERIOD_LSB);
+		BCM_isr_cycles = 0;
+	}
+	const BCM_masks_t *masks = &BCM_masks[BCM_active];
+	GPIO->P[BCM_PORT].DOUTSET = masks->set[slice];
+	GPIO->P[BCM_PORT].DOUTCLR = masks->clr[slice];
+	slice++;
+	if (slice >= BCM_BITS) {
+		slice = 0;
+	}
+	SysTick->LOAD = BCM_slice_length(slice) - 1;
+	BCM_slice = slice;
+	BCM_isr_cycles += entry + G_Cycles() - start;
+}
@@ -0,0 +1,125 @@
+/** ***************************************************************************
+ * @file
+ * @brief Correlated colour temperature (CCT) mode
+ *
+ * White, amber and red are blended to follow the Planckian locus,
+ * e.g. "2700 K at 40 %".
+ *
+ * The mixing ratios are a table in flash (COL_CCT_TABLE),
+ * generated together with the colour calibration by tools/colgen.c.
+ * All its points have the same luminance, so a brightness in % is
+ * the same luminance at every colour temperature. 100 % is the luminance
+ * the weakest point reaches at full drive of its strongest LED.
+ * @n A new colour temperature costs a table lookup plus a linear interpolation,
+ * so it can follow the touchslider without any delay.
+ *
+ * Prefix: CCT
+ *
+ * Board:  Starter Kit EFM32-G8XX-STK
+ * Device: EFM32G890F128 (Gecko)
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#include "cct.h"
+#include "colour_calibration.h"
+#include "nvstore.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define CCT_COLUMN_COUNT		3			///< white, amber, red = set points 0 ... 2
+
+/** White, amber and red at full brightness, equally spaced in K */
+static const uint8_t CCT_table[COL_CCT_COUNT][CCT_COLUMN_COUNT] = COL_CCT_TABLE;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+static int32_t CCT_kelvin = CCT_KELVIN_START;	///< colour temperature in K
+static int32_t CCT_brightness = CCT_BRIGHTNESS_MAX;	///< brightness in %
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Restore colour temperature and brightness of the CCT mode
+ *
+ * They are stored apart from the set points of the LEDs (see UI_apply_cct),
+ * so the CCT mode does not overwrite the last colour of the lamp.
+ *****************************************************************************/
+void CCT_Init(void) {
+	uint32_t value;
+	if (NV_Read(NV_KEY_CCT_KELVIN, &value)) {
+		CCT_SetKelvin(value);
+	}
+	if (NV_Read(NV_KEY_CCT_BRIGHTNESS, &value)) {
+		CCT_SetBrightness(value);
+	}
+}
+
+/** ***************************************************************************
+ * @brief Set the colour temperature
+ * @param [in] kelvin limited to CCT_KELVIN_MIN ... CCT_KELVIN_MAX
+ *****************************************************************************/
+void CCT_SetKelvin(int32_t kelvin) {
+	if (kelvin < CCT_KELVIN_MIN) { kelvin = CCT_KELVIN_MIN; }
+	if (kelvin > CCT_KELVIN_MAX) { kelvin = CCT_KELVIN_MAX; }
+	CCT_kelvin = kelvin;
+}
+
+/** ***************************************************************************
+ * @brief Get the colour temperature
+ * @return colour temperature in K
+ *****************************************************************************/
+int32_t CCT_GetKelvin(void) {
+	return CCT_kelvin;
+}
+
+/** ***************************************************************************
+ * @brief Set the brightness
+ * @param [in] percent limited to 0 ... CCT_BRIGHTNESS_MAX
+ *****************************************************************************/
+void CCT_SetBrightness(int32_t percent) {
+	if (percent < 0) { percent = 0; }
+	if (percent > CCT_BRIGHTNESS_MAX) { percent = CCT_BRIGHTNESS_MAX; }
+	CCT_brightness = percent;
+}
+
+/** ***************************************************************************
+ * @brief Get the brightness
+ * @return brightness in %
+ *****************************************************************************/
+int32_t CCT_GetBrightness(void) {
+	return CCT_brightness;
+}
+
+/** ***************************************************************************
+ * @brief Get the set points for the current colour temperature and brightness
+ * @param [out] value set points 0 ... PWR_VALUE_MAX of white, amber, red, green, blue
+ *
+ * Green and blue are not used and set to 0.
+ *****************************************************************************/
+void CCT_Mix(int32_t value[PWR_SOLUTION_COUNT]) {
+	int32_t offset = CCT_kelvin - COL_CCT_MIN;
+	uint32_t i = offset / COL_CCT_STEP;		// segment of the table
+	int32_t x = offset % COL_CCT_STEP;		// position within segment
+	if (i >= COL_CCT_COUNT - 1) {			// last point, nothing to interpolate
+		i = COL_CCT_COUNT - 2;
+		x = COL_CCT_STEP;
+	}
+	for (uint32_t c = 0; c < CCT_COLUMN_COUNT; c++) {
+		int32_t v0 = CCT_table[i][c];
+		int32_t v1 = CCT_table[i+1][c];
+		int32_t v = v0 + ((v1 - v0) * x) / COL_CCT_STEP;	// linear interpolation
+		value[c] = v * CCT_brightness / CCT_BRIGHTNESS_MAX;	// equal luminance
+	}
+	for (uint32_t c = CCT_COLUMN_COUNT; c < PWR_SOLUTION_COUNT; c++) {
+		value[c] = 0;
+	}
+}
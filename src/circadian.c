@@ -0,0 +1,199 @@
+/** ***************************************************************************
+ * @file
+ * @brief Circadian auto-white mode
+ *
+ * White and amber follow a daily curve driven by the sleeptimer wallclock.
+ * @n While the lamp follows the scene time of a master (see timesync.c),
+ * the curve is driven by it instead, so several lamps are in phase.
+ * Setting the clock by hand leaves the master.
+ *
+ * The curve is a compact table in flash with a few points per day.
+ * Between two points the set points are interpolated linearly.
+ * @n Instead of recalculating in a fast loop, the next update is scheduled
+ * with a sleeptimer timer: as soon as one of the set points changes by one LSB,
+ * but at least once per minute (CIRC_UPDATE_MAX_MS)
+ * and at most once per second (CIRC_UPDATE_MIN_MS).
+ *
+ * The clock is given as hhmm (e.g. 730 = 07:30) on the display
+ * and for the remote control.
+ *
+ * Prefix: CIRC
+ *
+ * Board:  Starter Kit EFM32-G8XX-STK
+ * Device: EFM32G890F128 (Gecko)
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#include "em_device.h"
+
+#include "sl_sleeptimer.h"
+
+#include "circadian.h"
+#include "timesync.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define CIRC_SECONDS_PER_DAY	86400		///< wallclock wraps around daily
+
+/** One point of the daily curve */
+typedef struct {
+	uint16_t minute;						///< minute of the day 0 ... 1440
+	uint8_t white;							///< set point white 0 ... 255
+	uint8_t amber;							///< set point amber 0 ... 255
+} CIRC_point_t;
+
+/** Daily curve, must start at minute 0 and end at minute 1440 */
+static const CIRC_point_t CIRC_curve[] = {
+	{    0,   0,  10 },						// night light
+	{  360,   0,  10 },						// 06:00
+	{  420,  40, 120 },						// 07:00 sunrise, warm
+	{  540, 160, 120 },						// 09:00
+	{  720, 255,  60 },						// 12:00 midday, cool and bright
+	{  960, 220,  80 },						// 16:00
+	{ 1140, 100, 180 },						// 19:00 sunset, warm
+	{ 1320,  20,  80 },						// 22:00
+	{ 1440,   0,  10 },						// midnight, same as first point
+};
+
+#define CIRC_POINT_COUNT	(sizeof(CIRC_curve) / sizeof(CIRC_curve[0]))
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+static sl_sleeptimer_timer_handle_t CIRC_timer;	///< schedules the next update
+static volatile bool CIRC_update_due = false;	///< set by the timer callback
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Sleeptimer callback: an update of the set points is due
+ * @param [in] handle of the timer (not used)
+ * @param [in] data of the timer (not used)
+ *****************************************************************************/
+static void CIRC_TimerCallback(sl_sleeptimer_timer_handle_t *handle, void *data) {
+	(void)handle;
+	(void)data;
+	CIRC_update_due = true;
+}
+
+/** ***************************************************************************
+ * @brief Get the time of day
+ * @return second of the day 0 ... CIRC_SECONDS_PER_DAY-1,
+ * of the scene time if synchronised, else of the wallclock
+ *****************************************************************************/
+static uint32_t CIRC_Second(void) {
+	if (TS_Synced()) {
+		uint32_t ms = TS_SceneTime(sl_sleeptimer_get_tick_count()) / TS_UNITS_PER_MS;
+		return (ms / 1000) % CIRC_SECONDS_PER_DAY;
+	}
+	return sl_sleeptimer_get_time() % CIRC_SECONDS_PER_DAY;
+}
+
+/** ***************************************************************************
+ * @brief Evaluate the daily curve
+ * @param [in] second of the day 0 ... CIRC_SECONDS_PER_DAY-1
+ * @param [out] white set point
+ * @param [out] amber set point
+ * @return time in ms until one of the set points changes by one LSB
+ *****************************************************************************/
+static uint32_t CIRC_Evaluate(uint32_t second, int32_t *white, int32_t *amber) {
+	uint32_t i = 0;
+	while ((i < CIRC_POINT_COUNT - 2) && (second >= CIRC_curve[i+1].minute * 60u)) {
+		i++;								// find the segment of the curve
+	}
+	const CIRC_point_t *p0 = &CIRC_curve[i];
+	const CIRC_point_t *p1 = &CIRC_curve[i+1];
+	int32_t t0 = p0->minute * 60;
+	int32_t dt = (p1->minute - p0->minute) * 60;	// length of segment in s
+	int32_t x = second - t0;				// position within segment in s
+	int32_t dw = p1->white - p0->white;
+	int32_t da = p1->amber - p0->amber;
+	*white = p0->white + (dw * x) / dt;		// linear interpolation
+	*amber = p0->amber + (da * x) / dt;
+
+	/* time until the larger of both slopes has moved by one LSB */
+	uint32_t delay = (uint32_t)(dt - x) * 1000u;	// but not beyond the segment
+	if (dw < 0) { dw = -dw; }
+	if (da < 0) { da = -da; }
+	int32_t d = (dw > da) ? dw : da;
+	if ((d > 0) && ((uint32_t)dt * 1000u / d < delay)) {
+		delay = (uint32_t)dt * 1000u / d;
+	}
+	if (delay > CIRC_UPDATE_MAX_MS) { delay = CIRC_UPDATE_MAX_MS; }
+	if (delay < CIRC_UPDATE_MIN_MS) { delay = CIRC_UPDATE_MIN_MS; }
+	return delay;
+}
+
+/** ***************************************************************************
+ * @brief Start the circadian mode
+ *
+ * The first update is due immediately.
+ *****************************************************************************/
+void CIRC_Start(void) {
+	sl_sleeptimer_stop_timer(&CIRC_timer);
+	CIRC_update_due = true;
+}
+
+/** ***************************************************************************
+ * @brief Stop the circadian mode
+ *****************************************************************************/
+void CIRC_Stop(void) {
+	sl_sleeptimer_stop_timer(&CIRC_timer);
+	CIRC_update_due = false;
+}
+
+/** ***************************************************************************
+ * @brief Get new set points if an update is due
+ * @param [out] white set point (only written if an update is due)
+ * @param [out] amber set point (only written if an update is due)
+ * @return true = new set points have been calculated
+ *
+ * The next update is scheduled as late as possible.
+ *****************************************************************************/
+bool CIRC_Update(int32_t *white, int32_t *amber) {
+	if (!CIRC_update_due) {
+		return false;
+	}
+	CIRC_update_due = false;
+	uint32_t second = CIRC_Second();
+	uint32_t delay = CIRC_Evaluate(second, white, amber);
+	sl_sleeptimer_restart_timer_ms(&CIRC_timer, delay, CIRC_TimerCallback,
+			NULL, 0, 0);
+	return true;
+}
+
+/** ***************************************************************************
+ * @brief Set the wallclock
+ * @param [in] hhmm time of day, e.g. 730 = 07:30
+ * @return true = valid time, the clock has been set
+ *
+ * An update of the set points is due immediately.
+ *****************************************************************************/
+bool CIRC_SetClock(int32_t hhmm) {
+	int32_t hour = hhmm / 100;
+	int32_t minute = hhmm % 100;
+	if ((hhmm < 0) || (hour > 23) || (minute > 59)) {
+		return false;
+	}
+	sl_sleeptimer_set_time((hour * 60 + minute) * 60);
+	TS_Reset();								// no longer the time of the master
+	CIRC_update_due = true;
+	return true;
+}
+
+/** ***************************************************************************
+ * @brief Get the wallclock
+ * @return time of day as hhmm, e.g. 730 = 07:30
+ *****************************************************************************/
+int32_t CIRC_GetClock(void) {
+	uint32_t minute = CIRC_Second() / 60;
+	return (minute / 60) * 100 + minute % 60;
+}
@@ -0,0 +1,122 @@
+/** ***************************************************************************
+ * @file
+ * @brief Calibrated colour mixing of the 5 power LEDs
+ *
+ * A target colour in linear sRGB plus a brightness is converted
+ * into set points for white, amber, red, green and blue.
+ *
+ * The calibration of the unit is a set of precomputed fixed point matrices
+ * in flash (colour_calibration.h).
+ * It is generated from the primaries in tools/primaries.txt by the host tool
+ * tools/colgen.c.
+ * @n Calculation is done in Q12 (COL_ONE = 1.0) with integers only,
+ * a conversion takes a few hundred core cycles.
+ *
+ * To get the best luminous efficacy, the colour is first taken
+ * from the white LED as far as possible, then from the amber LED.
+ * Only the remainder is produced by red, green and blue.
+ * @n If a colour is outside of what the LEDs can produce at this brightness,
+ * all set points are scaled down together, keeping the hue.
+ *
+ * Prefix: COL
+ *
+ * Board:  Starter Kit EFM32-G8XX-STK
+ * Device: EFM32G890F128 (Gecko)
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#include "colour.h"
+#include "colour_calibration.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define COL_BRIGHTNESS_MAX		255			///< full brightness
+#define COL_CHANNEL_COUNT		3			///< red, green and blue components
+#define COL_SET_WHITE			0			///< index of the set points
+#define COL_SET_AMBER			1
+#define COL_SET_RED				2
+
+static const int32_t COL_matrix[COL_CHANNEL_COUNT][COL_CHANNEL_COUNT] = COL_MATRIX;
+static const int32_t COL_white[COL_CHANNEL_COUNT] = COL_WHITE;
+static const int32_t COL_white_inv[COL_CHANNEL_COUNT] = COL_WHITE_INV;
+static const int32_t COL_amber[COL_CHANNEL_COUNT] = COL_AMBER;
+static const int32_t COL_amber_inv[COL_CHANNEL_COUNT] = COL_AMBER_INV;
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Take as much as possible of a colour from one LED
+ * @param [in,out] lamp colour in lamp RGB, the part produced by the LED is removed
+ * @param [in] led colour of the LED at full drive in lamp RGB
+ * @param [in] inv reciprocals of led in Q24, 0 = component not used
+ * @return drive of the LED in Q12
+ *
+ * The LED can only add light, so its drive is limited by the component
+ * which runs out first.
+ *****************************************************************************/
+static int32_t COL_Extract(int32_t lamp[COL_CHANNEL_COUNT],
+		const int32_t led[COL_CHANNEL_COUNT], const int32_t inv[COL_CHANNEL_COUNT]) {
+	int32_t drive = COL_ONE;
+	for (uint32_t c = 0; c < COL_CHANNEL_COUNT; c++) {
+		if (inv[c] > 0) {
+			int32_t limit = (lamp[c] > 0) ? (int32_t)(((int64_t)lamp[c] * inv[c]) >> 24) : 0;
+			if (limit < drive) {
+				drive = limit;
+			}
+		}
+	}
+	for (uint32_t c = 0; c < COL_CHANNEL_COUNT; c++) {
+		lamp[c] -= (led[c] * drive) >> 12;
+	}
+	return drive;
+}
+
+/** ***************************************************************************
+ * @brief Convert a colour into set points of the power LEDs
+ * @param [in] rgb linear sRGB colour as 0xRRGGBB
+ * @param [in] brightness 0 ... 255
+ * @param [out] value set points 0 ... PWR_VALUE_MAX of white, amber, red, green, blue
+ *****************************************************************************/
+void COL_Mix(uint32_t rgb, uint32_t brightness, int32_t value[PWR_SOLUTION_COUNT]) {
+	if (brightness > COL_BRIGHTNESS_MAX) {
+		brightness = COL_BRIGHTNESS_MAX;
+	}
+	/* target in Q12, 255 * 4112 / 256 = 4096 */
+	int32_t target[COL_CHANNEL_COUNT];
+	for (uint32_t c = 0; c < COL_CHANNEL_COUNT; c++) {
+		uint32_t component = (rgb >> (8 * (COL_CHANNEL_COUNT - 1 - c))) & 0xFF;
+		target[c] = (((component * 4112) >> 8) * brightness) / COL_BRIGHTNESS_MAX;
+	}
+
+	/* linear sRGB -> lamp RGB */
+	int32_t lamp[COL_CHANNEL_COUNT];
+	for (uint32_t i = 0; i < COL_CHANNEL_COUNT; i++) {
+		lamp[i] = (COL_matrix[i][0] * target[0] + COL_matrix[i][1] * target[1]
+				+ COL_matrix[i][2] * target[2]) >> 12;
+	}
+
+	/* most efficient LEDs first */
+	int32_t drive[PWR_SOLUTION_COUNT];
+	drive[COL_SET_WHITE] = COL_Extract(lamp, COL_white, COL_white_inv);
+	drive[COL_SET_AMBER] = COL_Extract(lamp, COL_amber, COL_amber_inv);
+	int32_t max = COL_ONE;
+	for (uint32_t c = 0; c < COL_CHANNEL_COUNT; c++) {
+		drive[COL_SET_RED + c] = (lamp[c] > 0) ? lamp[c] : 0;
+		if (drive[COL_SET_RED + c] > max) {
+			max = drive[COL_SET_RED + c];
+		}
+	}
+
+	/* out of gamut: scale down all LEDs together, a single division */
+	int32_t scale = (PWR_VALUE_MAX << 20) / max;	// drive * scale fits in 32 bit
+	for (uint32_t i = 0; i < PWR_SOLUTION_COUNT; i++) {
+		value[i] = (drive[i] * scale) >> 20;
+	}
+}
@@ -0,0 +1,431 @@
+/** ***************************************************************************
+ * @file
+ * @brief Parser and dispatcher of the remote control commands
+ *
+ * A command line is a name, optionally followed by integer arguments
+ * separated by ' ', e.g. "cct 2700 40".
+ *
+ * The parser is a state machine fed with one received char at a time
+ * by the RX interrupt of the serial interface (CMD_Parse()).
+ * The work is spread over the chars:
+ * the name is hashed and the numbers are accumulated as they arrive.
+ * Lines are not stored or copied, so there is no limit of the line length
+ * except the longest name and the max number of arguments.
+ * @n At the end of the line the command is validated
+ * and put into a small queue together with its arguments or an error.
+ *
+ * The names are looked up by a perfect hash generated at build time
+ * by tools/cmdgen.c from tools/commands.txt (commands_table.h).
+ * The lookup costs one compare, independent of the number of commands.
+ * @n Names have to match completely, abbreviations are not accepted.
+ * The number and base of the arguments are also given in commands.txt.
+ *
+ * The handlers are given by the caller in a const table indexed by the id.
+ *
+ * A line may start with a request id, e.g. "@17 red 80".
+ * The id is kept with the command, so the reply can echo it.
+ * The commands are queued and executed strictly in order,
+ * so a client may send up to CMD_WINDOW requests without waiting
+ * and match the replies by their id.
+ * @n If more are in flight the queue may overflow and a command is dropped.
+ * As the replies come in order, the client sees the gap in the ids.
+ *
+ * On a bus with several lamps (see CMD_SetAddress()) a line starts
+ * with the address: ">3 red 80" for lamp 3, ">g2 red 80" for group 2
+ * and ">* red 80" for all the lamps. The request id follows the address.
+ * @n Lines for other lamps, without or with an invalid address
+ * are skipped as they arrive, they never reach the queue.
+ * Lines to a group or to all the lamps are marked silent:
+ * they must not be answered, otherwise the lamps would talk at once.
+ * @n A lamp with address 0 (no bus) takes all the lines without address
+ * and the ones to all the lamps or to its group.
+ *
+ * Prefix: CMD
+ *
+ * Board:  Starter Kit EFM32-G8XX-STK
+ * Device: EFM32G890F128 (Gecko)
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#include "commands.h"
+#include "commands_hash.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define CMD_SLOT_COUNT		(1u << CMD_HASH_BITS)	///< size of the hash table
+
+/** Number and base of the arguments */
+typedef struct {
+	uint8_t min;							///< min number of arguments
+	uint8_t max;							///< max number of arguments
+	uint8_t base;							///< 10 or 16
+} CMD_args_t;
+
+static const char * const CMD_name[CMD_COUNT] = CMD_NAMES;	///< names by id
+static const CMD_args_t CMD_args[CMD_COUNT] = CMD_ARGS;		///< arguments by id
+static const uint8_t CMD_slot[CMD_SLOT_COUNT] = CMD_SLOTS;	///< ids by hash
+
+/** States of the parser */
+typedef enum {
+	CMD_STATE_NAME,							///< reading the name
+	CMD_STATE_TAG,							///< reading the request id
+	CMD_STATE_ADDRESS,						///< reading the address
+	CMD_STATE_IGNORE,						///< line for another lamp, skip it
+	CMD_STATE_SPACE,						///< waiting for the next argument
+	CMD_STATE_NUMBER,						///< reading an argument
+	CMD_STATE_SKIP,							///< error found, skip to end of line
+} CMD_state_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+
+/** State of the parser, only used in the RX interrupt */
+static CMD_state_t CMD_state = CMD_STATE_NAME;
+static CMD_command_t CMD_current;			///< command being parsed
+static uint32_t CMD_hash = CMD_HASH_SEED;	///< hash of the name so far
+static char CMD_name_read[CMD_NAME_MAX];	///< name so far, for the compare
+static uint32_t CMD_name_length = 0;		///< chars of the name so far
+static uint32_t CMD_number;					///< argument so far
+static bool CMD_negative;					///< argument has a '-'
+static bool CMD_digits;						///< argument has digits
+static uint32_t CMD_dropped = 0;			///< commands lost as the queue was full
+static bool CMD_addressed;					///< line has an address
+static bool CMD_to_all;						///< address is CMD_ADDRESS_ALL
+static bool CMD_to_group;					///< address is a group
+
+/** Address and group of this lamp, written by CMD_SetAddress() only */
+static volatile uint32_t CMD_address = 0;
+static volatile uint32_t CMD_group = 0;
+
+/** Queue of the parsed commands, written in the RX interrupt */
+static CMD_command_t CMD_queue[CMD_QUEUE_SIZE];
+static volatile uint32_t CMD_queue_in = 0;	///< written by the parser only
+static volatile uint32_t CMD_queue_out = 0;	///< written by CMD_Get() only
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Start a new line
+ *****************************************************************************/
+static void CMD_Start(void) {
+	CMD_state = CMD_STATE_NAME;
+	CMD_hash = CMD_HASH_SEED;
+	CMD_name_length = 0;
+	CMD_current.error = CMD_OK;
+	CMD_current.argc = 0;
+	CMD_current.tagged = false;
+	CMD_current.tag = 0;
+	CMD_current.silent = false;
+	CMD_addressed = false;
+	CMD_to_all = false;
+	CMD_to_group = false;
+}
+
+/** ***************************************************************************
+ * @brief Skip the rest of the line and report an error at its end
+ * @param [in] error CMD_ERR_UNKNOWN or CMD_ERR_ARGUMENT
+ *****************************************************************************/
+static void CMD_Fail(uint32_t error) {
+	CMD_current.error = error;
+	CMD_state = CMD_STATE_SKIP;
+}
+
+/** ***************************************************************************
+ * @brief The name is complete: look it up
+ * @return true = valid name
+ *
+ * The hash is the one of tools/cmdgen.c (commands_hash.h).
+ * The slot may belong to another name, so the name is compared once.
+ *****************************************************************************/
+static bool CMD_Lookup(void) {
+	uint32_t id = CMD_slot[CMD_HashSlot(CMD_hash, CMD_HASH_BITS)];
+	if (id >= CMD_COUNT) {
+		return false;						// empty slot
+	}
+	const char *name = CMD_name[id];
+	for (uint32_t i = 0; i < CMD_name_length; i++) {
+		if (name[i] != CMD_name_read[i]) {
+			return false;
+		}
+	}
+	if ('\0' != name[CMD_name_length]) {
+		return false;
+	}
+	CMD_current.id = id;
+	return true;
+}
+
+/** ***************************************************************************
+ * @brief The address is complete: check if the line is for this lamp
+ * @return true = for this lamp
+ *****************************************************************************/
+static bool CMD_ForThisLamp(void) {
+	if (CMD_to_all) {
+		return true;
+	}
+	if (CMD_to_group) {
+		return (0 != CMD_group) && (CMD_number == CMD_group);
+	}
+	return (0 != CMD_address) && (CMD_number == CMD_address);
+}
+
+/** ***************************************************************************
+ * @brief An argument is complete: store it
+ *****************************************************************************/
+static void CMD_Argument(void) {
+	if (CMD_current.argc >= CMD_args[CMD_current.id].max) {
+		CMD_Fail(CMD_ERR_ARGUMENT);			// too many arguments
+		return;
+	}
+	CMD_current.arg[CMD_current.argc++] =
+			CMD_negative ? -(int32_t)CMD_number : (int32_t)CMD_number;
+	CMD_state = CMD_STATE_SPACE;
+}
+
+/** ***************************************************************************
+ * @brief The line is complete: validate and queue the command
+ *
+ * If the queue is full, the command is dropped and counted.
+ * This doesn't happen as long as a client keeps at most CMD_WINDOW
+ * requests in flight.
+ *****************************************************************************/
+static void CMD_Emit(void) {
+	if ((CMD_OK == CMD_current.error)
+			&& (CMD_current.argc < CMD_args[CMD_current.id].min)) {
+		CMD_current.error = CMD_ERR_ARGUMENT;	// too few arguments
+	}
+	uint32_t in = CMD_queue_in;
+	if (in - CMD_queue_out < CMD_QUEUE_SIZE) {
+		CMD_queue[in % CMD_QUEUE_SIZE] = CMD_current;
+		CMD_queue_in = in + 1;				// publish after the copy
+	} else {
+		CMD_dropped++;
+	}
+	CMD_Start();
+}
+
+/** ***************************************************************************
+ * @brief Feed one received char to the parser
+ * @param [in] c received char, CMD_END_OF_LINE at the end of a line
+ *
+ * Leading spaces and empty lines are ignored.
+ * An argument beyond INT32_MAX is an invalid argument.
+ * @note Called from the RX interrupt of the serial interface.
+ *****************************************************************************/
+void CMD_Parse(char c) {
+	switch (CMD_state) {
+	case CMD_STATE_NAME:
+		if ((' ' == c) || (CMD_END_OF_LINE == c)) {
+			if (0 == CMD_name_length) {
+				if (CMD_current.tagged && (CMD_END_OF_LINE == c)) {
+					CMD_Fail(CMD_ERR_UNKNOWN);	// just a request id
+					CMD_Emit();
+				}
+				break;						// leading space or empty line
+			}
+			if (!CMD_Lookup()) {
+				CMD_Fail(CMD_ERR_UNKNOWN);
+			} else {
+				CMD_state = CMD_STATE_SPACE;
+			}
+			if (CMD_END_OF_LINE == c) {
+				CMD_Emit();
+			}
+		} else if ((0 == CMD_name_length) && !CMD_current.tagged && !CMD_addressed
+				&& ((CMD_ADDRESS_MARK == c) || CMD_address)) {
+			if (CMD_ADDRESS_MARK == c) {	// address at the start of the line
+				CMD_number = 0;
+				CMD_digits = false;
+				CMD_state = CMD_STATE_ADDRESS;
+			} else {
+				CMD_state = CMD_STATE_IGNORE;	// no address on a bus
+			}
+		} else if ((CMD_TAG_MARK == c) && (0 == CMD_name_length)
+				&& !CMD_current.tagged) {
+			CMD_current.tagged = true;		// request id before the name
+			CMD_digits = false;
+			CMD_state = CMD_STATE_TAG;
+		} else if (CMD_name_length < CMD_NAME_MAX) {
+			CMD_hash = CMD_HashStep(CMD_hash, c);
+			CMD_name_read[CMD_name_length++] = c;
+		} else {
+			CMD_Fail(CMD_ERR_UNKNOWN);		// longer than any name
+		}
+		break;
+	case CMD_STATE_TAG:
+		if ((c >= '0') && (c <= '9')) {
+			uint32_t tag = CMD_current.tag * 10u + (c - '0');
+			if (tag > CMD_TAG_MAX) {
+				CMD_current.tagged = false;	// the reply can't echo it
+				CMD_Fail(CMD_ERR_ARGUMENT);
+				break;
+			}
+			CMD_current.tag = tag;
+			CMD_digits = true;
+		} else if (CMD_digits && ((' ' == c) || (CMD_END_OF_LINE == c))) {
+			CMD_state = CMD_STATE_NAME;		// the name follows
+			if (CMD_END_OF_LINE == c) {
+				CMD_Parse(c);
+			}
+		} else {
+			CMD_current.tagged = false;
+			CMD_Fail(CMD_ERR_ARGUMENT);		// not a number
+			if (CMD_END_OF_LINE == c) {
+				CMD_Emit();
+			}
+		}
+		break;
+	case CMD_STATE_ADDRESS:
+		if ((CMD_ADDRESS_ALL == c) && !CMD_digits && !CMD_to_group && !CMD_to_all) {
+			CMD_to_all = true;
+		} else if ((CMD_ADDRESS_GROUP == c) && !CMD_digits && !CMD_to_group && !CMD_to_all) {
+			CMD_to_group = true;
+		} else if ((c >= '0') && (c <= '9') && !CMD_to_all
+				&& (CMD_number * 10u + (c - '0') <= CMD_ADDRESS_MAX)) {
+			CMD_number = CMD_number * 10u + (c - '0');
+			CMD_digits = true;
+		} else if ((' ' == c) && (CMD_digits || CMD_to_all) && CMD_ForThisLamp()) {
+			CMD_addressed = true;
+			CMD_current.silent = CMD_to_all || CMD_to_group;
+			CMD_state = CMD_STATE_NAME;		// request id or name follows
+		} else if (CMD_END_OF_LINE == c) {
+			CMD_Start();					// just an address
+		} else {
+			CMD_state = CMD_STATE_IGNORE;	// another lamp or invalid
+		}
+		break;
+	case CMD_STATE_IGNORE:
+		if (CMD_END_OF_LINE == c) {
+			CMD_Start();					// nothing to queue
+		}
+		break;
+	case CMD_STATE_SPACE:
+		if (CMD_END_OF_LINE == c) {
+			CMD_Emit();
+		} else if (' ' != c) {				// start of an argument
+			CMD_number = 0;
+			CMD_negative = false;
+			CMD_digits = false;
+			CMD_state = CMD_STATE_NUMBER;
+			if ('-' == c) {
+				CMD_negative = (10 == CMD_args[CMD_current.id].base);
+				if (!CMD_negative) {
+					CMD_Fail(CMD_ERR_ARGUMENT);
+				}
+				break;
+			}
+			CMD_Parse(c);					// first digit
+		}
+		break;
+	case CMD_STATE_NUMBER:
+		if ((' ' == c) || (CMD_END_OF_LINE == c)) {
+			if (!CMD_digits) {
+				CMD_Fail(CMD_ERR_ARGUMENT);	// just a '-'
+			} else {
+				CMD_Argument();
+			}
+			if (CMD_END_OF_LINE == c) {
+				CMD_Emit();
+			}
+		} else {
+			uint32_t digit;
+			uint32_t base = CMD_args[CMD_current.id].base;
+			if ((c >= '0') && (c <= '9')) {
+				digit = c - '0';
+			} else if ((16 == base) && ((c | 0x20) >= 'a') && ((c | 0x20) <= 'f')) {
+				digit = (c | 0x20) - 'a' + 10;	// upper or lower case
+			} else {
+				CMD_Fail(CMD_ERR_ARGUMENT);
+				break;
+			}
+			if (CMD_number > (INT32_MAX - digit) / base) {
+				CMD_Fail(CMD_ERR_ARGUMENT);	// too large for an argument
+				break;
+			}
+			CMD_number = CMD_number * base + digit;
+			CMD_digits = true;
+		}
+		break;
+	case CMD_STATE_SKIP:
+		if (CMD_END_OF_LINE == c) {
+			CMD_Emit();
+		}
+		break;
+	}
+}
+
+/** ***************************************************************************
+ * @brief Stamp the line being received with a time
+ * @param [in] time e.g. sleeptimer tick
+ *
+ * Given before CMD_END_OF_LINE, the command carries it in its field received.
+ * @note Called from the RX interrupt of the serial interface.
+ *****************************************************************************/
+void CMD_Stamp(uint32_t time) {
+	CMD_current.received = time;
+}
+
+/** ***************************************************************************
+ * @brief Discard the line being parsed and all queued commands
+ *****************************************************************************/
+void CMD_Reset(void) {
+	CMD_Start();
+	CMD_queue_out = CMD_queue_in;
+}
+
+/** ***************************************************************************
+ * @brief Get the oldest parsed command
+ * @param [out] command with arguments or error (only written if available)
+ * @return true = a command was available
+ *****************************************************************************/
+bool CMD_Get(CMD_command_t *command) {
+	uint32_t out = CMD_queue_out;
+	if (out == CMD_queue_in) {
+		return false;
+	}
+	*command = CMD_queue[out % CMD_QUEUE_SIZE];
+	CMD_queue_out = out + 1;				// release after the copy
+	return true;
+}
+
+/** ***************************************************************************
+ * @brief Set the address of this lamp on a bus
+ * @param [in] address 1 ... CMD_ADDRESS_MAX, 0 = no bus
+ * @param [in] group 1 ... CMD_ADDRESS_MAX, 0 = no group
+ *
+ * Takes effect with the next line.
+ *****************************************************************************/
+void CMD_SetAddress(uint32_t address, uint32_t group) {
+	CMD_address = (address <= CMD_ADDRESS_MAX) ? address : 0;
+	CMD_group = (group <= CMD_ADDRESS_MAX) ? group : 0;
+}
+
+/** ***************************************************************************
+ * @brief Get the number of commands dropped as the queue was full
+ * @return count since reset
+ *****************************************************************************/
+uint32_t CMD_GetDropped(void) {
+	return CMD_dropped;
+}
+
+/** ***************************************************************************
+ * @brief Execute a parsed command
+ * @param [in] command from CMD_Get()
+ * @param [in] handler of each command, indexed by the id
+ * @return CMD_OK, the error found by the parser or the error of the handler
+ *****************************************************************************/
+int32_t CMD_Execute(const CMD_command_t *command, const CMD_handler_t handler[CMD_COUNT]) {
+	if (CMD_OK != command->error) {
+		return command->error;
+	}
+	return handler[command->id](command);
+}
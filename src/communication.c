@@ -2,6 +2,40 @@
  * @file
  * @brief Simple asynchronous communication with just a string as second level buffer
  *
+ * Received chars are not buffered, each one is passed directly
+ * to the command parser (see commands.c) in the RX interrupt.
+ *
+ * Strings to send are queued, a new string never cuts off the one being sent.
+ * @n Replies (COM_TX_PutData()) are sent in order.
+ * @n Notifications (COM_TX_Notify()) keep only the latest string per key,
+ * e.g. per state of the user interface: a newer string replaces a stale one
+ * in place. They are sent after the replies and at most once
+ * per subscription interval, the latest change last.
+ * So the remote always ends up with the latest state
+ * without flooding the link while e.g. the slider moves.
+ * The interval may be changed or the notifications turned off
+ * with COM_Subscribe().
+ *
+ * For a colour stream (see stream.c) the link is switched
+ * to COM_STREAM_BAUDRATE with COM_Stream(): after the pending replies
+ * have been sent, the LEUART is clocked from the HF clock
+ * and the received bytes go to the stream instead of the command parser.
+ * Nothing is sent meanwhile. When the stream has ended,
+ * COM_Process() switches back to COM_BAUDRATE on the LF clock.
+ *
+ * Several lamps may share one serial line as a bus (COM_SetAddress()):
+ * the master addresses a lamp, a group or all of them (see commands.c)
+ * and only the addressed lamp answers, so they never talk at once.
+ * @n The TX outputs are open drain with pull-up (wired-AND), so they
+ * can be connected. Notifications are not sent on a bus,
+ * the master polls the lamps instead. The replies start with "<" and
+ * the address of the lamp, e.g. "<3 white 100".
+ * @n Address and group are stored in the flash (see nvstore.c).
+ *
+ * For the synchronisation of the scene time (see timesync.c)
+ * each received line is stamped with the tick of its end (CMD_Stamp())
+ * and the tick of the end of a reply may be taken (COM_TX_Stamp()).
+ *
  * The code is inspired by AN0045 USART or UART Asynchronous mode
  * and by AN0017 Low Energy UART
  * @n It uses only the HW-buffers in connection with TX- and RX-interrupts.
@@ -26,8 +60,14 @@
 #include "em_cmu.h"
 #include "em_gpio.h"
 #include "em_leuart.h"
+#include "em_core.h"
+
+#include "sl_sleeptimer.h"
 
 #include "communication.h"
+#include "commands.h"
+#include "stream.h"
+#include "nvstore.h"
 
 /******************************************************************************
  * Defines
@@ -40,25 +80,77 @@
 #define COM_RX_PORT		gpioPortD			///< Port for RX
 #define COM_RX_PIN		5					///< Pin for RX
 
+#define COM_TX_REPLY_COUNT	8				///< replies waiting, power of 2, >= CMD_WINDOW
+#define COM_TX_NOTIFY_COUNT	16				///< keys of notifications
+
+/** The end of string is written to the TX buffer while the char before
+ * is being sent, so both chars of 10 bits have left after this time */
+#define COM_END_TICKS	(2 * 10 * 32768 / COM_BAUDRATE)
+
+/** LEUART clock during a stream: HFCORECLK / 2 / prescaler,
+ * the clock divider of the LEUART allows up to 128 * baud rate */
+#define COM_STREAM_PRESCALER	cmuClkDiv_2
+
+/** States of the link */
+typedef enum {
+	COM_TEXT,								///< commands at COM_BAUDRATE
+	COM_STREAM_PENDING,						///< switch after the pending replies
+	COM_STREAM,								///< stream at COM_STREAM_BAUDRATE
+} COM_link_t;
+
 /******************************************************************************
  * Variables
  *****************************************************************************/
 // second level buffers and flags
-bool COM_RX_Available_Flag = false;			///< received data is available
-char COM_RX_Data[COM_BUF_SIZE] = "";		///< buffer for received data
 bool COM_TX_Busy_Flag = false;				///< busy with sending
 char COM_TX_Data[COM_BUF_SIZE] = "";		///< buffer for data to be sent
 
-// string buffers and indices for TX and RX
+// string buffer and index for TX
 char TX_buf[COM_BUF_SIZE] = "";				///< transmit buffer
-char RX_buf[COM_BUF_SIZE] = "";				///< receive buffer
 uint8_t TX_index = 0;						///< transmit buffer index
-uint8_t RX_index = 0;						///< receive buffer index
+
+// queues for TX, only accessed with interrupts masked
+static char COM_reply[COM_TX_REPLY_COUNT][COM_BUF_SIZE];	///< replies in order
+static uint32_t COM_reply_in = 0;			///< next reply to write
+static uint32_t COM_reply_out = 0;			///< next reply to send
+static char COM_notify[COM_TX_NOTIFY_COUNT][COM_BUF_SIZE];	///< latest per key
+static uint32_t COM_notify_seq[COM_TX_NOTIFY_COUNT];	///< order, 0 = not pending
+static uint32_t COM_seq = 0;				///< last sequence number
+static uint32_t COM_notify_interval = COM_NOTIFY_INTERVAL_MS;	///< 0 = off
+static uint32_t COM_notify_ticks = 0;		///< interval in sleeptimer ticks
+static uint32_t COM_notify_last = 0;		///< tick of the last notification
+
+static volatile COM_link_t COM_link = COM_TEXT;	///< text or stream
+static CMU_Select_TypeDef COM_lf_select = cmuSelect_LFRCO;	///< LFB clock for text
+
+static bool COM_stamp_next = false;			///< stamp the next reply queued
+static bool COM_stamp_queued = false;		///< a queued reply is to be stamped
+static uint32_t COM_stamp_reply = 0;		///< index of this reply
+static bool COM_stamp_sending = false;		///< the string being sent is it
+static volatile bool COM_stamp_valid = false;	///< COM_stamp has been taken
+static volatile uint32_t COM_stamp = 0;		///< tick of the end of the reply
+
+static uint32_t COM_address = 0;			///< address on the bus, 0 = no bus
+static uint32_t COM_group = 0;				///< group on the bus, 0 = no group
 
 /******************************************************************************
  * Functions
  *****************************************************************************/
 
+/**************************************************************************//**
+ * @brief  Configure TX and the parser for the address on the bus
+ *
+ * On a bus TX is open drain, so the lamps can share the line,
+ * without a bus push-pull.
+ ******************************************************************************/
+static void COM_ApplyAddress(void) {
+	if (COM_address > CMD_ADDRESS_MAX) { COM_address = 0; }
+	if (COM_group > CMD_ADDRESS_MAX) { COM_group = 0; }
+	CMD_SetAddress(COM_address, COM_group);
+	GPIO_PinModeSet(COM_TX_PORT, COM_TX_PIN,
+			COM_address ? gpioModeWiredAndPullUp : gpioModePushPull, 1);	// idle high
+}
+
 /**************************************************************************//**
  * @brief  Initialize the low energy UART
  *
@@ -70,16 +162,21 @@ void COM_Init(void) {
 	LEUART_Reset(COM_LEUART);
 	/* change fields of leuartInit, if standard values don't fit */
 	LEUART_Init_TypeDef leuartInit = LEUART_INIT_DEFAULT;
+	leuartInit.baudrate = COM_BAUDRATE;
 	LEUART_Init(COM_LEUART, &leuartInit);
 
 	/* Enable TX and RX and route to GPIO pins */
 	COM_LEUART->ROUTE = LEUART_ROUTE_TXPEN | LEUART_ROUTE_RXPEN | COM_LOCATION;
 
-	/* Configure the GPIOs */
+	/* Configure the GPIOs, TX as set by the stored address */
 	CMU_ClockEnable(cmuClock_GPIO, true);	// Enable clock for GPIO module
-	GPIO_PinModeSet(COM_TX_PORT, COM_TX_PIN, gpioModePushPull, 0);
 	GPIO_PinModeSet(COM_RX_PORT, COM_RX_PIN, gpioModeInput, 0);
 	// GPIO_PinModeSet(COM_RX_PORT, COM_RX_PIN, gpioModeInputPull, 1); 	// with pullup
+	NV_Read(NV_KEY_COM_ADDRESS, &COM_address);
+	NV_Read(NV_KEY_COM_GROUP, &COM_group);
+	COM_ApplyAddress();
+
+	COM_Subscribe(COM_NOTIFY_INTERVAL_MS);	// default rate of notifications
 
 	/* Configure interrupts */
 	LEUART_IntEnable(COM_LEUART, LEUART_IEN_RXDATAV);	// enable RX interrupt
@@ -88,46 +185,56 @@ void COM_Init(void) {
 }
 
 /**************************************************************************//**
- * @brief Flush all the buffers
+ * @brief  Switch the clock and the baud rate of the link
  *
- * Could be useful if the parser encounters a syntax error.
+ * @param [in] stream true = COM_STREAM_BAUDRATE on the HF clock,
+ * false = COM_BAUDRATE on the LF clock
  ******************************************************************************/
-void COM_Flush_Buffers(void) {
-	RX_buf[0] = '\0';
-	RX_index = 0;
-	COM_RX_Data[0] = '\0';
-	COM_RX_Available_Flag = false;
-	TX_buf[0] = '\0';
-	TX_index = 0;
-	COM_TX_Data[0] = '\0';
-	COM_TX_Busy_Flag = false;
+static void COM_Baudrate(bool stream) {
+	LEUART_Enable(COM_LEUART, leuartDisable);
+	if (stream) {
+		CMU_ClockSelectSet(cmuClock_LFB, cmuSelect_CORELEDIV2);
+		CMU_ClockDivSet(COM_CLOCK, COM_STREAM_PRESCALER);
+		LEUART_BaudrateSet(COM_LEUART, 0, COM_STREAM_BAUDRATE);	// 0 = current clock
+	} else {
+		CMU_ClockSelectSet(cmuClock_LFB, COM_lf_select);
+		CMU_ClockDivSet(COM_CLOCK, cmuClkDiv_1);
+		LEUART_BaudrateSet(COM_LEUART, 0, COM_BAUDRATE);
+	}
+	LEUART_Enable(COM_LEUART, leuartEnable);
 }
 
 /**************************************************************************//**
- * @brief Check if a new string has been received.
+ * @brief  Recalculate the baud rate after the LF clock source has changed
  *
- * @return true = a string has been received and is ready for processing.
+ * During a stream the new LF clock is used after the stream.
  ******************************************************************************/
-bool COM_RX_Available(void) {
-	return COM_RX_Available_Flag;
+void COM_Retune(void) {
+	COM_lf_select = CMU_ClockSelectGet(cmuClock_LFB);
+	if (COM_STREAM == COM_link) {
+		COM_Baudrate(true);					// keep on the HF clock
+	} else {
+		LEUART_BaudrateSet(COM_LEUART, 0, COM_BAUDRATE);	// 0 = current clock
+	}
 }
 
 /**************************************************************************//**
- * @brief Get the received data from the serial interface
+ * @brief Flush all the buffers
  *
- * @param [out] string which has been received
- * @param [in] n = maximum number of chars
- * @note A (subsequent) call to COM_RX_GetData() returns an empty string
- * if no new data has been received in the meantime.
- * @n This can be avoided by checking COM_RX_Available();
- ******************************************************************************/
-void COM_RX_GetData(char * string, uint32_t n) {
-	if (COM_RX_Available_Flag) {
-		strncpy(string, COM_RX_Data, n);
-		COM_RX_Available_Flag = false;
-	} else {
-		string[0] = '\0';
+ * Could be useful if the parser encounters a syntax error.
+ ******************************************************************************/
+void COM_Flush_Buffers(void) {
+	CMD_Reset();							// partial line and parsed commands
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+	TX_buf[0] = '\0';
+	TX_index = 0;
+	COM_TX_Data[0] = '\0';
+	COM_reply_out = COM_reply_in;
+	for (uint32_t key = 0; key < COM_TX_NOTIFY_COUNT; key++) {
+		COM_notify_seq[key] = 0;
 	}
+	CORE_EXIT_CRITICAL();
 }
 
 /**************************************************************************//**
@@ -140,48 +247,291 @@ bool COM_TX_Busy(void) {
 }
 
 /**************************************************************************//**
- * @brief Start sending data on serial interface
+ * @brief Start sending the next queued string, if any
+ *
+ * Replies first, then the oldest notification if the interval has elapsed.
+ * @note Called with interrupts masked or from the interrupt handler,
+ * only while no string is being sent.
+ ******************************************************************************/
+static void COM_TX_Next(void) {
+	const char *next = NULL;
+	if (COM_STREAM == COM_link) {
+		return;								// the PC doesn't listen meanwhile
+	}
+	COM_stamp_sending = false;
+	if (COM_reply_out != COM_reply_in) {
+		next = COM_reply[COM_reply_out % COM_TX_REPLY_COUNT];
+		if (COM_stamp_queued && (COM_stamp_reply == COM_reply_out)) {
+			COM_stamp_queued = false;
+			COM_stamp_sending = true;
+		}
+		COM_reply_out++;
+	} else if (COM_STREAM_PENDING == COM_link) {
+		LEUART_IntClear(COM_LEUART, LEUART_IFC_TXC);
+		LEUART_IntEnable(COM_LEUART, LEUART_IEN_TXC);	// switch when sent
+		if (COM_LEUART->STATUS & LEUART_STATUS_TXC) {
+			LEUART_IntSet(COM_LEUART, LEUART_IFS_TXC);	// already sent
+		}
+	} else if (COM_notify_interval
+			&& (sl_sleeptimer_get_tick_count() - COM_notify_last >= COM_notify_ticks)) {
+		uint32_t oldest = COM_TX_NOTIFY_COUNT;
+		for (uint32_t key = 0; key < COM_TX_NOTIFY_COUNT; key++) {
+			if (COM_notify_seq[key] && ((COM_TX_NOTIFY_COUNT == oldest)
+					|| ((int32_t)(COM_notify_seq[key] - COM_notify_seq[oldest]) < 0))) {
+				oldest = key;
+			}
+		}
+		if (oldest < COM_TX_NOTIFY_COUNT) {
+			next = COM_notify[oldest];
+			COM_notify_seq[oldest] = 0;
+			COM_notify_last = sl_sleeptimer_get_tick_count();
+		}
+	}
+	if (next) {
+		strncpy(TX_buf, next, COM_BUF_SIZE);	// Copy string to TX buffer
+		TX_index = 0;						// Start to transmit with first char
+		COM_TX_Busy_Flag = true;			// Set the busy flag
+		LEUART_IntEnable(COM_LEUART, LEUART_IEN_TXBL);// Enable TX interrupt to start
+	}
+}
+
+/**************************************************************************//**
+ * @brief Queue a reply to be sent on the serial interface
  *
  * @param [in] string to be sent
  * @param [in] n = maximum number of chars
  *
- * @note A call to COM_TX_PutData() starts sending the new string immediately
- * even if an previous string has not been completely sent.
- * @n This can be avoided by checking COM_TX_Busy();
+ * @note Replies are sent in order after the string being sent.
+ * If COM_TX_REPLY_COUNT replies are already waiting, the new one is dropped.
  ******************************************************************************/
 void COM_TX_PutData(char * string, uint32_t n) {
-	strncpy(TX_buf, string, n);				// Copy string to TX buffer
-	TX_index = 0;							// Start to transmit with first char
-	COM_TX_Busy_Flag = true;				// Set the busy flag
-	LEUART_IntEnable(COM_LEUART, LEUART_IEN_TXBL);// Enable TX interrupt to start
+	if (n > COM_BUF_SIZE) { n = COM_BUF_SIZE; }
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+	if (COM_reply_in - COM_reply_out < COM_TX_REPLY_COUNT) {
+		char *reply = COM_reply[COM_reply_in % COM_TX_REPLY_COUNT];
+		strncpy(reply, string, n);
+		reply[COM_BUF_SIZE - 1] = '\0';
+		if (COM_stamp_next) {
+			COM_stamp_next = false;
+			COM_stamp_queued = true;
+			COM_stamp_reply = COM_reply_in;
+		}
+		COM_reply_in++;
+	}
+	if (!COM_TX_Busy_Flag) {
+		COM_TX_Next();
+	}
+	CORE_EXIT_CRITICAL();
+}
+
+/**************************************************************************//**
+ * @brief Queue a notification, replacing a stale one with the same key
+ *
+ * @param [in] key e.g. the state, 0 ... COM_TX_NOTIFY_COUNT-1
+ * @param [in] string to be sent
+ *
+ * @note Ignored while the notifications are turned off and on a bus.
+ ******************************************************************************/
+void COM_TX_Notify(uint32_t key, const char * string) {
+	if ((key >= COM_TX_NOTIFY_COUNT) || !COM_notify_interval || COM_address) {
+		return;
+	}
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+	strncpy(COM_notify[key], string, COM_BUF_SIZE);
+	COM_notify[key][COM_BUF_SIZE - 1] = '\0';
+	COM_seq++;
+	if (0 == COM_seq) { COM_seq++; }		// 0 means not pending
+	COM_notify_seq[key] = COM_seq;			// latest change goes last
+	if (!COM_TX_Busy_Flag) {
+		COM_TX_Next();
+	}
+	CORE_EXIT_CRITICAL();
+}
+
+/**************************************************************************//**
+ * @brief Take the tick of the end of the next reply
+ *
+ * Called before the reply is queued with COM_TX_PutData(),
+ * the tick is available with COM_TX_GetStamp() after it has been sent.
+ ******************************************************************************/
+void COM_TX_Stamp(void) {
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+	COM_stamp_next = true;
+	COM_stamp_queued = false;
+	COM_stamp_valid = false;
+	CORE_EXIT_CRITICAL();
+}
+
+/**************************************************************************//**
+ * @brief Get the tick of the end of the reply stamped last
+ *
+ * @param [out] tick sleeptimer tick (only written if available)
+ * @return true = the reply has been sent, the tick is taken only once
+ ******************************************************************************/
+bool COM_TX_GetStamp(uint32_t *tick) {
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+	bool valid = COM_stamp_valid;
+	if (valid) {
+		*tick = COM_stamp;
+		COM_stamp_valid = false;
+	}
+	CORE_EXIT_CRITICAL();
+	return valid;
+}
+
+/**************************************************************************//**
+ * @brief Send notifications which had to wait for the interval
+ *
+ * Called in the main loop, which runs at least every EMM_TICK_MS.
+ * @n Switches back to the commands after a stream.
+ ******************************************************************************/
+void COM_Process(void) {
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+	if ((COM_STREAM == COM_link) && !STR_Active()) {
+		COM_Baudrate(false);
+		CMD_Reset();						// start with a new line
+		COM_link = COM_TEXT;
+	}
+	if (!COM_TX_Busy_Flag) {
+		COM_TX_Next();
+	}
+	CORE_EXIT_CRITICAL();
+}
+
+/**************************************************************************//**
+ * @brief Switch the link to the colour stream
+ *
+ * The pending replies are sent first at COM_BAUDRATE,
+ * e.g. the answer to the command which started the stream.
+ * @n The switch back is done by COM_Process() when the stream has ended.
+ ******************************************************************************/
+void COM_Stream(void) {
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+	if (COM_TEXT == COM_link) {
+		COM_link = COM_STREAM_PENDING;
+		if (!COM_TX_Busy_Flag) {
+			COM_TX_Next();
+		}
+	}
+	CORE_EXIT_CRITICAL();
+}
+
+/**************************************************************************//**
+ * @brief Subscribe to or unsubscribe from the notifications
+ *
+ * @param [in] interval_ms min time between two notifications,
+ * limited to COM_NOTIFY_INTERVAL_MAX_MS, 0 = turn off
+ * @note Pending notifications are discarded when turned off.
+ ******************************************************************************/
+void COM_Subscribe(uint32_t interval_ms) {
+	if (interval_ms > COM_NOTIFY_INTERVAL_MAX_MS) {
+		interval_ms = COM_NOTIFY_INTERVAL_MAX_MS;
+	}
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+	COM_notify_interval = interval_ms;
+	COM_notify_ticks = sl_sleeptimer_ms_to_tick(interval_ms);
+	if (!interval_ms) {
+		for (uint32_t key = 0; key < COM_TX_NOTIFY_COUNT; key++) {
+			COM_notify_seq[key] = 0;
+		}
+	}
+	CORE_EXIT_CRITICAL();
+}
+
+/**************************************************************************//**
+ * @brief Get the subscription interval
+ *
+ * @return min time between two notifications in ms, 0 = turned off
+ ******************************************************************************/
+uint32_t COM_GetSubscription(void) {
+	return COM_notify_interval;
+}
+
+/**************************************************************************//**
+ * @brief Set the address of this lamp on a bus and store it
+ *
+ * @param [in] address 1 ... CMD_ADDRESS_MAX, 0 = no bus
+ * @param [in] group 1 ... CMD_ADDRESS_MAX, 0 = no group
+ * @return true = valid, false = nothing changed
+ ******************************************************************************/
+bool COM_SetAddress(int32_t address, int32_t group) {
+	if ((address < 0) || (address > CMD_ADDRESS_MAX)
+			|| (group < 0) || (group > CMD_ADDRESS_MAX)) {
+		return false;
+	}
+	COM_address = address;
+	COM_group = group;
+	COM_ApplyAddress();
+	NV_Write(NV_KEY_COM_ADDRESS, address);	// only written if changed
+	NV_Write(NV_KEY_COM_GROUP, group);
+	return true;
+}
+
+/**************************************************************************//**
+ * @brief Get the address of this lamp on a bus
+ *
+ * @return 1 ... CMD_ADDRESS_MAX, 0 = no bus
+ ******************************************************************************/
+uint32_t COM_GetAddress(void) {
+	return COM_address;
+}
+
+/**************************************************************************//**
+ * @brief Get the group of this lamp on a bus
+ *
+ * @return 1 ... CMD_ADDRESS_MAX, 0 = no group
+ ******************************************************************************/
+uint32_t COM_GetGroup(void) {
+	return COM_group;
 }
 
 /**************************************************************************//**
  * @brief LEUART0 RX IRQ Handler
  *
  * <b>RX Data Valid</b> is handled as follows:
- * @n Copies one char from the RX-HW to the RX buffer.
- * @n '\\r' and '\\n' are considered as end of string character and
- * COM_Received_Request() is called.
- * @n If the buffer is full, it is also handled as end of string.
+ * @n Passes one char from the RX-HW to the command parser.
+ * @n COM_END_OF_STRING is passed as CMD_END_OF_LINE.
+ * @n During a stream the bytes are passed to the stream instead.
  *
  * <b>TX Buffer Level</b> is handled as follows:
  * @n If COM_TX_Busy_Flag is set
  * @n one char at a time is copied from the TX buffer to the TX-HW.
  * @n After sending the string COM_TX_Busy_Flag is cleared
- * and the buffer level interrupt is disabled.
+ * and the buffer level interrupt is disabled,
+ * unless the next queued string is started.
+ *
+ * <b>TX Complete</b> switches to the stream,
+ * after the last reply has left the shift register.
  *****************************************************************************/
 void LEUART0_IRQHandler(void) {
 	if (COM_LEUART->STATUS & LEUART_STATUS_RXDATAV) {// Check for RX data valid
 		char new_char = COM_LEUART->RXDATA;		// Fetch the newly received char
-		if ((COM_END_OF_STRING != new_char) && (COM_BUF_SIZE > RX_index)) {	// A "normal" char
-			RX_buf[RX_index] = new_char;	// store the received char
-			RX_index++;						// and increment the index
-		} else {							// End of string is reached
-			RX_buf[RX_index] = '\0';		// Put end of string char
-			strncpy(COM_RX_Data, RX_buf, COM_BUF_SIZE);	// copy new request
-			COM_RX_Available_Flag = true;	// ready for processing
-			RX_index = 0;					// Start a new string
+		if (COM_STREAM == COM_link) {
+			STR_Receive(new_char, sl_sleeptimer_get_tick_count());
+		} else {
+			if (COM_END_OF_STRING == new_char) {
+				new_char = CMD_END_OF_LINE;	// End of string is reached
+			}
+			if (CMD_END_OF_LINE == new_char) {
+				CMD_Stamp(sl_sleeptimer_get_tick_count());
+			}
+			CMD_Parse(new_char);			// parse as it arrives
+		}
+	}
+
+	if (COM_LEUART->IF & COM_LEUART->IEN & LEUART_IF_TXC) {	// last reply sent
+		LEUART_IntDisable(COM_LEUART, LEUART_IEN_TXC);
+		LEUART_IntClear(COM_LEUART, LEUART_IFC_TXC);
+		if ((COM_STREAM_PENDING == COM_link) && !COM_TX_Busy_Flag) {
+			COM_Baudrate(true);
+			COM_link = COM_STREAM;
 		}
 	}
 
@@ -196,6 +546,11 @@ void LEUART0_IRQHandler(void) {
 				COM_LEUART->IEN &= ~(LEUART_IEN_TXBL);	// Disable interrupt
 				TX_index = 0;					// and start anew
 				COM_TX_Busy_Flag = false;// Clear flag to avoid restart of sending
+				if (COM_stamp_sending) {		// sent after the last two chars
+					COM_stamp = sl_sleeptimer_get_tick_count() + COM_END_TICKS;
+					COM_stamp_valid = true;
+				}
+				COM_TX_Next();					// unless more strings are queued
 			}
 		}
 	}
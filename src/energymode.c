@@ -0,0 +1,139 @@
+/** ***************************************************************************
+ * @file
+ * @brief Energy mode manager
+ *
+ * Waits for the next user interface scan in the deepest legal energy mode.
+ *
+ * The legal mode depends on the active outputs:
+ * @n - RGB on: TIMER0 generates the PWM => EM1
+ * @n - white only or lamp off: TIMER0 is stopped,
+ * LETIMER0, RTC, LCD, LEUART and GPIO keep running => EM2
+ *
+ * EM3 is never legal, as the LF clocks are needed for the wallclock,
+ * the white PWM, the display and the wake up by the serial interface.
+ *
+ * A clap or a new set point starts TIMER0 again
+ * within one PWM period (see powerLEDs.c).
+ *
+ * EM2 stops the HF crystal. The core wakes up on the HFRCO at once,
+ * so an interrupt is handled within a few us and not after the start-up
+ * of the crystal (about 0.5 ms), e.g. the white dither of powerLEDs.c
+ * at each LETIMER0 underflow, which then sleeps in EM2 again.
+ * The crystal is started only if EM1 follows, i.e. TIMER0 has been started
+ * by a clap, TIMER0_IRQHandler() switches to it at the beginning
+ * of a PWM period. Until then TIMER0 runs at the HFRCO frequency
+ * with the correct duty cycles. EMM_Sleep() waits for it before it returns.
+ *
+ * The time spent in each mode is counted with the sleeptimer ticks.
+ * EM0 includes the touch sensing, which waits in EM1 itself.
+ *
+ * Prefix: EMM
+ *
+ * Board:  Starter Kit EFM32-G8XX-STK
+ * Device: EFM32G890F128 (Gecko)
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_emu.h"
+
+#include "sl_sleeptimer.h"
+
+#include "energymode.h"
+#include "powerLEDs.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+static sl_sleeptimer_timer_handle_t EMM_timer;	///< periodic user interface tick
+static volatile bool EMM_tick = false;		///< set by the timer callback
+static uint32_t EMM_last_ticks = 0;		///< sleeptimer ticks at last wake up
+static uint64_t EMM_ticks[EMM_MODE_COUNT];	///< residency in sleeptimer ticks
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Sleeptimer callback: next user interface scan is due
+ * @param [in] handle of the timer (not used)
+ * @param [in] data of the timer (not used)
+ *****************************************************************************/
+static void EMM_TimerCallback(sl_sleeptimer_timer_handle_t *handle, void *data) {
+	(void)handle;
+	(void)data;
+	EMM_tick = true;
+}
+
+/** ***************************************************************************
+ * @brief Start the periodic user interface tick and the residency counters
+ * @note The sleeptimer must be initialized.
+ *****************************************************************************/
+void EMM_Init(void) {
+	EMM_last_ticks = sl_sleeptimer_get_tick_count();
+	sl_sleeptimer_start_periodic_timer_ms(&EMM_timer, EMM_TICK_MS,
+			EMM_TimerCallback, NULL, 0, 0);
+}
+
+/** ***************************************************************************
+ * @brief Sleep until the next user interface tick
+ *
+ * The mode is chosen anew after each wake up,
+ * as an interrupt may have changed the active outputs.
+ * @n Interrupts are masked while checking the flag and going to sleep,
+ * so a wake up between these two steps is not lost.
+ * @n After EM2 this waits for the start-up of the HF crystal and switches to it.
+ * EM2 is only chosen once TIMER0 has been tuned to the crystal after boot
+ * (see PWR_sleep_prepare()), so nothing has to be retuned.
+ *****************************************************************************/
+void EMM_Sleep(void) {
+	__disable_irq();
+	uint32_t now = sl_sleeptimer_get_tick_count();
+	EMM_ticks[EMM_EM0] += now - EMM_last_ticks;	// running since last wake up
+	bool deep = false;						// has been in EM2
+	while (!EMM_tick) {
+		EMM_mode_t mode = PWR_sleep_prepare() ? EMM_EM1 : EMM_EM2;
+		uint32_t start = now;
+		if (EMM_EM1 == mode) {
+			if (deep) {						// e.g. TIMER0 started by a clap
+				CMU_OscillatorEnable(cmuOsc_HFXO, true, false);	// not waited for
+			}
+			EMU_EnterEM1();
+		} else {
+			EMU_EnterEM2(false);			// wake up on the HFRCO
+		}
+		now = sl_sleeptimer_get_tick_count();
+		EMM_ticks[mode] += now - start;
+		deep = deep || (EMM_EM2 == mode);
+		__enable_irq();						// handle the wake up interrupt
+		__disable_irq();
+	}
+	EMM_last_ticks = now;
+	EMM_tick = false;
+	__enable_irq();
+	if (deep && !(CMU->STATUS & CMU_STATUS_HFXOSEL)) {
+		CMU_ClockSelectSet(cmuClock_HF, cmuSelect_HFXO);	// waits for the crystal
+	}
+}
+
+/** ***************************************************************************
+ * @brief Get the time spent in an energy mode since EMM_Init()
+ * @param [in] mode EMM_EM0, EMM_EM1 or EMM_EM2
+ * @return residency in s
+ *****************************************************************************/
+uint32_t EMM_GetResidency(EMM_mode_t mode) {
+	if (mode >= EMM_MODE_COUNT) {
+		return 0;
+	}
+	return EMM_ticks[mode] / sl_sleeptimer_get_timer_frequency();
+}
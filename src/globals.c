@@ -12,6 +12,7 @@
 #include "em_cmu.h"
 
 #include "globals.h"
+#include "communication.h"
 
 /******************************************************************************
  * Defines
@@ -21,6 +22,7 @@
 /******************************************************************************
  * Variables
  *****************************************************************************/
+volatile uint32_t G_boot_us = 0;		///< boot trace: reset to first PWM edge
 
 
 /******************************************************************************
@@ -29,24 +31,117 @@
 
 
 /** ***************************************************************************
- * @brief Start crystal oscillators and use these clock sources
+ * @brief Start clocks for a fast boot
+ *
+ * The RC oscillators run immediately, so the system starts without waiting
+ * for the crystals. These are enabled but not waited for.
+ * @n Switching to the crystals is done as soon as they are ready:
+ * @n - HF: INIT_HFXO_switch() is called from TIMER0_IRQHandler()
+ * to switch at the beginning of a PWM period
+ * @n - LF: by the CMU interrupt handler
  *
  * High frequency clock = 32MHhz (defined by crystal on the starter kit)
  * Low frequency clock = 32.768kHz (defined by crystal on the starter kit)
  *****************************************************************************/
 void INIT_XOclocks() {
-	// High frequency clock
-	CMU_OscillatorEnable(cmuOsc_HFXO, true, true);
-	CMU_ClockSelectSet(cmuClock_HF, cmuSelect_HFXO);
+	// High frequency clock, runs on HFRCO until the crystal is ready
 	CMU_ClockEnable(cmuClock_HFPER, true);
-	// Low frequency clock
-	CMU_OscillatorEnable(cmuOsc_LFXO, true, true);
-	CMU_ClockSelectSet(cmuClock_CORELE, cmuSelect_LFXO);
+	CMU_OscillatorEnable(cmuOsc_HFXO, true, false);
+	// Low frequency clock, runs on LFRCO until the crystal is ready
+	CMU_OscillatorEnable(cmuOsc_LFRCO, true, true);
 	CMU_ClockEnable(cmuClock_CORELE, true);
-	CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_LFXO);
+	CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_LFRCO);
 	CMU_ClockEnable(cmuClock_LFA, true);
-	CMU_ClockSelectSet(cmuClock_LFB, cmuSelect_LFXO);
+	CMU_ClockSelectSet(cmuClock_LFB, cmuSelect_LFRCO);
 	CMU_ClockEnable(cmuClock_LFB, true);
+	CMU_OscillatorEnable(cmuOsc_LFXO, true, false);
+	// Interrupt when the LF crystal is ready
+	CMU_IntClear(CMU_IFC_LFXORDY);
+	CMU_IntEnable(CMU_IEN_LFXORDY);
+	NVIC_ClearPendingIRQ(CMU_IRQn);
+	NVIC_EnableIRQ(CMU_IRQn);
+}
+
+
+/** ***************************************************************************
+ * @brief Switch the HF clock to the crystal, if it is ready
+ * @return true = the clock has been switched just now
+ *
+ * Called at the beginning of a PWM period,
+ * the caller has to adjust all the clock dependent settings.
+ *****************************************************************************/
+bool INIT_HFXO_switch(void) {
+	if ((CMU->STATUS & CMU_STATUS_HFXORDY) && !(CMU->STATUS & CMU_STATUS_HFXOSEL)) {
+		CMU_ClockSelectSet(cmuClock_HF, cmuSelect_HFXO);
+		return true;
+	}
+	return false;
+}
+
+
+/** ***************************************************************************
+ * @brief CMU interrupt handler: switch the LF clocks to the crystal
+ *
+ * The LFRCO has the same nominal frequency,
+ * only the baud rate is recalculated for the exact crystal frequency.
+ *****************************************************************************/
+void CMU_IRQHandler(void) {
+	if (CMU->IF & CMU_IF_LFXORDY) {
+		CMU_IntClear(CMU_IFC_LFXORDY);
+		CMU_IntDisable(CMU_IEN_LFXORDY);
+		CMU_ClockSelectSet(cmuClock_LFA, cmuSelect_LFXO);
+		CMU_ClockSelectSet(cmuClock_LFB, cmuSelect_LFXO);
+		CMU_OscillatorEnable(cmuOsc_LFRCO, false, false);
+		COM_Retune();
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Start the cycle counter of the core
+ *
+ * Used for time measurements, e.g. boot time.
+ * @note Counts from the call of this function, i.e. from the start of main().
+ * The startup code before main() (copying initialized data) is not included.
+ *****************************************************************************/
+void G_CycleCounterInit(void) {
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	DWT->CYCCNT = 0;
+	DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+
+/** ***************************************************************************
+ * @brief Boot trace: the first PWM edge occurs now
+ *
+ * Called from TIMER0_IRQHandler() as long as G_boot_us is 0.
+ * PWR_init() starts TIMER0 at TOP with the compares already written,
+ * so the first overflow is the start of the first lit PWM period
+ * and not the end of it.
+ * The CPU still runs on the same clock as since reset.
+ *****************************************************************************/
+void G_BootTraceFirstEdge(void) {
+	uint32_t mhz = CMU_ClockFreqGet(cmuClock_CORE) / 1000000;
+	G_boot_us = G_Cycles() / mhz;
+}
+
+
+/** ***************************************************************************
+ * @brief Boot trace: send the boot time once over the serial interface
+ *
+ * "boot <us>" = microseconds from reset to the first PWM edge
+ * @n Not on a bus, where the lamps only answer when asked.
+ *****************************************************************************/
+void G_BootTraceReport(void) {
+	static bool reported = false;
+	if (!reported && G_boot_us && !COM_TX_Busy()) {
+		if (!COM_GetAddress()) {
+			char message[COM_BUF_SIZE] = "boot ";
+			ltostr(G_boot_us, message + 5);
+			COM_TX_PutData(message, COM_BUF_SIZE);
+		}
+		reported = true;
+	}
 }
 
 
@@ -0,0 +1,45 @@
+/** ***************************************************************************
+ * @file
+ * @brief See bcm.c
+ *****************************************************************************/
+
+#ifndef BCM_H_
+#define BCM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "em_gpio.h"
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define BCM_BITS			8				///< resolution in bits (= slices)
+#define BCM_FREQUENCY		500				///< modulation frequency in Hz
+
+/** Channels of the BCM driver, add pins in BCM_pin[] of bcm.c */
+#define BCM_AMBER			0				///< amber power LED
+#define BCM_CHANNEL_COUNT	1				///< number of channels
+
+#define BCM_PORT			gpioPortD		///< Port of all BCM channels
+#define BCM_AMBER_PIN		0				///< amber on PD0
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+void BCM_Init(void);
+
+void BCM_Retune(void);
+
+void BCM_Set(uint32_t channel, uint32_t value);
+
+bool BCM_Running(void);
+
+uint32_t BCM_GetLoad(void);
+
+#endif
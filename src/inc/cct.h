@@ -0,0 +1,42 @@
+/** ***************************************************************************
+ * @file
+ * @brief See cct.c
+ *****************************************************************************/
+
+#ifndef CCT_H_
+#define CCT_H_
+
+#include <stdint.h>
+
+#include "powerLEDs.h"
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define CCT_KELVIN_MIN			2000		///< warmest colour temperature
+#define CCT_KELVIN_MAX			6500		///< coolest colour temperature
+#define CCT_KELVIN_START		2700		///< colour temperature after reset
+#define CCT_BRIGHTNESS_MAX		100			///< brightness in %
+#define CCT_BRIGHTNESS_STEP		10			///< brightness step of the pushbuttons
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+void CCT_Init(void);
+
+void CCT_SetKelvin(int32_t kelvin);
+
+int32_t CCT_GetKelvin(void);
+
+void CCT_SetBrightness(int32_t percent);
+
+int32_t CCT_GetBrightness(void);
+
+void CCT_Mix(int32_t value[PWR_SOLUTION_COUNT]);
+
+#endif
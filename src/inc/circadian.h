@@ -0,0 +1,36 @@
+/** ***************************************************************************
+ * @file
+ * @brief See circadian.c
+ *****************************************************************************/
+
+#ifndef CIRCADIAN_H_
+#define CIRCADIAN_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define CIRC_UPDATE_MIN_MS		1000		///< never update faster than this
+#define CIRC_UPDATE_MAX_MS		60000		///< but at least once per minute
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+void CIRC_Start(void);
+
+void CIRC_Stop(void);
+
+bool CIRC_Update(int32_t *white, int32_t *amber);
+
+bool CIRC_SetClock(int32_t hhmm);
+
+int32_t CIRC_GetClock(void);
+
+#endif
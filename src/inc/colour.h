@@ -0,0 +1,28 @@
+/** ***************************************************************************
+ * @file
+ * @brief See colour.c
+ *****************************************************************************/
+
+#ifndef COLOUR_H_
+#define COLOUR_H_
+
+#include <stdint.h>
+
+#include "powerLEDs.h"
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define COL_ONE			4096				///< 1.0 in fixed point Q12
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+void COL_Mix(uint32_t rgb, uint32_t brightness, int32_t value[PWR_SOLUTION_COUNT]);
+
+#endif
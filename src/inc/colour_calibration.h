@@ -0,0 +1,46 @@
+/** ***************************************************************************
+ * @file
+ * @brief Colour calibration, generated by tools/colgen.c - do not edit
+ *
+ * Fixed point Q12, see colour.c
+ *
+ * Regenerate in tools/ after a new measurement of the primaries:
+ * @n gcc -o colgen colgen.c -lm
+ * @n ./colgen < primaries.txt > ../src/inc/colour_calibration.h
+ *****************************************************************************/
+
+#ifndef COLOUR_CALIBRATION_H_
+#define COLOUR_CALIBRATION_H_
+
+/** linear sRGB -> lamp RGB */
+#define COL_MATRIX		{ \
+	{ 2344, 1198, 86 }, \
+	{ 183, 2855, 33 }, \
+	{ 25, 6, 2000 } \
+}
+
+/** white and amber at full drive in lamp RGB, with reciprocals */
+#define COL_WHITE		{ 3677, 3036, 2175 }
+#define COL_WHITE_INV	{ 18690867, 22638327, 31591936 }
+#define COL_AMBER		{ 2937, 849, -53 }
+#define COL_AMBER_INV	{ 23398403, 80987509, 0 }
+
+/** white, amber, red 0 ... 255 from 2000 K to 6500 K in steps of 500 K,
+ * all with a luminance of 44.5 (unit of the primaries) */
+#define COL_CCT_MIN		2000
+#define COL_CCT_STEP	500
+#define COL_CCT_COUNT	10
+#define COL_CCT_TABLE	{ \
+	{  12, 255,   0 }, \
+	{  21, 231,   0 }, \
+	{  32, 204,   0 }, \
+	{  43, 177,   0 }, \
+	{  54, 148,   0 }, \
+	{  66, 119,   0 }, \
+	{  77,  92,   0 }, \
+	{  88,  64,   0 }, \
+	{  98,  38,   0 }, \
+	{ 109,  12,   0 } \
+}
+
+#endif
@@ -0,0 +1,70 @@
+/** ***************************************************************************
+ * @file
+ * @brief See commands.c
+ *****************************************************************************/
+
+#ifndef COMMANDS_H_
+#define COMMANDS_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "commands_table.h"
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define CMD_OK					0			///< command executed
+#define CMD_ERR_UNKNOWN			1			///< no such command
+#define CMD_ERR_ARGUMENT		2			///< argument missing or invalid
+
+#define CMD_QUEUE_SIZE			8			///< parsed commands waiting, power of 2
+#define CMD_WINDOW				CMD_QUEUE_SIZE	///< requests a client may have in flight
+#define CMD_TAG_MARK			'@'			///< starts the request id, e.g. "@17 red 80"
+#define CMD_TAG_MAX				0xFFFF		///< max request id
+#define CMD_ADDRESS_MARK		'>'			///< starts the address, e.g. ">3 red 80"
+#define CMD_ADDRESS_ALL			'*'			///< all the lamps, e.g. ">* red 80"
+#define CMD_ADDRESS_GROUP		'g'			///< a group, e.g. ">g2 red 80"
+#define CMD_ADDRESS_MAX			254			///< max address and group
+#define CMD_END_OF_LINE			'\0'		///< fed to CMD_Parse() at the end of a line
+
+/** A parsed and validated command */
+typedef struct {
+	uint8_t id;								///< CMD_id_t
+	uint8_t error;							///< CMD_OK or error found by the parser
+	uint8_t argc;							///< number of arguments
+	bool tagged;							///< has a request id
+	uint16_t tag;							///< request id, echoed in the reply
+	bool silent;							///< to a group or to all, don't answer
+	uint32_t received;						///< time of the end of the line
+	int32_t arg[CMD_ARG_MAX];				///< arguments
+} CMD_command_t;
+
+/** Handler of a command
+ * @param [in] command with its arguments, already validated
+ * @return CMD_OK or CMD_ERR_ARGUMENT */
+typedef int32_t (*CMD_handler_t)(const CMD_command_t *command);
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+void CMD_Parse(char c);
+
+void CMD_Stamp(uint32_t time);
+
+void CMD_Reset(void);
+
+bool CMD_Get(CMD_command_t *command);
+
+void CMD_SetAddress(uint32_t address, uint32_t group);
+
+uint32_t CMD_GetDropped(void);
+
+int32_t CMD_Execute(const CMD_command_t *command, const CMD_handler_t handler[CMD_COUNT]);
+
+#endif
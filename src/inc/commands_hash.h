@@ -0,0 +1,42 @@
+/** ***************************************************************************
+ * @file
+ * @brief Hash of the command names, see commands.c
+ *
+ * Shared by the parser of the firmware (commands.c) and the generator
+ * of its table (tools/cmdgen.c), so the slots cannot drift apart.
+ * Independent of commands_table.h, which the generator writes.
+ *****************************************************************************/
+
+#ifndef COMMANDS_HASH_H_
+#define COMMANDS_HASH_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Add a char of the name to the hash (FNV-1a)
+ * @param [in] hash so far, the seed before the first char
+ * @param [in] c char of the name
+ * @return hash with this char
+ *****************************************************************************/
+static inline uint32_t CMD_HashStep(uint32_t hash, char c) {
+	return (hash ^ (uint8_t)c) * 0x01000193u;
+}
+
+/** ***************************************************************************
+ * @brief Slot of a complete name
+ * @param [in] hash of all chars of the name
+ * @param [in] bits 2^bits slots
+ * @return slot 0 ... 2^bits-1
+ *****************************************************************************/
+static inline uint32_t CMD_HashSlot(uint32_t hash, uint32_t bits) {
+	hash ^= hash >> 16;						// mix, so each seed gives new slots
+	hash *= 0x7FEB352Du;
+	hash ^= hash >> 15;
+	return hash >> (32 - bits);
+}
+
+#endif
@@ -0,0 +1,112 @@
+/** ***************************************************************************
+ * @file
+ * @brief Remote control commands, generated by tools/cmdgen.c - do not edit
+ *
+ * Perfect hash of the names, see commands.c
+ *****************************************************************************/
+
+#ifndef COMMANDS_TABLE_H_
+#define COMMANDS_TABLE_H_
+
+/** Ids of the commands */
+typedef enum {
+	CMD_WHITE,
+	CMD_AMBER,
+	CMD_RED,
+	CMD_GREEN,
+	CMD_BLUE,
+	CMD_CIRCADIAN,
+	CMD_CCT,
+	CMD_IDLE,
+	CMD_START,
+	CMD_EM,
+	CMD_BCM,
+	CMD_REG,
+	CMD_CUT,
+	CMD_PWM,
+	CMD_COL,
+	CMD_OUT,
+	CMD_SUB,
+	CMD_STREAM,
+	CMD_JIT,
+	CMD_ADR,
+	CMD_GRP,
+	CMD_TS,
+	CMD_TSQ,
+	CMD_DROP,
+	CMD_LAT,
+	CMD_COUNT
+} CMD_id_t;
+
+#define CMD_HASH_SEED	56u		///< start value of the hash
+#define CMD_HASH_BITS	6			///< 2^bits slots
+#define CMD_NAME_MAX	9			///< length of the longest name
+#define CMD_ARG_MAX		2			///< max number of arguments
+
+/** Names of the commands by id */
+#define CMD_NAMES	{ \
+	"white", \
+	"amber", \
+	"red", \
+	"green", \
+	"blue", \
+	"circadian", \
+	"cct", \
+	"idle", \
+	"start", \
+	"em", \
+	"bcm", \
+	"reg", \
+	"cut", \
+	"pwm", \
+	"col", \
+	"out", \
+	"sub", \
+	"stream", \
+	"jit", \
+	"adr", \
+	"grp", \
+	"ts", \
+	"tsq", \
+	"drop", \
+	"lat" \
+}
+
+/** Min and max number of arguments and their base by id */
+#define CMD_ARGS	{ \
+	{ 0, 1, 10 }, \
+	{ 0, 1, 10 }, \
+	{ 0, 1, 10 }, \
+	{ 0, 1, 10 }, \
+	{ 0, 1, 10 }, \
+	{ 0, 1, 10 }, \
+	{ 0, 2, 10 }, \
+	{ 0, 1, 10 }, \
+	{ 0, 1, 10 }, \
+	{ 1, 1, 10 }, \
+	{ 0, 0, 10 }, \
+	{ 0, 0, 10 }, \
+	{ 1, 1, 10 }, \
+	{ 1, 1, 10 }, \
+	{ 1, 1, 16 }, \
+	{ 0, 0, 10 }, \
+	{ 0, 1, 10 }, \
+	{ 0, 1, 10 }, \
+	{ 1, 1, 10 }, \
+	{ 0, 1, 10 }, \
+	{ 0, 1, 10 }, \
+	{ 1, 2, 10 }, \
+	{ 1, 1, 10 }, \
+	{ 0, 0, 10 }, \
+	{ 1, 2, 10 } \
+}
+
+/** Id by slot, CMD_COUNT = empty slot */
+#define CMD_SLOTS	{ \
+	25, 25, 25, 25, 24, 18, 25, 3, 0, 25, 25, 25, 11, 5, 25, 21, \
+	25, 4, 15, 25, 12, 25, 25, 20, 1, 25, 14, 8, 25, 25, 6, 25, \
+	25, 25, 25, 25, 25, 16, 19, 25, 25, 25, 10, 25, 25, 13, 25, 23, \
+	25, 25, 25, 25, 22, 25, 7, 17, 9, 25, 25, 25, 25, 25, 2, 25 \
+}
+
+#endif
@@ -9,7 +9,12 @@
 /******************************************************************************
  * Defines
  *****************************************************************************/
-#define COM_BUF_SIZE 16		///< buffer size, incl. '\0' for string termination
+#define COM_BUF_SIZE 32		///< TX buffer size, incl. '\0' for string termination
+#define COM_BAUDRATE 9600	///< baud rate of the serial interface
+#define COM_STREAM_BAUDRATE 115200	///< baud rate during a colour stream
+
+#define COM_NOTIFY_INTERVAL_MS		100		///< default min time between notifications
+#define COM_NOTIFY_INTERVAL_MAX_MS	60000	///< max selectable interval
 
 /** @todo Maybe change the end of string character.
  * It has to be the same as in the remote device.
@@ -28,10 +33,19 @@
  * Functions
  *****************************************************************************/
 void COM_Init(void);
+void COM_Retune(void);
 void COM_Flush_Buffers(void);
-bool COM_RX_Available(void);
-void COM_RX_GetData(char * string, uint32_t n);
 bool COM_TX_Busy(void);
 void COM_TX_PutData(char * string, uint32_t n);
+void COM_TX_Notify(uint32_t key, const char * string);
+void COM_TX_Stamp(void);
+bool COM_TX_GetStamp(uint32_t *tick);
+void COM_Process(void);
+void COM_Stream(void);
+bool COM_SetAddress(int32_t address, int32_t group);
+uint32_t COM_GetAddress(void);
+uint32_t COM_GetGroup(void);
+void COM_Subscribe(uint32_t interval_ms);
+uint32_t COM_GetSubscription(void);
 
 #endif
@@ -0,0 +1,59 @@
+/** ***************************************************************************
+ * @file
+ * @brief Register model of the hardware cut-off of RGB, see powerLEDs.c
+ *
+ * Needs the device header, so it is kept out of powerLEDs.h,
+ * which is also included by the host tools (e.g. stream.h).
+ * Included by powerLEDs.c and tools/cutcheck.c only.
+ *****************************************************************************/
+
+#ifndef CUTOFF_H_
+#define CUTOFF_H_
+
+#include <stdint.h>
+
+#include "em_device.h"
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+
+/** Register values of the hardware cut-off ACMP0 -> PRS -> TIMER0 DTI */
+typedef struct {
+	uint32_t prs_channel;					///< PRS channel used
+	uint32_t prs_ctrl;						///< PRS->CH[prs_channel].CTRL
+	uint32_t dtctrl;						///< TIMER0->DTCTRL
+	uint32_t dtfc;							///< TIMER0->DTFC
+	uint32_t dtogen;						///< TIMER0->DTOGEN
+} PWR_cutoff_regs_t;
+
+#define PWR_CUTOFF_PRS_CHANNEL	1			///< PRS channel ACMP0 -> TIMER0
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Model of the register configuration for the hardware cut-off
+ * @param [out] regs register values for PRS, ACMP0 and TIMER0 DTI
+ *
+ * The routing is defined here only, so it is checked on a host
+ * (tools/cutcheck.c) and compared with the live registers on the target
+ * (PWR_cutoff_verify).
+ *****************************************************************************/
+static inline void PWR_cutoff_model(PWR_cutoff_regs_t *regs) {
+	/* ACMP0 output as level, high = shunt voltage above the reference */
+	regs->prs_ctrl = PRS_CH_CTRL_SOURCESEL_ACMP0 | PRS_CH_CTRL_SIGSEL_ACMP0OUT
+			| PRS_CH_CTRL_EDSEL_OFF;
+	regs->prs_channel = PWR_CUTOFF_PRS_CHANNEL;
+	/* DTI on, PRS fault source 0 is the same PRS channel, outputs inactive */
+	regs->dtctrl = TIMER_DTCTRL_DTEN;
+	regs->dtfc = TIMER_DTFC_DTPRS0FEN | TIMER_DTFC_DTFA_INACTIVE
+			| (PWR_CUTOFF_PRS_CHANNEL << _TIMER_DTFC_DTPRS0FSEL_SHIFT);
+	/* the CC outputs of red, green and blue are controlled by the DTI */
+	regs->dtogen = TIMER_DTOGEN_DTOGCC0EN | TIMER_DTOGEN_DTOGCC1EN
+			| TIMER_DTOGEN_DTOGCC2EN;
+}
+
+
+#endif
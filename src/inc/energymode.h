@@ -0,0 +1,38 @@
+/** ***************************************************************************
+ * @file
+ * @brief See energymode.c
+ *****************************************************************************/
+
+#ifndef ENERGYMODE_H_
+#define ENERGYMODE_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define EMM_TICK_MS			20				///< user interface scan period
+
+/** Energy modes with residency counters */
+typedef enum {
+	EMM_EM0 = 0,							///< running (incl. touch sensing)
+	EMM_EM1,								///< sleep, HF peripherals running
+	EMM_EM2,								///< deep sleep, only LF peripherals
+	EMM_MODE_COUNT
+} EMM_mode_t;
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+void EMM_Init(void);
+
+void EMM_Sleep(void);
+
+uint32_t EMM_GetResidency(EMM_mode_t mode);
+
+#endif
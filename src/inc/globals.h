@@ -6,6 +6,10 @@
 #ifndef GLOBALS_H_
 #define GLOBALS_H_
 
+#include <stdbool.h>
+#include <stdint.h>
+#include "em_device.h"
+
 
 /******************************************************************************
  * Defines
@@ -15,6 +19,7 @@
 /******************************************************************************
  * Variables
  *****************************************************************************/
+extern volatile uint32_t G_boot_us;
 
 
 /******************************************************************************
@@ -23,6 +28,22 @@
 
 void INIT_XOclocks();
 
+bool INIT_HFXO_switch(void);
+
+void G_CycleCounterInit(void);
+
+/** ***************************************************************************
+ * @brief Read the cycle counter of the core
+ * @return number of core clock cycles since G_CycleCounterInit()
+ *****************************************************************************/
+__STATIC_INLINE uint32_t G_Cycles(void) {
+	return DWT->CYCCNT;
+}
+
+void G_BootTraceFirstEdge(void);
+
+void G_BootTraceReport(void);
+
 void ltostr(int32_t l, char *string);
 
 #endif
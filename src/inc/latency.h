@@ -0,0 +1,83 @@
+/** ***************************************************************************
+ * @file
+ * @brief See latency.c
+ *****************************************************************************/
+
+#ifndef LATENCY_H_
+#define LATENCY_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+/** Trace the latency from the inputs to the light.
+ * Comment out to compile the tracer out, the calls are removed as well. */
+#define LAT_TRACE
+
+#define LAT_TICK_HZ			32768			///< time base of the callers (sleeptimer)
+#define LAT_SUB_BUCKETS		4				///< buckets per power of 2, power of 2
+#define LAT_BUCKET_COUNT	64				///< up to 2^17 ticks = 4 s
+
+/** Inputs whose way to the light is measured */
+typedef enum {
+	LAT_REMOTE = 0,							///< state command, from the end of its line
+	LAT_TOUCH,								///< slider, from the sweep before it
+	LAT_BUTTON,								///< pushbutton, from its interrupt
+	LAT_CLAP,								///< clap, from the sample switching the lamp
+	LAT_SOURCE_COUNT
+} LAT_source_t;
+
+/** Information on the latencies of an input, see LAT_GetInfo() */
+typedef enum {
+	LAT_COUNT = 0,							///< samples taken
+	LAT_MIN_US,
+	LAT_AVG_US,
+	LAT_P50_US,								///< upper bound of the bucket
+	LAT_P90_US,
+	LAT_P99_US,
+	LAT_MAX_US,
+	LAT_INFO_COUNT
+} LAT_info_t;
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+#ifdef LAT_TRACE
+
+void LAT_Input(uint32_t source, uint32_t now);
+
+uint32_t LAT_InputTime(uint32_t source);
+
+void LAT_Arm(uint32_t source, uint32_t start);
+
+void LAT_Stage(void);
+
+bool LAT_Staged(void);
+
+void LAT_Commit(uint32_t now);
+
+void LAT_Reset(uint32_t source);
+
+int32_t LAT_GetInfo(uint32_t source, uint32_t info);
+
+#else										// nothing left, arguments not evaluated
+
+#define LAT_Input(source, now)
+#define LAT_InputTime(source)		0
+#define LAT_Arm(source, start)
+#define LAT_Stage()
+#define LAT_Staged()				false
+#define LAT_Commit(now)
+#define LAT_Reset(source)
+#define LAT_GetInfo(source, info)	0
+
+#endif
+
+#endif
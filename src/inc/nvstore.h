@@ -0,0 +1,51 @@
+/** ***************************************************************************
+ * @file
+ * @brief See nvstore.c
+ *****************************************************************************/
+
+#ifndef NVSTORE_H_
+#define NVSTORE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define NV_PAGE_COUNT			4			///< flash pages used for the log
+#define NV_COMMIT_DELAY_MS		2000		///< commit only after values settled
+#define NV_COMMIT_INTERVAL_MS	10000		///< and at most once in this time
+
+/** Keys of the stored values */
+#define NV_KEY_PWR_VALUE		0			///< first of 8 set points (powerLEDs)
+#define NV_KEY_CAPSENSE			8			///< first of 8 calibration values
+#define NV_KEY_COM_ADDRESS		16			///< address on the bus (communication)
+#define NV_KEY_COM_GROUP		17			///< group on the bus (communication)
+#define NV_KEY_CCT_KELVIN		18			///< colour temperature (cct)
+#define NV_KEY_CCT_BRIGHTNESS	19			///< brightness of the CCT mode (cct)
+#define NV_KEY_COUNT			32			///< number of keys (max 32, bit masks)
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+#ifdef NV_FLASH_EMULATION
+extern uint32_t NV_emulation_flash[];		///< the emulated pages, erased = 0xFF
+extern int32_t NV_emulation_budget;			///< flash operations until power loss
+extern uint32_t NV_emulation_ms;			///< time base of the emulation
+#endif
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+void NV_Init(void);
+
+bool NV_Read(uint32_t key, uint32_t *value);
+
+void NV_Write(uint32_t key, uint32_t value);
+
+void NV_Process(void);
+
+void NV_Flush(void);
+
+#endif
@@ -0,0 +1,44 @@
+/** ***************************************************************************
+ * @file
+ * @brief GPIO access with compile-time port and pin
+ *
+ * Each access resolves to a single load or store to the bit-band alias
+ * of the GPIO register (Cortex-M3, peripheral bit-band region).
+ * Port and pin must be constants, so the alias address is calculated
+ * by the compiler and no shift or mask is left at run time.
+ * @n Writes to the alias are atomic, so pins of a port may be written
+ * in interrupt handlers and the main loop at the same time.
+ *
+ * For several pins at once or for run-time pin numbers use emlib em_gpio.h.
+ *
+ * Prefix: PIN
+ *
+ * Board:  Starter Kit EFM32-G8XX-STK
+ * Device: EFM32G890F128 (Gecko)
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#ifndef PINS_H_
+#define PINS_H_
+
+#include "em_device.h"
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+
+/** Bit-band alias of one bit in a peripheral register */
+#define PIN_ALIAS(reg, bit)		(*(volatile uint32_t *)(BITBAND_PER_BASE \
+		+ (((uintptr_t)&(reg) - PER_MEM_BASE) << 5) + ((uint32_t)(bit) << 2)))
+
+#define PIN_SET(port, pin)		(PIN_ALIAS(GPIO->P[port].DOUT, pin) = 1)	///< output high
+#define PIN_CLEAR(port, pin)	(PIN_ALIAS(GPIO->P[port].DOUT, pin) = 0)	///< output low
+#define PIN_WRITE(port, pin, value)	(PIN_ALIAS(GPIO->P[port].DOUT, pin) = (value))
+#define PIN_TOGGLE(port, pin)	(GPIO->P[port].DOUTTGL = 1u << (pin))	///< single store
+#define PIN_OUT(port, pin)		(PIN_ALIAS(GPIO->P[port].DOUT, pin))	///< output 0/1
+#define PIN_IN(port, pin)		(PIN_ALIAS(GPIO->P[port].DIN, pin))		///< input 0/1
+#define PIN_IRQ_FLAG(pin)		(PIN_ALIAS(GPIO->IF, pin))		///< interrupt flag 0/1
+
+#endif
@@ -6,6 +6,9 @@
 #ifndef PWRLEDS_H_
 #define PWRLEDS_H_
 
+#include <stdbool.h>
+#include <stdint.h>
+
 /******************************************************************************
  * Defines
  *****************************************************************************/
@@ -14,6 +17,8 @@
 #define PWR_VALUE_MAX			255			///< max value for set points
 #define PWR_START_VALUE		PWR_VALUE_MAX/4	///< start value for set points
 
+#define PWR_CUTOFF_COUNTER_COUNT	3		///< indexes of PWR_cutoff_diagnostics()
+
 /******************************************************************************
  * Variables
  *****************************************************************************/
@@ -28,8 +33,20 @@ uint32_t PWR_get_value(uint32_t channel);
 
 void PWR_init(void);
 
+uint32_t PWR_set_frequency(uint32_t frequency);
+
+uint32_t PWR_benchmark(void);
+
 void PWR_ACMP_IRQHandler(void);
 
+void PWR_GPIO_IRQHandler(void);
+
+bool PWR_sleep_prepare(void);
+
+bool PWR_cutoff_verify(void);
+
+uint32_t PWR_cutoff_diagnostics(uint32_t index);
+
 void lightOnOrOff(void);
 
 
@@ -9,6 +9,8 @@
 
 #include "em_gpio.h"
 
+#include "pins.h"
+
 
 /******************************************************************************
  * Defines
@@ -61,7 +63,7 @@ __STATIC_INLINE void PB_DisableIRQ(void) {
  * This works independently of an interrupt, it just reads the input.
  *****************************************************************************/
 __STATIC_INLINE bool PB_Status(GPIO_Port_TypeDef port, unsigned int pin) {
-	return !GPIO_PinInGet(port,pin);
+	return !PIN_IN(port, pin);
 }
 
 
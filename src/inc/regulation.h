@@ -0,0 +1,66 @@
+/** ***************************************************************************
+ * @file
+ * @brief See regulation.c
+ *****************************************************************************/
+
+#ifndef REGULATION_H_
+#define REGULATION_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define REG_CHANNEL_COUNT		3			///< regulated channels (R, G, B)
+
+/** @todo Adjust ADC code of the average current PWR_current_max to the shunt */
+#define REG_ADC_CURRENT_MAX		4095		///< ADC code at max average current
+
+#define REG_TRIM_ONE			4096		///< trim factor 1.0 in Q12
+
+/** State and parameters of a fixed point PI controller */
+typedef struct {
+	int32_t kp;								///< proportional gain in Q12
+	int32_t ki;								///< integral gain per step in Q12
+	int32_t limit;							///< output limit +/- in Q12
+	int32_t integral;						///< integral part in Q12
+} REG_pi_t;
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+void REG_Init(void);
+
+void REG_SetTarget(uint32_t channel, uint32_t setpoint);
+
+int32_t REG_GetTrim(uint32_t channel);
+
+uint32_t REG_GetCycles(void);
+
+/** ***************************************************************************
+ * @brief One step of the fixed point PI controller
+ * @param [in,out] pi state and parameters
+ * @param [in] error setpoint - measured value, relative in Q12
+ * @return output in Q12, limited to +/- pi->limit
+ *
+ * The integral part is limited as well (anti windup).
+ * @n No hardware access, so tools/pisim.c runs the very same code on the PC.
+ *****************************************************************************/
+static inline int32_t REG_PI_Step(REG_pi_t *pi, int32_t error) {
+	int32_t integral = pi->integral + ((pi->ki * error) >> 12);
+	if (integral > pi->limit) { integral = pi->limit; }
+	if (integral < -pi->limit) { integral = -pi->limit; }
+	pi->integral = integral;
+	int32_t out = ((pi->kp * error) >> 12) + integral;
+	if (out > pi->limit) { out = pi->limit; }
+	if (out < -pi->limit) { out = -pi->limit; }
+	return out;
+}
+
+#endif
@@ -9,6 +9,8 @@
 #include <stdbool.h>
 #include "em_gpio.h"
 
+#include "pins.h"
+
 /******************************************************************************
  * Defines
  *****************************************************************************/
@@ -37,7 +39,7 @@ void SL_Init(void);
  * @param [in] pin of signal LED
  *****************************************************************************/
 __STATIC_INLINE void SL_On(GPIO_Port_TypeDef port, unsigned int pin) {
-	GPIO_PinOutSet(port, pin);
+	PIN_SET(port, pin);
 }
 
 /** ***************************************************************************
@@ -46,7 +48,7 @@ __STATIC_INLINE void SL_On(GPIO_Port_TypeDef port, unsigned int pin) {
  * @param [in] pin of signal LED
  *****************************************************************************/
 __STATIC_INLINE void SL_Off(GPIO_Port_TypeDef port, unsigned int pin) {
-	GPIO_PinOutClear(port, pin);
+	PIN_CLEAR(port, pin);
 }
 
 /** ***************************************************************************
@@ -55,7 +57,7 @@ __STATIC_INLINE void SL_Off(GPIO_Port_TypeDef port, unsigned int pin) {
  * @param [in] pin of signal LED
  *****************************************************************************/
 __STATIC_INLINE void SL_Toggle(GPIO_Port_TypeDef port, unsigned int pin) {
-	GPIO_PinOutToggle(port, pin);
+	PIN_TOGGLE(port, pin);
 }
 
 /** ***************************************************************************
@@ -80,7 +82,7 @@ __STATIC_INLINE void SL_Set(GPIO_Port_TypeDef port, unsigned int pin,
  * @return true  = signal LED is on, false = signal LED is off
  *****************************************************************************/
 __STATIC_INLINE bool SL_Get(GPIO_Port_TypeDef port, unsigned int pin) {
-	return GPIO_PinOutGet(port, pin);
+	return PIN_OUT(port, pin);
 }
 
 #endif
@@ -0,0 +1,57 @@
+/** ***************************************************************************
+ * @file
+ * @brief See stream.c
+ *****************************************************************************/
+
+#ifndef STREAM_H_
+#define STREAM_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "powerLEDs.h"
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define STR_SYNC			0xA5			///< first byte of a frame
+#define STR_TIME_END		0xFFFF			///< time stamp of the end of the stream
+#define STR_FRAME_SIZE		(3 + PWR_SOLUTION_COUNT + 1)	///< sync, time, values, check
+
+#define STR_BUFFER_SIZE		16				///< frames in the jitter buffer, power of 2
+#define STR_TICK_HZ			32768			///< time base of the callers (sleeptimer)
+#define STR_DELAY_MS		40				///< default playout delay
+#define STR_DELAY_MAX_MS	150				///< max playout delay, fits the buffer at 100 fps
+#define STR_TIMEOUT_MS		2000			///< the stream ends without frames for this time
+
+/** Counters of the stream, see STR_GetCounter() */
+typedef enum {
+	STR_FRAMES = 0,							///< valid frames received
+	STR_LATE,								///< frames received after their playout time
+	STR_UNDERRUNS,							///< buffer empty when the next frame was due
+	STR_OVERRUNS,							///< frames dropped as the buffer was full
+	STR_ERRORS,								///< frames with a wrong check byte
+	STR_COUNTER_COUNT
+} STR_counter_t;
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+void STR_Start(uint32_t delay_ms, uint32_t now);
+
+void STR_Stop(void);
+
+bool STR_Active(void);
+
+void STR_Receive(uint8_t c, uint32_t now);
+
+bool STR_Next(uint32_t now, uint8_t value[PWR_SOLUTION_COUNT]);
+
+uint32_t STR_GetCounter(uint32_t counter);
+
+#endif
@@ -0,0 +1,56 @@
+/** ***************************************************************************
+ * @file
+ * @brief See timesync.c
+ *****************************************************************************/
+
+#ifndef TIMESYNC_H_
+#define TIMESYNC_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define TS_TICK_HZ			32768			///< time base of the callers (sleeptimer)
+#define TS_UNITS_PER_MS		10				///< time of the master in 0.1 ms
+#define TS_STEP_MS			50				///< larger errors set the scene time anew
+#define TS_STEP_COUNT		3				///< after so many large errors in a row
+#define TS_WINDOW_S			8				///< the best sample within this time is taken
+#define TS_BASELINE_MIN_S	32				///< min time over which the drift is measured
+#define TS_BASELINE_MAX_S	512				///< max time over which the drift is measured
+#define TS_DELAY_AGING_US	2				///< the delay grows per exchange
+#define TS_DRIFT_MAX_PPM	500				///< max drift of the lamp against the master
+
+/** Information on the synchronisation, see TS_GetInfo() */
+typedef enum {
+	TS_ERROR_US = 0,						///< error of the last sample before correction
+	TS_DRIFT_PPB,							///< rate of the lamp clock against the master
+	TS_DELAY_US,							///< delay of the link from the master
+	TS_SAMPLES,								///< time samples received
+	TS_OUTLIERS,							///< samples ignored as too far off
+	TS_STEPS,								///< times the scene time has been set anew
+	TS_INFO_COUNT
+} TS_info_t;
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+void TS_Reset(void);
+
+void TS_Request(int32_t t1, uint32_t t2, bool answered);
+
+void TS_Response(uint32_t t3, int32_t t4);
+
+bool TS_Synced(void);
+
+uint32_t TS_SceneTime(uint32_t now);
+
+int32_t TS_GetInfo(uint32_t info);
+
+#endif
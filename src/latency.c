@@ -0,0 +1,251 @@
+/** ***************************************************************************
+ * @file
+ * @brief Latency from an input to the light
+ *
+ * Measures how long it takes from an input, e.g. a remote command,
+ * until the new set point has been written to the LED driver,
+ * e.g. to TIMER0->CC at the start of the next PWM period.
+ *
+ * The way of a set point has three steps,
+ * an input read by the main loop is stamped before by its interrupt
+ * with LAT_Input(), e.g. a pushbutton:
+ * @n LAT_Arm(): the user interface takes a new value of an input,
+ * with the time the input arrived, e.g. the end of the command line.
+ * @n LAT_Stage(): the value has been handed to a driver
+ * which writes it later, e.g. in the next TIMER0 interrupt.
+ * @n LAT_Commit(): the driver has written it, the sample is taken.
+ * @n A value armed again before it has been staged replaces the old one,
+ * only the way of the newest value is measured.
+ *
+ * The samples go into a histogram per input with LAT_SUB_BUCKETS buckets
+ * per power of 2 of the latency in ticks, so a percentile is known
+ * to the upper bound of its bucket (within 25 %), min, max and average
+ * are exact.
+ *
+ * LAT_Arm(), LAT_Stage() and LAT_Commit() have to be called with
+ * the interrupts off or from the interrupt handler of the driver.
+ * The times are given by the callers in ticks of LAT_TICK_HZ,
+ * so the module runs on the PC as well (tools/lampsim.c).
+ * @n Without LAT_TRACE (see latency.h) nothing of it is compiled,
+ * the calls are removed.
+ *
+ * Prefix: LAT
+ *
+ * Board:  Starter Kit EFM32-G8XX-STK
+ * Device: EFM32G890F128 (Gecko)
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#include "latency.h"
+
+#ifdef LAT_TRACE
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define LAT_SUB_BITS		2				///< log2(LAT_SUB_BUCKETS)
+
+/** Convert ticks to us */
+#define LAT_TICKS_TO_US(t)	((int32_t)(((uint64_t)(t) * 1000000) / LAT_TICK_HZ))
+
+/** Samples of an input */
+typedef struct {
+	uint32_t count;
+	uint32_t sum;							///< ticks
+	uint32_t min;							///< ticks
+	uint32_t max;							///< ticks
+	uint16_t bucket[LAT_BUCKET_COUNT];		///< samples, saturated
+} LAT_histogram_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+static LAT_histogram_t LAT_histogram[LAT_SOURCE_COUNT];
+static uint32_t LAT_start[LAT_SOURCE_COUNT];	///< time of the input
+static volatile uint32_t LAT_input[LAT_SOURCE_COUNT];	///< time of the last interrupt
+static volatile uint32_t LAT_armed = 0;		///< bit per input, taken by the UI
+static volatile uint32_t LAT_staged = 0;	///< bit per input, handed to a driver
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Get the bucket of a latency
+ * @param [in] ticks latency
+ * @return bucket, the last one takes all the longer latencies
+ *****************************************************************************/
+static uint32_t LAT_Bucket(uint32_t ticks) {
+	if (ticks < LAT_SUB_BUCKETS) {
+		return ticks;						// exact
+	}
+	uint32_t power = 31 - __builtin_clz(ticks);	// >= LAT_SUB_BITS
+	uint32_t sub = (ticks >> (power - LAT_SUB_BITS)) & (LAT_SUB_BUCKETS - 1);
+	uint32_t bucket = (power - LAT_SUB_BITS + 1) * LAT_SUB_BUCKETS + sub;
+	return (bucket < LAT_BUCKET_COUNT) ? bucket : (LAT_BUCKET_COUNT - 1);
+}
+
+/** ***************************************************************************
+ * @brief Get the first latency of a bucket
+ * @param [in] bucket number
+ * @return ticks
+ *****************************************************************************/
+static uint32_t LAT_BucketStart(uint32_t bucket) {
+	if (bucket < LAT_SUB_BUCKETS) {
+		return bucket;
+	}
+	uint32_t power = bucket / LAT_SUB_BUCKETS - 1 + LAT_SUB_BITS;
+	uint32_t sub = bucket % LAT_SUB_BUCKETS;
+	return (LAT_SUB_BUCKETS + sub) << (power - LAT_SUB_BITS);
+}
+
+/** ***************************************************************************
+ * @brief Get a percentile of an input
+ * @param [in] histogram of the input, not empty
+ * @param [in] percent 1 ... 100
+ * @return latency in ticks, upper bound of its bucket within min and max
+ *****************************************************************************/
+static uint32_t LAT_Percentile(const LAT_histogram_t *histogram, uint32_t percent) {
+	uint32_t total = 0;
+	for (uint32_t bucket = 0; bucket < LAT_BUCKET_COUNT; bucket++) {
+		total += histogram->bucket[bucket];
+	}
+	uint32_t rank = (total * percent + 99) / 100;	// samples up to the percentile
+	uint32_t seen = 0;
+	uint32_t ticks = histogram->max;
+	for (uint32_t bucket = 0; bucket < LAT_BUCKET_COUNT - 1; bucket++) {
+		seen += histogram->bucket[bucket];
+		if (seen >= rank) {
+			ticks = LAT_BucketStart(bucket + 1) - 1;
+			break;
+		}
+	}
+	if (ticks > histogram->max) { ticks = histogram->max; }
+	if (ticks < histogram->min) { ticks = histogram->min; }
+	return ticks;
+}
+
+/** ***************************************************************************
+ * @brief An input event, called by the interrupt handler of the input
+ * @param [in] source LAT_source_t
+ * @param [in] now time in ticks
+ *****************************************************************************/
+void LAT_Input(uint32_t source, uint32_t now) {
+	if (source < LAT_SOURCE_COUNT) {
+		LAT_input[source] = now;
+	}
+}
+
+/** ***************************************************************************
+ * @brief Get the time of the last event of an input
+ * @param [in] source LAT_source_t
+ * @return time in ticks, start for LAT_Arm() when the event is taken
+ *****************************************************************************/
+uint32_t LAT_InputTime(uint32_t source) {
+	return (source < LAT_SOURCE_COUNT) ? LAT_input[source] : 0;
+}
+
+/** ***************************************************************************
+ * @brief Take a new value of an input
+ * @param [in] source LAT_source_t
+ * @param [in] start time the input arrived, in ticks
+ *****************************************************************************/
+void LAT_Arm(uint32_t source, uint32_t start) {
+	if (source < LAT_SOURCE_COUNT) {
+		LAT_start[source] = start;
+		LAT_armed |= 1 << source;
+	}
+}
+
+/** ***************************************************************************
+ * @brief The values taken have been handed to a driver
+ *****************************************************************************/
+void LAT_Stage(void) {
+	LAT_staged |= LAT_armed;
+	LAT_armed = 0;
+}
+
+/** ***************************************************************************
+ * @brief Check whether values are waiting to be written by a driver
+ * @return true = LAT_Commit() is due when they are written
+ *****************************************************************************/
+bool LAT_Staged(void) {
+	return 0 != LAT_staged;
+}
+
+/** ***************************************************************************
+ * @brief The driver has written the values handed to it, take the samples
+ * @param [in] now time in ticks
+ *****************************************************************************/
+void LAT_Commit(uint32_t now) {
+	uint32_t staged = LAT_staged;
+	LAT_staged = 0;
+	for (uint32_t source = 0; staged; source++, staged >>= 1) {
+		if (!(staged & 1)) {
+			continue;
+		}
+		LAT_histogram_t *histogram = &LAT_histogram[source];
+		uint32_t ticks = now - LAT_start[source];
+		if (!histogram->count || (ticks < histogram->min)) {
+			histogram->min = ticks;
+		}
+		if (ticks > histogram->max) {
+			histogram->max = ticks;
+		}
+		histogram->count++;
+		histogram->sum += ticks;
+		uint16_t *bucket = &histogram->bucket[LAT_Bucket(ticks)];
+		if (*bucket < UINT16_MAX) {
+			(*bucket)++;
+		}
+	}
+}
+
+/** ***************************************************************************
+ * @brief Clear the samples of an input, e.g. before a measurement
+ * @param [in] source LAT_source_t
+ *****************************************************************************/
+void LAT_Reset(uint32_t source) {
+	if (source < LAT_SOURCE_COUNT) {
+		LAT_histogram[source] = (LAT_histogram_t){ 0 };
+	}
+}
+
+/** ***************************************************************************
+ * @brief Get information on the latencies of an input
+ * @param [in] source LAT_source_t
+ * @param [in] info LAT_info_t
+ * @return count or latency in us, 0 without samples
+ *****************************************************************************/
+int32_t LAT_GetInfo(uint32_t source, uint32_t info) {
+	if ((source >= LAT_SOURCE_COUNT) || (info >= LAT_INFO_COUNT)) {
+		return 0;
+	}
+	const LAT_histogram_t *histogram = &LAT_histogram[source];
+	if (!histogram->count) {
+		return 0;
+	}
+	switch (info) {
+	case LAT_COUNT:
+		return histogram->count;
+	case LAT_MIN_US:
+		return LAT_TICKS_TO_US(histogram->min);
+	case LAT_AVG_US:
+		return LAT_TICKS_TO_US(histogram->sum / histogram->count);
+	case LAT_P50_US:
+		return LAT_TICKS_TO_US(LAT_Percentile(histogram, 50));
+	case LAT_P90_US:
+		return LAT_TICKS_TO_US(LAT_Percentile(histogram, 90));
+	case LAT_P99_US:
+		return LAT_TICKS_TO_US(LAT_Percentile(histogram, 99));
+	default:
+		return LAT_TICKS_TO_US(histogram->max);
+	}
+}
+
+#endif
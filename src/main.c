@@ -72,7 +72,8 @@
  * @brief main file for the Moodlight
  *
  * Sets up uC, clocks, peripherals and user interface.
- * Starts the powerLEDs, etc.
+ * Starts the powerLEDs first with the last colour, before the crystals are
+ * ready (fast boot), etc.
  *
  * Loops in the user interface
  *
@@ -88,6 +89,7 @@
 #include "em_emu.h"
 
 #include "segmentlcd.h"
+#include "sl_sleeptimer.h"
 
 #include "globals.h"
 #include "communication.h"
@@ -96,6 +98,9 @@
 #include "touchslider.h"
 #include "userinterface.h"
 #include "signalleds.h"
+#include "nvstore.h"
+#include "energymode.h"
+#include "cct.h"
 
 
 /******************************************************************************
@@ -124,7 +129,14 @@
  *****************************************************************************/
 int main(void) {
   CHIP_Init();                  		// Chip revision alignment and errata fixes
-  INIT_XOclocks();						// Start crystal oscillators
+  G_CycleCounterInit();					// Boot trace starts here
+  INIT_XOclocks();						// Start oscillators, don't wait for crystals
+  sl_sleeptimer_init();					// Start RTC based wallclock and timers
+  EMM_Init();							// Start UI tick and energy mode counters
+  NV_Init();							// Restore persistent settings
+
+  PWR_init();							// Light on with the last colour
+  CCT_Init();							// Restore the colour temperature
 
   COM_Init();							// Initialize serial communication
 
@@ -139,12 +151,13 @@ int main(void) {
   SegmentLCD_Write("PowerUp");
   SegmentLCD_Number(0);
 
-  PWR_init();							// Initialize the power LEDs
-
   while(1) {							// loop forever
 	  SL_Toggle(SL_3_PORT, SL_3_PIN);	// can be used for oscilloscope synch.
 	  UI_FSM_event();					// check for events
 	  UI_FSM_state_value();				// handles the events
 	  lightOnOrOff();
+	  NV_Process();						// store changed settings (rate-limited)
+	  COM_Process();					// send waiting notifications (rate-limited)
+	  G_BootTraceReport();				// send boot time once
   }
 }
@@ -0,0 +1,332 @@
+/** ***************************************************************************
+ * @file
+ * @brief Persistent settings in the internal flash
+ *
+ * A small log-structured key/value store in the last NV_PAGE_COUNT pages
+ * of the internal flash, written with the memory system controller (MSC).
+ *
+ * All values live in a RAM shadow. NV_Write() only changes the shadow
+ * and marks the key as dirty. NV_Process() is called from the main loop
+ * and appends the dirty keys to the flash log, but only after the values
+ * have been stable for NV_COMMIT_DELAY_MS and at most once
+ * every NV_COMMIT_INTERVAL_MS. So moving the slider never stalls
+ * the main loop with flash writes or erases.
+ *
+ * <b>Flash layout</b>
+ * @n Every page starts with a header: sequence number and commit word.
+ * The page with the highest committed sequence number is the active page.
+ * @n After the header follow records of 2 words: value and commit word
+ * (key and checksum). The commit word is always written last,
+ * so a record or page is either complete or ignored.
+ * @n When the active page is full, all valid values are copied to the next
+ * page (wear levelling round robin over all pages) and the header of the
+ * new page is written as the very last step.
+ * @n At boot, NV_Init() reads the page headers and scans the active page once.
+ *
+ * @note The flash pages at the end of the flash are not used by the code,
+ * the linker script (moodlight_2.ld) leaves them out of the FLASH region.
+ *
+ * <b>Emulation</b>
+ * @n Compiled with NV_FLASH_EMULATION the flash is emulated in RAM
+ * (with the same "only clear bits" semantics).
+ * NV_emulation_budget counts down the flash operations.
+ * When it reaches 0, the operation is torn (half done) and all subsequent
+ * operations fail, as after a power loss at this very step.
+ * tools/nvsim.c cuts the power at every step of a workload this way.
+ *
+ * Prefix: NV
+ *
+ * Board:  Starter Kit EFM32-G8XX-STK
+ * Device: EFM32G890F128 (Gecko)
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#include <string.h>
+
+#ifndef NV_FLASH_EMULATION
+#include "em_device.h"
+#include "em_msc.h"
+#include "sl_sleeptimer.h"
+#endif
+
+#include "nvstore.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define NV_PAGE_SIZE		512				///< flash page size in bytes
+#define NV_PAGE_WORDS		(NV_PAGE_SIZE / 4)	///< flash page size in words
+#define NV_ERASED			0xFFFFFFFFu		///< content of erased flash
+#define NV_PAGE_MAGIC		0x4D4F4F44u		///< "MOOD", marks a committed page
+#define NV_RECORD_MAGIC		0xA5000000u		///< marks a committed record
+#define NV_HEADER_WORDS		2				///< page header: sequence, commit
+#define NV_RECORD_WORDS		2				///< record: value, commit
+#define NV_SLOT_COUNT		((NV_PAGE_WORDS - NV_HEADER_WORDS) / NV_RECORD_WORDS)
+
+#ifdef NV_FLASH_EMULATION
+#define NV_FLASH_BASE		NV_emulation_flash
+#define NV_NOW_MS()			NV_emulation_ms
+#else
+/** the last pages of the internal flash */
+#define NV_FLASH_BASE		((uint32_t *)(FLASH_BASE + FLASH_SIZE - NV_PAGE_COUNT * NV_PAGE_SIZE))
+#define NV_NOW_MS()			sl_sleeptimer_tick_to_ms(sl_sleeptimer_get_tick_count())
+#endif
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+static uint32_t NV_value[NV_KEY_COUNT];		///< RAM shadow of all values
+static uint32_t NV_valid = 0;				///< bit set = key has a value
+static uint32_t NV_dirty = 0;				///< bit set = key not yet in flash
+static uint32_t NV_page = 0;				///< index of the active page
+static uint32_t NV_sequence = 0;			///< sequence of the active page, 0 = none
+static uint32_t NV_slot = NV_SLOT_COUNT;	///< next free record slot
+static uint32_t NV_changed_ms = 0;			///< time of the last NV_Write()
+static uint32_t NV_commit_ms = 0;			///< time of the last commit
+
+#ifdef NV_FLASH_EMULATION
+uint32_t NV_emulation_flash[NV_PAGE_COUNT * NV_PAGE_WORDS];
+int32_t NV_emulation_budget = -1;			///< -1 = no power loss
+uint32_t NV_emulation_ms = 0;
+#endif
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+#ifdef NV_FLASH_EMULATION
+/** ***************************************************************************
+ * @brief Emulation: consume one flash operation of the budget
+ * @return 1 = do it, 0 = power lost before, -1 = power lost during this one
+ *****************************************************************************/
+static int32_t NV_emulation_step(void) {
+	if (NV_emulation_budget < 0) { return 1; }
+	if (NV_emulation_budget == 0) { return 0; }
+	NV_emulation_budget--;
+	return (NV_emulation_budget > 0) ? 1 : -1;
+}
+
+static bool NV_flash_erase(uint32_t *page) {
+	int32_t step = NV_emulation_step();
+	if (step != 0) {						// torn erase leaves half the page
+		memset(page, 0xFF, (step > 0) ? NV_PAGE_SIZE : NV_PAGE_SIZE / 2);
+	}
+	return step > 0;
+}
+
+static bool NV_flash_write(uint32_t *address, uint32_t data) {
+	int32_t step = NV_emulation_step();
+	if (step != 0) {						// torn write programs half the bits
+		*address &= (step > 0) ? data : (data | 0x0000FFFFu);
+	}
+	return step > 0;
+}
+#else
+/** ***************************************************************************
+ * @brief Erase a flash page
+ * @param [in] page start address
+ * @return true = successful
+ *****************************************************************************/
+static bool NV_flash_erase(uint32_t *page) {
+	return mscReturnOk == MSC_ErasePage(page);
+}
+
+/** ***************************************************************************
+ * @brief Write a word to flash
+ * @param [in] address of the word
+ * @param [in] data to write
+ * @return true = successful
+ *****************************************************************************/
+static bool NV_flash_write(uint32_t *address, uint32_t data) {
+	return mscReturnOk == MSC_WriteWord(address, &data, sizeof(data));
+}
+#endif
+
+/** ***************************************************************************
+ * @brief Start address of a page of the log
+ *****************************************************************************/
+static uint32_t *NV_page_address(uint32_t page) {
+	return NV_FLASH_BASE + page * NV_PAGE_WORDS;
+}
+
+/** ***************************************************************************
+ * @brief Commit word of a record
+ * @param [in] key of the record
+ * @param [in] value of the record
+ * @return magic, 16 bit checksum and key
+ *****************************************************************************/
+static uint32_t NV_record_commit(uint32_t key, uint32_t value) {
+	uint32_t check = (value ^ (value >> 16) ^ (key * 0x9E37u)) & 0xFFFFu;
+	return NV_RECORD_MAGIC | (check << 8) | key;
+}
+
+/** ***************************************************************************
+ * @brief Write one record, the commit word as the last step
+ * @param [in] record address in flash
+ * @param [in] key of the record
+ * @return true = successful
+ *****************************************************************************/
+static bool NV_write_record(uint32_t *record, uint32_t key) {
+	return NV_flash_write(&record[0], NV_value[key])
+			&& NV_flash_write(&record[1], NV_record_commit(key, NV_value[key]));
+}
+
+/** ***************************************************************************
+ * @brief Append one record to the active page
+ * @param [in] key of the record
+ * @return true = successful
+ *****************************************************************************/
+static bool NV_append(uint32_t key) {
+	uint32_t *record = NV_page_address(NV_page) + NV_HEADER_WORDS
+			+ NV_slot * NV_RECORD_WORDS;
+	NV_slot++;								// slot is used even if torn
+	return NV_write_record(record, key);
+}
+
+/** ***************************************************************************
+ * @brief Copy all valid values to the next page and make it the active page
+ * @return true = successful
+ *
+ * The active page stays untouched, so it is still valid if this fails.
+ *****************************************************************************/
+static bool NV_compact(void) {
+	uint32_t page = (NV_sequence == 0) ? 0 : (NV_page + 1) % NV_PAGE_COUNT;
+	uint32_t *header = NV_page_address(page);
+	uint32_t *record = header + NV_HEADER_WORDS;
+	if (!NV_flash_erase(header)) {
+		return false;
+	}
+	for (uint32_t key = 0; key < NV_KEY_COUNT; key++) {
+		if (NV_valid & (1u << key)) {
+			if (!NV_write_record(record, key)) {
+				return false;
+			}
+			record += NV_RECORD_WORDS;
+		}
+	}
+	/* commit the page as the very last step */
+	if (!NV_flash_write(&header[0], NV_sequence + 1)
+			|| !NV_flash_write(&header[1], NV_PAGE_MAGIC ^ (NV_sequence + 1))) {
+		return false;
+	}
+	NV_sequence++;
+	NV_page = page;
+	NV_slot = (record - header - NV_HEADER_WORDS) / NV_RECORD_WORDS;
+	NV_dirty = 0;							// everything is in flash now
+	return true;
+}
+
+/** ***************************************************************************
+ * @brief Restore all values from flash
+ *
+ * Finds the active page and scans its records once.
+ * @n Must be called once at boot before any other NV function.
+ *****************************************************************************/
+void NV_Init(void) {
+#ifndef NV_FLASH_EMULATION
+	MSC_Init();
+#endif
+	NV_valid = 0;
+	NV_dirty = 0;
+	NV_sequence = 0;
+	NV_slot = NV_SLOT_COUNT;				// no active page: compact first
+	/* the committed page with the highest sequence number is active */
+	for (uint32_t page = 0; page < NV_PAGE_COUNT; page++) {
+		uint32_t *header = NV_page_address(page);
+		if ((header[0] != NV_ERASED) && (header[1] == (NV_PAGE_MAGIC ^ header[0]))
+				&& (header[0] > NV_sequence)) {
+			NV_sequence = header[0];
+			NV_page = page;
+		}
+	}
+	if (0 == NV_sequence) {
+		return;
+	}
+	/* the last committed record of a key wins */
+	uint32_t *record = NV_page_address(NV_page) + NV_HEADER_WORDS;
+	NV_slot = 0;
+	for (uint32_t slot = 0; slot < NV_SLOT_COUNT; slot++) {
+		uint32_t value = record[0];
+		uint32_t commit = record[1];
+		uint32_t key = commit & 0xFFu;
+		if ((value != NV_ERASED) || (commit != NV_ERASED)) {
+			NV_slot = slot + 1;				// also skip torn records
+		}
+		if ((key < NV_KEY_COUNT) && (commit == NV_record_commit(key, value))) {
+			NV_value[key] = value;
+			NV_valid |= 1u << key;
+		}
+		record += NV_RECORD_WORDS;
+	}
+}
+
+/** ***************************************************************************
+ * @brief Read a value
+ * @param [in] key of the value
+ * @param [out] value (unchanged if the key has no value)
+ * @return true = the key has a value
+ *****************************************************************************/
+bool NV_Read(uint32_t key, uint32_t *value) {
+	if ((key < NV_KEY_COUNT) && (NV_valid & (1u << key))) {
+		*value = NV_value[key];
+		return true;
+	}
+	return false;
+}
+
+/** ***************************************************************************
+ * @brief Write a value
+ * @param [in] key of the value
+ * @param [in] value
+ *
+ * Only the RAM shadow is changed, NV_Process() writes it to flash later.
+ *****************************************************************************/
+void NV_Write(uint32_t key, uint32_t value) {
+	if (key >= NV_KEY_COUNT) {
+		return;
+	}
+	if ((NV_valid & (1u << key)) && (NV_value[key] == value)) {
+		return;								// nothing changed, no flash wear
+	}
+	NV_value[key] = value;
+	NV_valid |= 1u << key;
+	NV_dirty |= 1u << key;
+	NV_changed_ms = NV_NOW_MS();
+}
+
+/** ***************************************************************************
+ * @brief Write all dirty values to flash immediately
+ *****************************************************************************/
+void NV_Flush(void) {
+	for (uint32_t key = 0; (key < NV_KEY_COUNT) && NV_dirty; key++) {
+		if (NV_dirty & (1u << key)) {
+			if (NV_slot >= NV_SLOT_COUNT) {
+				if (!NV_compact()) {		// commits all dirty values
+					return;
+				}
+			} else if (NV_append(key)) {
+				NV_dirty &= ~(1u << key);
+			}
+		}
+	}
+	NV_commit_ms = NV_NOW_MS();
+}
+
+/** ***************************************************************************
+ * @brief Batched and rate-limited commit of dirty values
+ *
+ * Call this regularly from the main loop.
+ *****************************************************************************/
+void NV_Process(void) {
+	uint32_t now = NV_NOW_MS();
+	if (NV_dirty
+			&& (now - NV_changed_ms >= NV_COMMIT_DELAY_MS)
+			&& (now - NV_commit_ms >= NV_COMMIT_INTERVAL_MS)) {
+		NV_Flush();
+	}
+}
@@ -20,6 +20,14 @@
  * shunt-resistor voltage is higher than the set DAC voltage an interrupt is set.
  * This interrupt sets the gate of the MOSFET to LOW. Additionally, there is a Timer
  * which sets the MOSFET gate with 16kHz frequency to HIGH.
+ * @n With PWR_HW_CUTOFF this is done without CPU: the ACMP0 output is routed
+ * over PRS to the fault input of the TIMER0 dead time insertion (DTI),
+ * which ends the PWM pulses in hardware. The fault is rearmed in the
+ * TIMER0 overflow interrupt which runs anyway.
+ *
+ * While a colour stream is running (see stream.c) the frames are shown
+ * by the TIMER0 overflow interrupt at the start of a PWM period.
+ * The set points are only stored meanwhile and restored after the stream.
  *
  *
  * Board:  Starter Kit EFM32-G8XX-STK
@@ -35,9 +43,21 @@
 #include "em_acmp.h"
 #include "em_timer.h"
 #include "em_letimer.h"
+#include "em_core.h"
+#include "em_prs.h"
 
 
 #include "powerLEDs.h"
+#include "cutoff.h"
+#include "globals.h"
+#include "pins.h"
+#include "nvstore.h"
+#include "bcm.h"
+#include "regulation.h"
+#include "stream.h"
+#include "latency.h"
+
+#include "sl_sleeptimer.h"
 
 #include "signalLEDs.h"		// used only to measure time of TIMER0_IRQHandler
 
@@ -49,11 +69,14 @@
 #define LAMP_ON     true
 
 /** Actual set points for values */
-int32_t PWR_value[PWR_SOLUTION_COUNT] = { 0, 0, 0, 0, 0 };
+int32_t PWR_value[PWR_SOLUTION_COUNT] = { 0 };
 
 volatile uint32_t clapTimeOn = 0;
 volatile uint32_t clapCounter = 0;
 volatile static bool lampState = LAMP_ON;
+#ifdef LAT_TRACE
+static bool PWR_lamp_written = LAMP_ON;	///< lampState at the last lightOnOrOff()
+#endif
 
 bool getLampState(){
   return lampState;
@@ -61,6 +84,10 @@ bool getLampState(){
 
 #define PWR_current_max			350			///< Max current in mA
 
+#define PWR_PWM_FREQUENCY		500			///< default PWM frequency in Hz
+#define PWR_PWM_FREQUENCY_MAX	20000		///< max selectable PWM frequency in Hz
+#define PWR_CLAP_FREQUENCY		500			///< sample rate of the clap sensor in Hz
+
 /******************************************************************************
  * Solution specific defines and variables
  *****************************************************************************/
@@ -85,39 +112,138 @@ bool getLampState(){
  * @n Range of int32_t = -2'147'483'648 ... 2'147'483'647 */
 #define PWR_conversion_shift		12
 
+/** TIMER0 PWM period and scale factor from set point to compare value,
+ * depend on the HF clock (HFRCO at boot, HFXO later) */
+static uint32_t PWR_timer_top = 64000;
+static uint32_t PWR_timer_scale = 1028015;
 
-/******************************************************************************
- * Functions
- *****************************************************************************/
+/** Selected PWM frequency of TIMER0, a multiple of PWR_CLAP_FREQUENCY */
+static uint32_t PWR_pwm_frequency = PWR_PWM_FREQUENCY;
+static volatile bool PWR_pwm_frequency_changed = false;	///< retune at next period
+static volatile bool PWR_timer_retuned = false;	///< recalculate RGB in the main loop
+static uint32_t PWR_clap_divider = 1;		///< PWM periods per clap sample
+static uint32_t PWR_clap_count = 0;			///< counts PWM periods
 
-/** ***************************************************************************
- * @brief Set a GPIO pin
- * @param [in] port of GPIO
- * @param [in] pin of GPIO
- *****************************************************************************/
-void GPIO_setPin(uint32_t port, uint32_t pin) {
-  GPIO->P[port].DOUTSET = 1 << pin;
-}
+/** LETIMER0 PWM period for white (32768 Hz -> 500 Hz)
+ * and scale factor from set point to compare value (66 << 12 / 255) */
+#define PWR_WHITE_TOP			66
+#define PWR_WHITE_SCALE			1060
+/** Dither only below this compare value,
+ * higher values written after an underflow might be synchronized too late */
+#define PWR_WHITE_DITHER_MAX	(PWR_WHITE_TOP - 4)
 
-/** ***************************************************************************
- * @brief clear a GPIO pin
- * @param [in] port of GPIO
- * @param [in] pin of GPIO
- *****************************************************************************/
-void GPIO_clearPin(uint32_t port, uint32_t pin) {
-  GPIO->P[port].DOUTCLR = 1 << pin;
-}
+/** Compare value of white in 1/4096 and error accumulator of the dither */
+static volatile uint32_t PWR_white_q12 = 0;
+static uint32_t PWR_white_error = 0;
 
-/** ***************************************************************************
- * @brief read a GPIO pin
- * @param [in] port of GPIO
- * @param [in] pin of GPIO
- *****************************************************************************/
-uint32_t GPIO_readPin(uint32_t port, uint32_t pin) {
-  return (GPIO->P[port].DIN & (1 << pin)) >> pin;
-}
+/** Deep dimming of RGB: the DAC0 current reference is lowered for dark colours
+ * and the PWM duty cycle widened accordingly.
+ * Comment out for LED drivers with a fixed current reference. */
+#define PWR_DEEP_DIMMING
+
+/** Closed loop regulation of the average RGB currents (see regulation.c).
+ * Comment out for LED driver boards without shunt measurement.
+ * Off: the shunts are not wired yet, the ADC inputs would measure
+ * other signals and run the trims to their limits. */
+//#define PWR_CURRENT_REGULATION
 
+/** Cycle by cycle cut-off of the RGB pulses by ACMP0 -> PRS -> TIMER0 DTI fault.
+ * Define for LED driver boards with comparator wiring.
+ * Off: the ACMP0 inputs below are not wired yet, a floating comparator
+ * would fault the DTI and keep RGB dark. */
+//#define PWR_HW_CUTOFF
 
+/** ACMP0 inputs: shunt voltage (PC4) and DAC0 CH1 reference wired to PC5
+ * @todo Adjust to the wiring of the LED driver board */
+#define PWR_CUTOFF_POS			acmpChannel4
+#define PWR_CUTOFF_NEG			acmpChannel5
+
+/** @todo Adjust DAC code for PWR_current_max to the shunt resistor */
+#define PWR_DAC_FULL_SCALE		4095		///< DAC0 CH1 code for max current
+#define PWR_DAC_CLOCK			1000000		///< DAC clock must be < 1MHz
+
+/** One step of the dimming table */
+typedef struct {
+	uint8_t value_max;						///< brightest set point for this step
+	uint8_t shift;							///< current / 2^shift, duty * 2^shift
+	uint16_t dac;							///< DAC0 code of the current reference
+} PWR_dim_step_t;
+
+/** Dimming table: current reference and PWM gain by the brightest RGB set point.
+ * Current and duty are scaled by the same power of 2,
+ * so the average current stays exactly proportional to the set point. */
+static const PWR_dim_step_t PWR_dim_table[] = {
+	{ PWR_VALUE_MAX,		0, PWR_DAC_FULL_SCALE },
+	{ PWR_VALUE_MAX >> 1,	1, PWR_DAC_FULL_SCALE >> 1 },
+	{ PWR_VALUE_MAX >> 2,	2, PWR_DAC_FULL_SCALE >> 2 },
+	{ PWR_VALUE_MAX >> 3,	3, PWR_DAC_FULL_SCALE >> 3 },
+	{ PWR_VALUE_MAX >> 4,	4, PWR_DAC_FULL_SCALE >> 4 },
+};
+#define PWR_DIM_STEP_COUNT	(sizeof(PWR_dim_table) / sizeof(PWR_dim_table[0]))
+
+/** RGB pulse widths, alignment and current reference, applied together */
+typedef struct {
+	uint32_t duty[3];						///< pulse width of TIMER0 CC0 ... CC2
+	uint32_t right;							///< bit i set: CCi pulse at end of period
+	uint32_t dac;							///< DAC0 CH1
+} PWR_rgb_update_t;
+static PWR_rgb_update_t PWR_rgb_update;		///< staged for the next period
+static volatile bool PWR_rgb_pending = false;	///< PWR_rgb_update is new
+
+/** Diagnostics of the hardware cut-off */
+static volatile uint32_t PWR_cutoff_periods = 0;	///< periods with a cut-off
+static volatile uint32_t PWR_acmp_edges = 0;	///< periods with an ACMP0 edge
+
+/** TIMER0 is stopped while no RGB output is needed (see PWR_sleep_prepare) */
+static volatile bool PWR_timer_stopped = false;
+
+/** CC outputs of TIMER0 (Red, Green, Blue) */
+#define PWR_TIM0_ROUTE_PEN	(TIMER_ROUTE_CC0PEN | TIMER_ROUTE_CC1PEN | TIMER_ROUTE_CC2PEN)
+#define PWR_TIM0_CC_COUNT	3				///< CC channels of TIMER0
+
+/** Set points of the TIMER0 channels (0 while the lamp is off) */
+static uint32_t PWR_rgb_value[PWR_TIM0_CC_COUNT] = { 0, 0, 0 };
+static bool PWR_rgb_changed = false;		///< PWR_rgb_value has been written
+
+/** Set points last written to the drivers, written again only if changed.
+ * By the main loop, by TIMER0_IRQHandler() only during a colour stream,
+ * while the main loop leaves the drivers alone (see lightOnOrOff()). */
+#define PWR_WRITTEN_NONE	(-1)			///< write in any case
+static int32_t PWR_written[PWR_SOLUTION_COUNT] = {
+	PWR_WRITTEN_NONE, PWR_WRITTEN_NONE, PWR_WRITTEN_NONE,
+	PWR_WRITTEN_NONE, PWR_WRITTEN_NONE
+};
+
+/** Output channel: which driver produces the light of a set point */
+typedef struct PWR_channel PWR_channel_t;
+struct PWR_channel {
+	void (*drive)(const PWR_channel_t *channel, uint32_t value);	///< driver
+	uint32_t index;							///< TIMER0 CC or BCM channel
+	GPIO_Port_TypeDef port;					///< output, low while the driver is off
+	uint32_t pin;
+	bool switched;							///< follows lampState (clap on/off)
+};
+
+static void PWR_drive_letimer(const PWR_channel_t *channel, uint32_t value);
+static void PWR_drive_bcm(const PWR_channel_t *channel, uint32_t value);
+static void PWR_drive_timer(const PWR_channel_t *channel, uint32_t value);
+
+/** Output channels, one per set point (solution number).
+ * A new channel only needs a new entry and PWR_SOLUTION_COUNT. */
+static const PWR_channel_t PWR_channel[PWR_SOLUTION_COUNT] = {
+	{ PWR_drive_letimer, 0, PWR_LE_TIM0_PORT, PWR_WHITE_TIM_PIN, true },
+	{ PWR_drive_bcm, BCM_AMBER, BCM_PORT, BCM_AMBER_PIN, true },
+	{ PWR_drive_timer, 0, PWR_TIM0_PORT, PWR_RED_TIM_PIN, true },
+	{ PWR_drive_timer, 1, PWR_TIM0_PORT, PWR_GREEN_TIM_PIN, true },
+	{ PWR_drive_timer, 2, PWR_TIM0_PORT, PWR_BLUE_TIM_PIN, true },
+};
+
+#define PWR_BENCHMARK_ROUNDS	100			///< rounds of PWR_benchmark()
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
 
 /** ***************************************************************************
  * @brief Initialize TIMER0 in PWM mode and activate overflow interrupt.
@@ -125,12 +251,14 @@ uint32_t GPIO_readPin(uint32_t port, uint32_t pin) {
  * @param [in] value_compare_CC0 = PWM active time of channel 0
  * duty_cycle = value_compare_CC0 / value_top
  * @n 3 compare/capture channels are available on this timer.
+ * @n The timer is not started, see PWR_init().
  *****************************************************************************/
 void TIMER0_PWM_init(uint32_t value_top, uint32_t value_compare) {
   CMU_ClockEnable(cmuClock_TIMER0, true); // enable timer clock
   /* load default values for general TIMER configuration (both solutions)*/
   TIMER_Init_TypeDef timerInit = TIMER_INIT_DEFAULT;
-  TIMER_Init(TIMER0, &timerInit);     // init and start the timer
+  timerInit.enable = false;           // started with the first colour
+  TIMER_Init(TIMER0, &timerInit);     // init the timer
   TIMER_TopSet(TIMER0, value_top);    // TOP defines PWM period
 
   // CC inititalization for all channels
@@ -179,6 +307,10 @@ void LETIMER0_PWM_init(uint32_t value_top, uint32_t value_compare) {
    * and use PWM mode for output 0 */
   LETIMER0->CTRL = LETIMER_CTRL_COMP0TOP | LETIMER_CTRL_UFOA0_PWM;
   LETIMER0->CMD = LETIMER_CMD_START;    // start the timer
+
+  /* underflow interrupt is enabled only when needed for dithering */
+  NVIC_ClearPendingIRQ(LETIMER0_IRQn);
+  NVIC_EnableIRQ(LETIMER0_IRQn);
 }
 
 
@@ -190,45 +322,531 @@ void LETIMER0_PWM_change(uint32_t value_compare) {
   LETIMER0->COMP1 = value_compare;    // Set PWM compare value
 }
 
+/** ***************************************************************************
+ * @brief Check if any of the RGB outputs is active
+ * @return true = TIMER0 has to generate a PWM signal
+ *****************************************************************************/
+static bool PWR_rgb_needed(void) {
+	return PWR_rgb_value[0] || PWR_rgb_value[1] || PWR_rgb_value[2];
+}
+
+
+/** ***************************************************************************
+ * @brief Start TIMER0 again, if it has been stopped
+ *
+ * The PWM starts with a new period at once,
+ * i.e. the output is resumed within one PWM period.
+ *****************************************************************************/
+static void PWR_timer_start(void) {
+	if (PWR_timer_stopped) {
+		GPIO_IntDisable(1 << CLAP_SENSE_PIN);
+		PWR_timer_stopped = false;
+		TIMER0->CNT = 0;
+		TIMER0->ROUTE |= PWR_TIM0_ROUTE_PEN;
+		TIMER0->CMD = TIMER_CMD_START;
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief One step of the first order sigma-delta modulator for white
+ * @param [in,out] error accumulator, fraction of a compare step in 1/4096
+ * @param [in] value_q12 compare value in 1/4096 compare steps
+ * @return compare value for the next PWM period
+ *
+ * The integer compare values average exactly to value_q12 / 4096,
+ * the remaining error is always less than one compare step.
+ *****************************************************************************/
+static inline uint32_t PWR_white_dither(uint32_t *error, uint32_t value_q12) {
+	uint32_t sum = *error + value_q12;
+	*error = sum & ((1 << PWR_conversion_shift) - 1);	// keep the fraction
+	return sum >> PWR_conversion_shift;
+}
+
+
+/** ***************************************************************************
+ * @brief Change white with temporal dithering of the LETIMER0 compare value
+ * @param [in] value_q12 compare value in 1/4096 compare steps
+ *
+ * A fractional compare value is dithered in the LETIMER0 underflow interrupt,
+ * an integer compare value doesn't need an interrupt at all.
+ * @n COMP1 has to be written within 4 LF ticks after the underflow
+ * (PWR_WHITE_DITHER_MAX). In EM2 this holds because the core wakes up
+ * on the HFRCO without waiting for the crystal (see energymode.c),
+ * tools/dithersim.c shows the duty error over this latency.
+ *****************************************************************************/
+static void PWR_white_change(uint32_t value_q12) {
+	uint32_t value_compare = value_q12 >> PWR_conversion_shift;
+	if ((value_q12 & ((1 << PWR_conversion_shift) - 1))
+			&& (value_compare < PWR_WHITE_DITHER_MAX)) {
+		PWR_white_q12 = value_q12;
+		LETIMER0->IEN |= LETIMER_IEN_UF;
+	} else {
+		LETIMER0->IEN &= ~LETIMER_IEN_UF;
+		PWR_white_q12 = value_compare << PWR_conversion_shift;
+		LETIMER0_PWM_change(value_compare);
+	}
+}
+
+
+#ifdef PWR_DEEP_DIMMING
+/** ***************************************************************************
+ * @brief Initialize DAC0 channel 1 as current reference of the RGB drivers
+ *****************************************************************************/
+static void PWR_dac_init(void) {
+	CMU_ClockEnable(cmuClock_DAC0, true);	// enable DAC clock
+	/* load default values for general DAC configuration */
+	DAC_Init_TypeDef DACinit = DAC_INIT_DEFAULT;
+	DACinit.prescale = DAC_PrescaleCalc(PWR_DAC_CLOCK, 0);
+	DACinit.reference = dacRef2V5;			// use internal 2.5V reference
+	DAC_Init(DAC0, &DACinit);				// write configuration registers
+	/* load default values for DAC channel configuration */
+	DAC_InitChannel_TypeDef DACinitChannel = DAC_INITCHANNEL_DEFAULT;
+	DAC_InitChannel(DAC0, &DACinitChannel, 1);	// write channel 1 configuration
+	DAC_Enable(DAC0, 1, true);				// enable channel 1
+	DAC0->CH1DATA = PWR_DAC_FULL_SCALE;		// output value for channel 1
+}
+#endif
+
+
+#ifdef PWR_HW_CUTOFF
+/** ***************************************************************************
+ * @brief Route ACMP0 over PRS to the DTI fault input of TIMER0
+ * @note TIMER0 must be initialized before.
+ *****************************************************************************/
+static void PWR_cutoff_init(void) {
+	PWR_cutoff_regs_t regs;
+	PWR_cutoff_model(&regs);
+
+	CMU_ClockEnable(cmuClock_ACMP0, true);
+	ACMP_Init_TypeDef acmpInit = ACMP_INIT_DEFAULT;
+	acmpInit.hysteresisLevel = acmpHysteresisLevel1;
+	acmpInit.enable = true;
+	ACMP_Init(ACMP0, &acmpInit);
+	ACMP_ChannelSet(ACMP0, PWR_CUTOFF_NEG, PWR_CUTOFF_POS);
+	while (!(ACMP0->STATUS & ACMP_STATUS_ACMPACT)) {
+		;									// wait for warm up
+	}
+
+	CMU_ClockEnable(cmuClock_PRS, true);
+	PRS->CH[regs.prs_channel].CTRL = regs.prs_ctrl;
+
+	TIMER0->DTFC = regs.dtfc;
+	TIMER0->DTOGEN = regs.dtogen;
+	TIMER0->DTFAULTC = TIMER_DTFAULTC_DTPRS0FC;
+	TIMER0->DTCTRL = regs.dtctrl;
+}
+#endif
+
+
+/** ***************************************************************************
+ * @brief Compare the live registers with the model of the hardware cut-off
+ * @return true = PRS, ACMP0 and TIMER0 DTI are configured as modelled
+ *****************************************************************************/
+bool PWR_cutoff_verify(void) {
+	PWR_cutoff_regs_t regs;
+	PWR_cutoff_model(&regs);
+	return (PRS->CH[regs.prs_channel].CTRL == regs.prs_ctrl)
+			&& (TIMER0->DTFC == regs.dtfc)
+			&& (TIMER0->DTOGEN == regs.dtogen)
+			&& ((TIMER0->DTCTRL & regs.dtctrl) == regs.dtctrl)
+			&& (ACMP0->CTRL & ACMP_CTRL_EN);
+}
+
+
+/** ***************************************************************************
+ * @brief Get the diagnostic counters of the hardware cut-off
+ * @param [in] index 0 = PWM periods with an ACMP0 edge,
+ * 1 = PWM periods with a cut-off, 2 = configuration matches the model (1/0)
+ * @return value of the counter
+ *
+ * The ACMP0 interrupt stays disabled, its edge flag is polled once per
+ * PWM period: both counts grow together while no CPU is involved
+ * in ending the pulses. Edges without cut-offs mean a broken routing.
+ *****************************************************************************/
+uint32_t PWR_cutoff_diagnostics(uint32_t index) {
+	switch (index) {
+	case 0:
+		return PWR_acmp_edges;
+	case 1:
+		return PWR_cutoff_periods;
+	case 2:
+		return PWR_cutoff_verify();
+	default:
+		return 0;
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Write staged RGB compare values and current reference
+ * @note Called at the start of a PWM period or while TIMER0 is stopped.
+ *****************************************************************************/
+static inline void PWR_rgb_apply(void) {
+	for (uint32_t i = 0; i < 3; i++) {
+		uint32_t duty = PWR_rgb_update.duty[i];
+#ifdef PWR_CURRENT_REGULATION
+		duty = (duty * REG_GetTrim(i)) >> 12;	// trim with controller output
+#endif
+		if (duty > PWR_timer_top) { duty = PWR_timer_top; }
+		if (PWR_rgb_update.right & (1 << i)) {	// inverted: pulse at the end
+			TIMER0->CC[i].CTRL |= TIMER_CC_CTRL_OUTINV;
+			TIMER0->CC[i].CCV = PWR_timer_top - duty;
+		} else {								// pulse at the beginning
+			TIMER0->CC[i].CTRL &= ~TIMER_CC_CTRL_OUTINV;
+			TIMER0->CC[i].CCV = duty;
+		}
+	}
+#ifdef PWR_DEEP_DIMMING
+	DAC0->CH1DATA = PWR_rgb_update.dac;
+#endif
+	if (LAT_Staged()) {						// the new values are out
+		LAT_Commit(sl_sleeptimer_get_tick_count());
+	}
+}
+
+
+/** ***************************************************************************
+ * @brief Max number of RGB pulses on at the same time
+ * @param [in] duty pulse widths of the three channels
+ * @param [in] top PWM period
+ * @param [in] right bit i set: pulse of channel i at the end of the period
+ *
+ * The number of pulses on only rises at the beginning of the period
+ * and at the start of each pulse at the end of the period.
+ *****************************************************************************/
+static uint32_t PWR_stagger_peak(const uint32_t duty[3], uint32_t top, uint32_t right) {
+	uint32_t peak = 0;
+	for (uint32_t k = 0; k <= 3; k++) {
+		uint32_t t = 0;						// k = 3: beginning of the period
+		if (k < 3) {
+			if (!(right & (1 << k))) { continue; }
+			t = top - duty[k];				// start of a pulse at the end
+		}
+		uint32_t on = 0;
+		for (uint32_t i = 0; i < 3; i++) {
+			if (right & (1 << i)) {
+				on += (duty[i] > 0) && (t >= top - duty[i]);
+			} else {
+				on += (t < duty[i]);
+			}
+		}
+		if (on > peak) { peak = on; }
+	}
+	return peak;
+}
+
+
+/** ***************************************************************************
+ * @brief Choose the alignment of the RGB pulses with the lowest peak current
+ * @param [in] duty pulse widths of the three channels
+ * @param [in] top PWM period
+ * @return bit i set: pulse of channel i at the end of the period
+ *
+ * Each channel starts its pulse either at the beginning of the period
+ * or ends it at the end of the period (inverted output).
+ * @n All the combinations are rated by the max number of pulses on
+ * (the RGB drivers share the current reference) and then by the total
+ * overlap time, i.e. the RMS supply current. Channels which are off
+ * stay at the beginning. On a tie the layout with fewer inversions wins.
+ *****************************************************************************/
+static uint32_t PWR_stagger(const uint32_t duty[3], uint32_t top) {
+	uint32_t best = 0;
+	uint32_t best_peak = UINT32_MAX;
+	uint32_t best_overlap = UINT32_MAX;
+	for (uint32_t right = 0; right < 8; right++) {
+		bool valid = true;
+		for (uint32_t i = 0; i < 3; i++) {
+			if ((right & (1 << i)) && (0 == duty[i])) { valid = false; }
+		}
+		if (!valid) { continue; }
+		uint32_t peak = PWR_stagger_peak(duty, top, right);
+		uint32_t overlap = 0;
+		for (uint32_t i = 0; i < 3; i++) {
+			for (uint32_t j = i + 1; j < 3; j++) {
+				if (((right >> i) & 1) == ((right >> j) & 1)) {	// same side
+					overlap += (duty[i] < duty[j]) ? duty[i] : duty[j];
+				} else if (duty[i] + duty[j] > top) {		// opposite sides
+					overlap += duty[i] + duty[j] - top;
+				}
+			}
+		}
+		if ((peak < best_peak) || ((peak == best_peak) && (overlap < best_overlap))) {
+			best = right;
+			best_peak = peak;
+			best_overlap = overlap;
+		}
+	}
+	return best;
+}
+
+
+/** ***************************************************************************
+ * @brief Calculate RGB compare values and current reference from the set points
+ * @param [out] update compare values, alignment and current reference
+ * @param [in] scale PWR_timer_scale the values are calculated for
+ * @param [in] top PWR_timer_top the values are calculated for
+ *
+ * With PWR_DEEP_DIMMING the deepest step of PWR_dim_table is chosen,
+ * which still fits the brightest of the three channels.
+ * @n The pulses are staggered to reduce the peak supply current (PWR_stagger).
+ *****************************************************************************/
+static void PWR_rgb_calculate(PWR_rgb_update_t *update, uint32_t scale, uint32_t top) {
+	const uint32_t *value = PWR_rgb_value;
+	uint32_t shift = 0;
+	update->dac = PWR_DAC_FULL_SCALE;
+#ifdef PWR_DEEP_DIMMING
+	uint32_t value_max = value[0];
+	if (value[1] > value_max) { value_max = value[1]; }
+	if (value[2] > value_max) { value_max = value[2]; }
+	for (uint32_t step = 0; step < PWR_DIM_STEP_COUNT; step++) {
+		if (value_max <= PWR_dim_table[step].value_max) {
+			shift = PWR_dim_table[step].shift;
+			update->dac = PWR_dim_table[step].dac;
+		}
+	}
+#endif
+	for (uint32_t i = 0; i < 3; i++) {
+		update->duty[i] = ((value[i] << shift) * scale) >> PWR_conversion_shift;
+	}
+	update->right = PWR_stagger(update->duty, top);
+}
+
+
+/** ***************************************************************************
+ * @brief Stage new RGB values for the next PWM period
+ *
+ * All the values are staged and written together
+ * in the TIMER0 interrupt at the start of the next PWM period,
+ * so the DAC and the timer never disagree during a period.
+ * @n TIMER0_IRQHandler() may retune TIMER0 while the values are calculated.
+ * The scale is checked again in the same critical section
+ * in which the values are staged, if it has changed they are calculated again.
+ * So values for the old period are never staged after the retune.
+ *****************************************************************************/
+static void PWR_rgb_change(void) {
+	PWR_rgb_update_t update;
+#ifdef PWR_CURRENT_REGULATION
+	for (uint32_t i = 0; i < 3; i++) {
+		REG_SetTarget(i, PWR_rgb_value[i] * REG_ADC_CURRENT_MAX / PWR_VALUE_MAX);
+	}
+#endif
+
+	CORE_DECLARE_IRQ_STATE;
+	for (;;) {
+		uint32_t scale = PWR_timer_scale;
+		PWR_rgb_calculate(&update, scale, PWR_timer_top);
+		CORE_ENTER_CRITICAL();
+		if (scale == PWR_timer_scale) {
+			break;							// still in the critical section
+		}
+		CORE_EXIT_CRITICAL();				// retuned meanwhile
+	}
+	PWR_rgb_update = update;
+	LAT_Stage();							// written with this update
+	if (PWR_timer_stopped) {
+		PWR_rgb_apply();					// no period running, write now
+		PWR_rgb_pending = false;
+	} else {
+		PWR_rgb_pending = true;
+	}
+	CORE_EXIT_CRITICAL();
+}
+
+
+/** ***************************************************************************
+ * @brief Driver of a channel: LETIMER0 with dither (white)
+ * @param [in] channel descriptor
+ * @param [in] value of set point
+ *****************************************************************************/
+static void PWR_drive_letimer(const PWR_channel_t *channel, uint32_t value) {
+	(void)channel;
+	PWR_white_change(value * PWR_WHITE_SCALE);
+}
+
+/** ***************************************************************************
+ * @brief Driver of a channel: binary code modulation (amber)
+ * @param [in] channel descriptor
+ * @param [in] value of set point
+ *****************************************************************************/
+static void PWR_drive_bcm(const PWR_channel_t *channel, uint32_t value) {
+	BCM_Set(channel->index, value);			// software PWM
+}
+
+/** ***************************************************************************
+ * @brief Driver of a channel: TIMER0 CC output (red, green, blue)
+ * @param [in] channel descriptor
+ * @param [in] value of set point
+ *
+ * Only stages the value, all TIMER0 channels are calculated together
+ * in PWR_rgb_flush().
+ *****************************************************************************/
+static void PWR_drive_timer(const PWR_channel_t *channel, uint32_t value) {
+	PWR_rgb_value[channel->index] = value;
+	PWR_rgb_changed = true;
+}
+
+/** ***************************************************************************
+ * @brief Calculate the TIMER0 channels if one of them has been written
+ *****************************************************************************/
+static void PWR_rgb_flush(void) {
+	if (PWR_rgb_changed) {
+		PWR_rgb_changed = false;
+		PWR_rgb_change();
+		if (PWR_rgb_needed()) {
+			PWR_timer_start();				// RGB needed again
+		}
+	}
+}
+
+/** ***************************************************************************
+ * @brief Write a set point to the driver of its channel
+ * @param [in] solution number, must be valid
+ *
+ * Switched channels are dark while the lamp is off.
+ * @n Nothing is written if the driver already has the value,
+ * so calling this every main loop pass costs a compare only.
+ *****************************************************************************/
+static inline void PWR_output(uint32_t solution) {
+	const PWR_channel_t *channel = &PWR_channel[solution];
+	int32_t value = (channel->switched && !lampState) ? 0 : PWR_value[solution];
+	if (value != PWR_written[solution]) {
+		PWR_written[solution] = value;
+		channel->drive(channel, value);
+	}
+}
+
+/** ***************************************************************************
+ * @brief Write a frame of the colour stream to the drivers
+ * @param [in] value set points of all channels
+ *
+ * The set points in PWR_value are not changed.
+ * @note Called from the TIMER0 interrupt at the start of a PWM period,
+ * the RGB values are applied in the same period.
+ *****************************************************************************/
+static void PWR_stream_frame(const uint8_t value[PWR_SOLUTION_COUNT]) {
+	for (uint32_t solution = 0; solution < PWR_SOLUTION_COUNT; solution++) {
+		const PWR_channel_t *channel = &PWR_channel[solution];
+		PWR_written[solution] = (channel->switched && !lampState) ? 0 : value[solution];
+		channel->drive(channel, PWR_written[solution]);
+	}
+	if (PWR_rgb_changed) {
+		PWR_rgb_changed = false;
+		PWR_rgb_change();					// sets PWR_rgb_pending
+	}
+}
+
+
+#ifdef LAT_TRACE
+/** ***************************************************************************
+ * @brief The set points taken (see latency.c) have been written to the drivers
+ *
+ * White and amber take a set point by themselves.
+ * If RGB has changed too, the samples are taken
+ * when the compares are written (see PWR_rgb_apply()).
+ *****************************************************************************/
+static void PWR_latency_written(void) {
+	CORE_DECLARE_IRQ_STATE;
+	CORE_ENTER_CRITICAL();
+	LAT_Stage();
+	if (!PWR_rgb_pending) {
+		LAT_Commit(sl_sleeptimer_get_tick_count());
+	}
+	CORE_EXIT_CRITICAL();
+}
+#endif
+
+
 /** ***************************************************************************
  * @brief Set the set point of the selected power LED driver.
  * @param [in] solution number
  * @param [in] value of set point
  *
  * The LED driver current is also adjusted accordingly.
+ * @n During a colour stream the set point is only stored.
+ * @n The latency of the set point (see latency.c) ends here for white
+ * and amber, their drivers take it by themselves,
+ * for the TIMER0 channels when the compares are written.
  *****************************************************************************/
 void PWR_set_value(uint32_t solution, int32_t value) {
 	if (solution < PWR_SOLUTION_COUNT) {	// solution number in valid range?
 		if (value < 0) { value = 0; }
 		if (value > PWR_VALUE_MAX) { value = PWR_VALUE_MAX; }
 		PWR_value[solution] = value;
-		switch (solution) {
-		case 0:
-      LETIMER0_PWM_change((value*1060)>>PWR_conversion_shift);
-			break;
-		case 1:
-			break;
-		case 2:
-		case 3:
-		case 4:
-      TIMER0_PWM_change((value*1028015)>>PWR_conversion_shift,solution-2);
-			break;
+		if (!STR_Active()) {
+			PWR_output(solution);
+			PWR_rgb_flush();
+#ifdef LAT_TRACE
+			if (PWR_drive_timer != PWR_channel[solution].drive) {
+				PWR_latency_written();
+			}
+#endif
 		}
 	}
 }
 
-void lightOnOrOff(){
-  if(lampState){
-      LETIMER0_PWM_change((PWR_value[0]*1060)>>PWR_conversion_shift);
-      TIMER0_PWM_change((PWR_value[2]*1028015)>>PWR_conversion_shift,0);
-      TIMER0_PWM_change((PWR_value[3]*1028015)>>PWR_conversion_shift,1);
-      TIMER0_PWM_change((PWR_value[4]*1028015)>>PWR_conversion_shift,2);
-  } else {
-      LETIMER0_PWM_change(0);
-      TIMER0_PWM_change(0,0);
-      TIMER0_PWM_change(0,1);
-      TIMER0_PWM_change(0,2);
-  }
+/** ***************************************************************************
+ * @brief Write all set points to the drivers, e.g. after the lamp was switched
+ *
+ * Only the set points which differ from the drivers are written,
+ * RGB is only recalculated if one of its channels has changed.
+ * @n Not during a colour stream, the frames are written by the TIMER0 interrupt.
+ * @n A clap that has switched the lamp since the last call
+ * is measured up to here (see latency.c).
+ * @n RGB is recalculated as well after TIMER0_IRQHandler() has retuned
+ * TIMER0 (new scale, same set points).
+ * @note Not reentrant, called by the main loop only.
+ *****************************************************************************/
+void lightOnOrOff(void) {
+#ifdef LAT_TRACE
+	bool clapped = (lampState != PWR_lamp_written);	// since the last call
+	if (clapped) {
+		PWR_lamp_written = !PWR_lamp_written;
+	}
+#endif
+	if (STR_Active()) {
+		return;								// a frame is not measured
+	}
+	if (PWR_timer_retuned) {
+		PWR_timer_retuned = false;			// before the scale is read
+		PWR_rgb_changed = true;
+	}
+#ifdef LAT_TRACE
+	if (clapped) {
+		CORE_DECLARE_IRQ_STATE;
+		CORE_ENTER_CRITICAL();				// the clap is sampled by TIMER0_IRQHandler()
+		LAT_Arm(LAT_CLAP, LAT_InputTime(LAT_CLAP));
+		CORE_EXIT_CRITICAL();
+	}
+#endif
+	for (uint32_t solution = 0; solution < PWR_SOLUTION_COUNT; solution++) {
+		PWR_output(solution);
+	}
+	PWR_rgb_flush();
+#ifdef LAT_TRACE
+	if (clapped) {
+		PWR_latency_written();				// unless RGB is still to be written
+	}
+#endif
+}
+
+
+/** ***************************************************************************
+ * @brief Measure the update path of the set points
+ * @return core cycles of one PWR_set_value(), averaged over
+ * PWR_BENCHMARK_ROUNDS rounds of all channels
+ *
+ * The current set points are written again, so the light doesn't change.
+ *****************************************************************************/
+uint32_t PWR_benchmark(void) {
+	uint32_t start = G_Cycles();
+	for (uint32_t round = 0; round < PWR_BENCHMARK_ROUNDS; round++) {
+		for (uint32_t solution = 0; solution < PWR_SOLUTION_COUNT; solution++) {
+			PWR_written[solution] = PWR_WRITTEN_NONE;	// write the driver anyway
+			PWR_set_value(solution, PWR_value[solution]);
+		}
+	}
+	return (G_Cycles() - start) / (PWR_BENCHMARK_ROUNDS * PWR_SOLUTION_COUNT);
 }
 
 
@@ -246,30 +864,144 @@ uint32_t PWR_get_value(uint32_t solution) {
 }
 
 
+/** ***************************************************************************
+ * @brief Calculate PWM period and scale factor of TIMER0 for the current clock
+ *****************************************************************************/
+static void PWR_timer_tune(void) {
+	PWR_timer_top = CMU_ClockFreqGet(cmuClock_TIMER0) / PWR_pwm_frequency;
+	PWR_timer_scale = (PWR_timer_top << PWR_conversion_shift) / PWR_VALUE_MAX;
+	PWR_clap_divider = PWR_pwm_frequency / PWR_CLAP_FREQUENCY;
+}
+
+
+/** ***************************************************************************
+ * @brief Select the PWM frequency of the RGB channels
+ * @param [in] frequency in Hz, rounded down to a multiple of 500 Hz
+ * and limited to 500 Hz ... PWR_PWM_FREQUENCY_MAX
+ * @return resolution = number of PWM steps per period at this frequency
+ *
+ * A higher frequency is invisible also for moving eyes and cameras,
+ * but the resolution drops: e.g. 32 MHz / 500 Hz = 64000 steps,
+ * 32 MHz / 20 kHz = 1600 steps.
+ * @n The new frequency is applied at the start of the next period.
+ * The clap sensor is still sampled at PWR_CLAP_FREQUENCY.
+ *****************************************************************************/
+uint32_t PWR_set_frequency(uint32_t frequency) {
+	if (frequency > PWR_PWM_FREQUENCY_MAX) { frequency = PWR_PWM_FREQUENCY_MAX; }
+	frequency -= frequency % PWR_CLAP_FREQUENCY;
+	if (frequency < PWR_CLAP_FREQUENCY) { frequency = PWR_CLAP_FREQUENCY; }
+	PWR_pwm_frequency = frequency;
+	PWR_pwm_frequency_changed = true;
+	if (PWR_timer_stopped) {				// no period running, tune now
+		PWR_timer_tune();
+		TIMER0->TOP = PWR_timer_top;
+		PWR_pwm_frequency_changed = false;
+		PWR_rgb_changed = true;				// new scale, same set points
+		lightOnOrOff();
+	}
+	return CMU_ClockFreqGet(cmuClock_TIMER0) / frequency;
+}
+
+
 /** ***************************************************************************
  * @brief Start all the power LED drivers.
  *
  * All the peripherals are initialized and started
  * for each HW/SW solution for the LED driver.
+ * @n The last stored set points are restored immediately,
+ * so the light is on even before the crystals are running.
  *****************************************************************************/
 void PWR_init(void) {
 	CMU_ClockEnable(cmuClock_GPIO, true);	// enable GPIO clock
 
-	//32Mhz Clock -> 500Hz -> 64000, with dutycycle 1/2 (32000)
-	TIMER0_PWM_init(64000, 32000);
+	for (uint32_t solution = 0; solution < PWR_SOLUTION_COUNT; solution++) {
+		uint32_t value = PWR_START_VALUE;
+		NV_Read(NV_KEY_PWR_VALUE + solution, &value);	// last stored set point
+		PWR_value[solution] = value;
+		//Pulldown Output, low until the driver takes over
+		GPIO_PinModeSet(PWR_channel[solution].port, PWR_channel[solution].pin,
+				gpioModePushPull, 0);
+	}
+
+	//HF Clock -> 500Hz (e.g. 32MHz -> 64000), start with all outputs off
+	PWR_timer_tune();
+	TIMER0_PWM_init(PWR_timer_top, 0);
+
+  //32768 Hz Clock -> 500Hz -> 66, start with output off
+	LETIMER0_PWM_init(PWR_WHITE_TOP, 0);
+
+	//Amber by binary code modulation on a GPIO
+	BCM_Init();
+
+#ifdef PWR_DEEP_DIMMING
+	//Current reference for RGB
+	PWR_dac_init();
+#endif
+
+#ifdef PWR_CURRENT_REGULATION
+	//Shunt measurement and PI controllers for RGB
+	REG_Init();
+#endif
 
-  //32768 Hz Clock -> 500Hz -> 66, with dutycycle 1/2 (33)
-	LETIMER0_PWM_init(66,33);
+#ifdef PWR_HW_CUTOFF
+	//Peak current cut-off for RGB without CPU
+	PWR_cutoff_init();
+#endif
 
+	lightOnOrOff();							// restore the last colour
+
+	/* The first PWM period already has the colour: compares written before
+	 * the start, and the start at TOP overflows at once, which sets the outputs
+	 * and takes the boot trace in TIMER0_IRQHandler() */
+	PWR_rgb_apply();
+	PWR_rgb_pending = false;
+	TIMER0->CNT = PWR_timer_top;
+	TIMER0->CMD = TIMER_CMD_START;
 
-	//Pulldown Output for Timers
-	GPIO_PinModeSet(PWR_TIM0_PORT, PWR_RED_TIM_PIN, gpioModePushPull, 0);
-	GPIO_PinModeSet(PWR_TIM0_PORT, PWR_GREEN_TIM_PIN, gpioModePushPull, 0);
-  GPIO_PinModeSet(PWR_TIM0_PORT, PWR_BLUE_TIM_PIN, gpioModePushPull, 0);
-  GPIO_PinModeSet(PWR_LE_TIM0_PORT, PWR_WHITE_TIM_PIN, gpioModePushPull, 0);
   GPIO_PinModeSet(CLAP_SENSE_PORT, CLAP_SENSE_PIN, gpioModeInput, 0);
+
+	/* Clap wakes up TIMER0, interrupt is enabled only while TIMER0 is stopped */
+	GPIO_IntConfig(CLAP_SENSE_PORT, CLAP_SENSE_PIN, false, true, false);
 }
 
+
+/** ***************************************************************************
+ * @brief Check if TIMER0 is needed, stop it if not
+ * @return true = TIMER0 is running, the HF clock is needed (EM1)
+ * @n false = TIMER0 is stopped, EM2 is legal
+ *
+ * TIMER0 is needed for the RGB PWM, the switch to the HF crystal
+ * and while a clap is being sampled.
+ * @n The amber BCM needs the core clock as well.
+ * @n When stopped, the RGB outputs are driven low by the GPIOs
+ * and the clap input wakes up TIMER0 again.
+ * @n During a colour stream TIMER0 shows the frames
+ * and the serial interface runs on the HF clock.
+ * @note Called with interrupts masked right before going to sleep.
+ *****************************************************************************/
+bool PWR_sleep_prepare(void) {
+	if (STR_Active()) {
+		PWR_timer_start();					// in case it has been stopped
+		return true;
+	}
+	if (PWR_timer_stopped) {
+		return false;
+	}
+	if (BCM_Running()) {
+		return true;						// SysTick stops in EM2
+	}
+	if (PWR_rgb_needed() || clapTimeOn || !(CMU->STATUS & CMU_STATUS_HFXOSEL)) {
+		return true;
+	}
+	TIMER0->CMD = TIMER_CMD_STOP;
+	TIMER0->ROUTE &= ~PWR_TIM0_ROUTE_PEN;	// outputs low by GPIO
+	PWR_timer_stopped = true;
+	GPIO_IntClear(1 << CLAP_SENSE_PIN);
+	GPIO_IntEnable(1 << CLAP_SENSE_PIN);	// wake up on a clap
+	return false;
+}
+
+
 /** ***************************************************************************
  * @brief TIMER0 interrupt handler.
  *
@@ -278,23 +1010,76 @@ void PWR_init(void) {
  * @note This interrupt handler is time critical.
  * Make sure that the CPU time used is shorter than the timer period.
  * @n CMSIS commands are used instead of EMLIB functions, because they run faster.
+ * @n Switching the HF clock to the crystal is done here once after boot.
  *****************************************************************************/
 void TIMER0_IRQHandler(void) {
 	SL_On(SL_0_PORT, SL_0_PIN);				// start for timing measurement
 
+	if (!G_boot_us) {						// first PWM edge after reset
+		G_BootTraceFirstEdge();
+	}
 
-	if (!GPIO_readPin(CLAP_SENSE_PORT,CLAP_SENSE_PIN)) {
-	    clapTimeOn += 1;
-	} else {
-	    if (!(clapTimeOn > 10 || clapTimeOn < 1)) {
-	        clapCounter += 1;
-	    }
-      clapTimeOn = 0;
+	/* Switch to the HF crystal or to a new PWM frequency
+	 * at the beginning of a PWM period.
+	 * The counter has just wrapped, so the period for the new clock
+	 * is still in time for this period. The compare values are
+	 * recalculated by the main loop, which runs right after this interrupt:
+	 * lightOnOrOff() is not reentrant. */
+	if (INIT_HFXO_switch() || PWR_pwm_frequency_changed) {
+		PWR_pwm_frequency_changed = false;
+		PWR_timer_tune();
+		TIMER0->TOP = PWR_timer_top;
+		BCM_Retune();
+		PWR_timer_retuned = true;			// compares by lightOnOrOff()
+	}
+
+#ifdef PWR_HW_CUTOFF
+	/* count the comparator edges without their interrupt */
+	if (ACMP0->IF & ACMP_IF_EDGE) {
+		PWR_acmp_edges++;
+		ACMP0->IFC = ACMP_IFC_EDGE;
+	}
+	/* rearm the cut-off for the new period */
+	if (TIMER0->DTFAULT & TIMER_DTFAULT_DTPRS0F) {
+		PWR_cutoff_periods++;
+		TIMER0->DTFAULTC = TIMER_DTFAULTC_DTPRS0FC;
+	}
+#endif
+
+	/* next frame of the colour stream, if due */
+	uint8_t frame[PWR_SOLUTION_COUNT];
+	if (STR_Active() && STR_Next(sl_sleeptimer_get_tick_count(), frame)) {
+		PWR_stream_frame(frame);
 	}
 
-	if (clapTimeOn >= 1) {
-	    lampState = !lampState;
-      clapCounter = 0;
+	/* new RGB values, write compares and current reference together */
+#ifdef PWR_CURRENT_REGULATION
+	PWR_rgb_pending = true;					// trim changes every period
+#endif
+	if (PWR_rgb_pending) {
+		PWR_rgb_apply();
+		PWR_rgb_pending = false;
+	}
+
+
+	/* the clap sensor is sampled at PWR_CLAP_FREQUENCY */
+	if (++PWR_clap_count >= PWR_clap_divider) {
+		PWR_clap_count = 0;
+
+		if (!PIN_IN(CLAP_SENSE_PORT, CLAP_SENSE_PIN)) {
+		    clapTimeOn += 1;
+		} else {
+		    if (!(clapTimeOn > 10 || clapTimeOn < 1)) {
+		        clapCounter += 1;
+		    }
+	      clapTimeOn = 0;
+		}
+
+		if (clapTimeOn >= 1) {
+		    lampState = !lampState;
+		    LAT_Input(LAT_CLAP, sl_sleeptimer_get_tick_count());
+	      clapCounter = 0;
+		}
 	}
 
   TIMER0->IFC = TIMER_IFC_OF;       // clear overflow interrupt flag
@@ -303,6 +1088,34 @@ void TIMER0_IRQHandler(void) {
 }
 
 
+/** ***************************************************************************
+ * @brief LETIMER0 interrupt handler: dither the white compare value
+ *
+ * At each underflow (start of a PWM period)
+ * the compare value for this period is written.
+ * @note Runs also in EM2, bounded to a few cycles per period.
+ *****************************************************************************/
+void LETIMER0_IRQHandler(void) {
+	LETIMER0->IFC = LETIMER_IFC_UF;		// clear interrupt flag
+	LETIMER0->COMP1 = PWR_white_dither(&PWR_white_error, PWR_white_q12);
+}
+
+
+/** ***************************************************************************
+ * @brief GPIO interrupt handler of the clap input
+ * @note The even GPIO interrupts share the same
+ * interrupt service routine GPIO_EVEN_IRQHandler() in pushbuttons.c
+ * which calls this function.
+ * @n A clap starts TIMER0 to sample it.
+ *****************************************************************************/
+void PWR_GPIO_IRQHandler(void) {
+	if (PIN_IRQ_FLAG(CLAP_SENSE_PIN) && PIN_ALIAS(GPIO->IEN, CLAP_SENSE_PIN)) {
+		GPIO->IFC = (1 << CLAP_SENSE_PIN);	// clear interrupt flag
+		PWR_timer_start();
+	}
+}
+
+
 /** ***************************************************************************
  * @brief ACMP interrupt handler
  * @note Be aware of the fact that ACMP0 and ACMP1 share the same
@@ -312,9 +1125,12 @@ void TIMER0_IRQHandler(void) {
  * @n This PWR_ACMP_IRQHandler() handles the ACMP0 interrupt
  * when it is called by ACMP0_IRQHandler() in touchslider.c
  * @n As part of an interrupt handler this is a time critical section.
+ * @n The pulses are ended in hardware (PWR_HW_CUTOFF) and the edges are
+ * counted in TIMER0_IRQHandler(), so the flag is only cleared here
+ * if the ACMP0 interrupt has been enabled.
  *****************************************************************************/
 void PWR_ACMP_IRQHandler(void) {
-  if (ACMP0->IF & ACMP_IFC_EDGE) {    // edge on ACMP0 detected
+  if (ACMP0->IF & ACMP0->IEN & ACMP_IFC_EDGE) {    // edge on ACMP0 detected
     ACMP0->IFC = ACMP_IFC_EDGE;     // clear interrupt flag
   }
 }
@@ -22,6 +22,10 @@
 
 
 #include "pushbuttons.h"
+#include "powerLEDs.h"						// GPIO_EVEN interrupt is shared!
+#include "latency.h"
+
+#include "sl_sleeptimer.h"
 
 
 /******************************************************************************
@@ -74,9 +78,10 @@ void PB_Init(void) {
  * It has to be cleared explicitly after handling.
  *****************************************************************************/
 void GPIO_ODD_IRQHandler(void) {
-	if (GPIO->IF & (1 << PB0_PIN)) {	// check is IRQ flag is set
+	if (PIN_IRQ_FLAG(PB0_PIN)) {		// check is IRQ flag is set
 		GPIO->IFC = (1 << PB0_PIN);		// clear IRQ flag
 		PB0_IRQflag = true;				// pushbutton 0 was pressed
+		LAT_Input(LAT_BUTTON, sl_sleeptimer_get_tick_count());
 	}
 }
 
@@ -87,12 +92,15 @@ void GPIO_ODD_IRQHandler(void) {
  * to be able to return from interrupt handling.
  * @note The PB1_IRQflag is set and can be handled asynchronously.
  * It has to be cleared explicitly after handling.
+ * @n The clap input of the power LEDs shares this interrupt handler.
  *****************************************************************************/
 void GPIO_EVEN_IRQHandler(void) {
-	if (GPIO->IF & (1 << PB1_PIN)) {	// check is IRQ flag is set
+	if (PIN_IRQ_FLAG(PB1_PIN)) {		// check is IRQ flag is set
 		GPIO->IFC = (1 << PB1_PIN);		// clear IRQ flag
 		PB1_IRQflag = true;				// pushbutton 1 was pressed
+		LAT_Input(LAT_BUTTON, sl_sleeptimer_get_tick_count());
 	}
+	PWR_GPIO_IRQHandler();				// clap input
 }
 
 
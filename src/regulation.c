@@ -0,0 +1,208 @@
+/** ***************************************************************************
+ * @file
+ * @brief Closed loop regulation of the RGB LED currents
+ *
+ * ADC0 scans the shunt voltages of all RGB channels once per PWM period.
+ * The scan is triggered by the TIMER0 overflow over PRS channel 0
+ * and the results are collected by DMA, so no CPU time is needed for that.
+ * @n The shunt voltages are low pass filtered on the LED driver board,
+ * i.e. the ADC measures the average current of each channel.
+ *
+ * When the DMA has transferred all results, a fixed point PI controller
+ * per channel calculates a trim factor for the PWM duty cycle
+ * (see PWR_rgb_apply() in powerLEDs.c).
+ * @n The controller is a pure function, REG_PI_Step() in regulation.h,
+ * tools/pisim.c tests it on the PC against a plant model.
+ *
+ * The external ADC0 inputs are PD0 ... PD7 only. PD0 ... PD6 are taken
+ * by amber, RGB, LEUART0 and the clap input, so only PD7 is free
+ * on the current board. A channel without a shunt input (REG_NO_INPUT)
+ * is not scanned and not regulated, its trim stays 1.0.
+ *
+ * The CPU time of a control step is measured with the cycle counter,
+ * see REG_GetCycles().
+ *
+ * Prefix: REG
+ *
+ * Board:  Starter Kit EFM32-G8XX-STK
+ * Device: EFM32G890F128 (Gecko)
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#include "em_device.h"
+#include "em_cmu.h"
+#include "em_adc.h"
+#include "em_dma.h"
+#include "em_prs.h"
+
+#include "regulation.h"
+#include "globals.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define REG_NO_INPUT		(-1)			///< channel without shunt input
+#define REG_INPUT_COUNT		8				///< ADC0 CH0 ... CH7 = PD0 ... PD7
+#define REG_ADC_CLOCK		4000000			///< ADC clock in Hz
+#define REG_PRS_CHANNEL		0				///< PRS channel TIMER0 -> ADC0
+#define REG_DMA_CHANNEL		0				///< DMA channel ADC0 -> memory
+
+/** ADC0 input of the shunt of red, green and blue, REG_NO_INPUT = none.
+ * @todo Adjust to the wiring of the LED driver board, no pin of another function */
+static const int8_t REG_input[REG_CHANNEL_COUNT] = { 7, REG_NO_INPUT, REG_NO_INPUT };
+
+/** PI parameters, tested with the plant model of tools/pisim.c */
+#define REG_KP				1024			///< 0.25 in Q12
+#define REG_KI				512				///< 0.125 per period in Q12
+#define REG_TRIM_LIMIT		1024			///< trim at most +/- 25 %
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+/** DMA descriptors of all channels, primary and alternate */
+static DMA_DESCRIPTOR_TypeDef REG_dma_control[DMA_CHAN_COUNT * 2]
+		__attribute__ ((aligned(DMA_CONTROL_BLOCK_ALIGNMENT)));
+static DMA_CB_TypeDef REG_dma_cb;			///< DMA done callback
+
+static volatile uint32_t REG_samples[REG_CHANNEL_COUNT];	///< written by DMA
+static uint32_t REG_sample_of[REG_CHANNEL_COUNT];	///< index in REG_samples
+static uint32_t REG_scan_count = 0;			///< inputs scanned
+static volatile uint32_t REG_setpoint[REG_CHANNEL_COUNT];	///< 0 = not regulated
+static volatile int32_t REG_trim[REG_CHANNEL_COUNT] = {
+	REG_TRIM_ONE, REG_TRIM_ONE, REG_TRIM_ONE
+};
+static REG_pi_t REG_pi[REG_CHANNEL_COUNT];
+static volatile uint32_t REG_cycles = 0;	///< max cycles of a control step
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief DMA callback: all the shunt voltages of this period are sampled
+ * @param [in] channel of DMA (not used)
+ * @param [in] primary descriptor (not used)
+ * @param [in] user pointer (not used)
+ *
+ * Runs the PI controllers and rearms the DMA for the next scan.
+ * @note Called by DMA_IRQHandler() in em_dma.c, time critical.
+ *****************************************************************************/
+static void REG_DmaDone(unsigned int channel, bool primary, void *user) {
+	(void)channel;
+	(void)primary;
+	(void)user;
+	uint32_t start = G_Cycles();
+	for (uint32_t i = 0; i < REG_CHANNEL_COUNT; i++) {
+		int32_t setpoint = REG_setpoint[i];
+		if ((setpoint > 0) && (REG_NO_INPUT != REG_input[i])) {	// on, regulate
+			int32_t sample = REG_samples[REG_sample_of[i]];
+			int32_t error = (setpoint - sample) * 4096 / setpoint;
+			REG_trim[i] = REG_TRIM_ONE + REG_PI_Step(&REG_pi[i], error);
+		}									// otherwise hold the last trim
+	}
+	DMA_ActivateBasic(REG_DMA_CHANNEL, true, false, (void *)REG_samples,
+			(void *)&ADC0->SCANDATA, REG_scan_count - 1);
+	uint32_t cycles = G_Cycles() - start;
+	if (cycles > REG_cycles) {
+		REG_cycles = cycles;
+	}
+}
+
+/** ***************************************************************************
+ * @brief Setup ADC0 scan, PRS trigger from TIMER0 and DMA
+ *
+ * Nothing is started without any shunt input.
+ *****************************************************************************/
+void REG_Init(void) {
+	for (uint32_t i = 0; i < REG_CHANNEL_COUNT; i++) {
+		REG_pi[i] = (REG_pi_t){ .kp = REG_KP, .ki = REG_KI, .limit = REG_TRIM_LIMIT };
+	}
+	/* the scan delivers the inputs in ascending order */
+	uint32_t inputs = 0;
+	REG_scan_count = 0;
+	for (int32_t input = 0; input < REG_INPUT_COUNT; input++) {
+		for (uint32_t i = 0; i < REG_CHANNEL_COUNT; i++) {
+			if (REG_input[i] == input) {
+				inputs |= ADC_SCANCTRL_INPUTMASK_CH0 << input;
+				REG_sample_of[i] = REG_scan_count++;
+			}
+		}
+	}
+	if (0 == REG_scan_count) {
+		return;
+	}
+
+	/* TIMER0 overflow starts a scan */
+	CMU_ClockEnable(cmuClock_PRS, true);
+	PRS_SourceSignalSet(REG_PRS_CHANNEL, PRS_CH_CTRL_SOURCESEL_TIMER0,
+			PRS_CH_CTRL_SIGSEL_TIMER0OF, prsEdgePos);
+
+	/* ADC0 scans the shunt inputs */
+	CMU_ClockEnable(cmuClock_ADC0, true);
+	ADC_Init_TypeDef adcInit = ADC_INIT_DEFAULT;
+	adcInit.warmUpMode = adcWarmupKeepADCWarm;
+	adcInit.timebase = ADC_TimebaseCalc(0);
+	adcInit.prescale = ADC_PrescaleCalc(REG_ADC_CLOCK, 0);
+	ADC_Init(ADC0, &adcInit);
+	ADC_InitScan_TypeDef scanInit = ADC_INITSCAN_DEFAULT;
+	scanInit.reference = adcRef2V5;
+	scanInit.input = inputs;
+	scanInit.prsEnable = true;
+	scanInit.prsSel = adcPRSSELCh0;
+	ADC_InitScan(ADC0, &scanInit);
+
+	/* DMA collects the results */
+	CMU_ClockEnable(cmuClock_DMA, true);
+	DMA_Init_TypeDef dmaInit = { .hprot = 0, .controlBlock = REG_dma_control };
+	DMA_Init(&dmaInit);
+	REG_dma_cb.cbFunc = REG_DmaDone;
+	REG_dma_cb.userPtr = NULL;
+	DMA_CfgChannel_TypeDef chnlCfg = {
+		.highPri = false, .enableInt = true,
+		.select = DMAREQ_ADC0_SCAN, .cb = &REG_dma_cb
+	};
+	DMA_CfgChannel(REG_DMA_CHANNEL, &chnlCfg);
+	DMA_CfgDescr_TypeDef descrCfg = {
+		.dstInc = dmaDataInc4, .srcInc = dmaDataIncNone,
+		.size = dmaDataSize4, .arbRate = dmaArbitrate1, .hprot = 0
+	};
+	DMA_CfgDescr(REG_DMA_CHANNEL, true, &descrCfg);
+	DMA_ActivateBasic(REG_DMA_CHANNEL, true, false, (void *)REG_samples,
+			(void *)&ADC0->SCANDATA, REG_scan_count - 1);
+}
+
+/** ***************************************************************************
+ * @brief Set the average current of a channel
+ * @param [in] channel 0 = red, 1 = green, 2 = blue
+ * @param [in] setpoint in ADC codes, 0 = off (trim is held)
+ *****************************************************************************/
+void REG_SetTarget(uint32_t channel, uint32_t setpoint) {
+	if (channel < REG_CHANNEL_COUNT) {
+		REG_setpoint[channel] = setpoint;
+	}
+}
+
+/** ***************************************************************************
+ * @brief Get the trim factor of a channel
+ * @param [in] channel 0 = red, 1 = green, 2 = blue
+ * @return factor for the PWM duty cycle in Q12 (REG_TRIM_ONE = 1.0)
+ *****************************************************************************/
+int32_t REG_GetTrim(uint32_t channel) {
+	if (channel >= REG_CHANNEL_COUNT) {
+		return REG_TRIM_ONE;
+	}
+	return REG_trim[channel];
+}
+
+/** ***************************************************************************
+ * @brief Get the CPU time of a control step
+ * @return max number of core cycles used by REG_DmaDone() so far
+ *****************************************************************************/
+uint32_t REG_GetCycles(void) {
+	return REG_cycles;
+}
@@ -0,0 +1,262 @@
+/** ***************************************************************************
+ * @file
+ * @brief Real-time colour stream with a jitter buffer
+ *
+ * A PC pushes colour frames, e.g. 50 ... 100 per second for music or video,
+ * and the lamp shows each one at its time stamp plus a constant delay.
+ *
+ * A frame has STR_FRAME_SIZE bytes:
+ * @n STR_SYNC, time stamp in ms (16 bit, little endian),
+ * white, amber, red, green, blue (0 ... PWR_VALUE_MAX each),
+ * check byte = the 8 bytes after STR_SYNC add up to 0 (modulo 256).
+ * @n A frame with the time stamp STR_TIME_END ends the stream
+ * after the buffered frames have been shown.
+ * Without a frame for STR_TIMEOUT_MS the stream ends as well.
+ *
+ * The bytes are fed one at a time by the RX interrupt (STR_Receive()).
+ * Each valid frame gets its playout time:
+ * the first one arrives at now + the delay, the following ones
+ * at the same distance from it as their time stamps.
+ * So the jitter of the link is absorbed as long as it is below the delay.
+ * @n A frame which arrives after its playout time is counted as late
+ * and the stream is anchored anew: it is shown after the delay.
+ * The same happens if the time stamps jump back or far ahead,
+ * e.g. when the PC restarts the stream.
+ *
+ * The frames are taken out by the TIMER0 interrupt at the start
+ * of each PWM period (STR_Next()): the latest frame which is due is shown,
+ * older ones are skipped.
+ * @n If the buffer is empty when the next frame would have been due,
+ * an underrun is counted once until a frame is shown again.
+ *
+ * The times are given by the callers in ticks of STR_TICK_HZ,
+ * so the module runs on the PC as well (tools/streamsink.c).
+ *
+ * Prefix: STR
+ *
+ * Board:  Starter Kit EFM32-G8XX-STK
+ * Device: EFM32G890F128 (Gecko)
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#include "stream.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define STR_MS_TO_TICKS(ms)	((uint32_t)(ms) * STR_TICK_HZ / 1000)
+
+/** A frame waiting in the jitter buffer */
+typedef struct {
+	uint32_t due;							///< playout time in ticks
+	uint8_t value[PWR_SOLUTION_COUNT];		///< set points
+} STR_frame_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+static volatile bool STR_active = false;	///< a stream is running
+static volatile bool STR_ending = false;	///< end of the stream received
+static uint32_t STR_delay = 0;				///< playout delay in ticks
+static uint32_t STR_counter[STR_COUNTER_COUNT];	///< see STR_counter_t
+
+/** Jitter buffer, written by STR_Receive() and read by STR_Next() only */
+static STR_frame_t STR_buffer[STR_BUFFER_SIZE];
+static volatile uint32_t STR_in = 0;		///< written by the receiver only
+static volatile uint32_t STR_out = 0;		///< written by the player only
+
+/** Receiver, only used in the RX interrupt */
+static uint8_t STR_rx[STR_FRAME_SIZE];		///< frame being received
+static uint32_t STR_rx_count = 0;			///< bytes of the frame so far
+static bool STR_anchored = false;			///< the first frame has been received
+static uint16_t STR_time = 0;				///< time stamp of the last frame
+static uint32_t STR_due = 0;				///< playout time of the last frame
+static uint32_t STR_due_fraction = 0;		///< rest of the conversion ms -> ticks
+static volatile uint32_t STR_interval = 0;	///< ticks between the last two frames
+static volatile uint32_t STR_last_rx = 0;	///< time of the last valid frame
+
+/** Player, only used in the timer interrupt */
+static uint32_t STR_shown = 0;				///< playout time of the frame shown
+static bool STR_playing = false;			///< a frame has been shown
+static bool STR_starved = false;			///< underrun counted, wait for a frame
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Start a stream
+ * @param [in] delay_ms playout delay, limited to STR_DELAY_MAX_MS
+ * @param [in] now time in ticks
+ *
+ * The buffer and the counters are cleared.
+ *****************************************************************************/
+void STR_Start(uint32_t delay_ms, uint32_t now) {
+	if (delay_ms > STR_DELAY_MAX_MS) { delay_ms = STR_DELAY_MAX_MS; }
+	STR_active = false;						// the interrupts keep off
+	STR_delay = STR_MS_TO_TICKS(delay_ms);
+	for (uint32_t counter = 0; counter < STR_COUNTER_COUNT; counter++) {
+		STR_counter[counter] = 0;
+	}
+	STR_out = STR_in;
+	STR_rx_count = 0;
+	STR_anchored = false;
+	STR_interval = 0;
+	STR_last_rx = now;						// the timeout starts now
+	STR_playing = false;
+	STR_starved = false;
+	STR_ending = false;
+	STR_active = true;
+}
+
+/** ***************************************************************************
+ * @brief Stop the stream at once, the buffered frames are discarded
+ *****************************************************************************/
+void STR_Stop(void) {
+	STR_active = false;
+}
+
+/** ***************************************************************************
+ * @brief Check if a stream is running
+ * @return true = the frames control the power LEDs
+ *****************************************************************************/
+bool STR_Active(void) {
+	return STR_active;
+}
+
+/** ***************************************************************************
+ * @brief Calculate the playout time of a valid frame and buffer it
+ * @param [in] now time in ticks
+ *****************************************************************************/
+static void STR_Frame(uint32_t now) {
+	uint16_t time = STR_rx[1] | (STR_rx[2] << 8);
+	STR_last_rx = now;
+	if (STR_TIME_END == time) {
+		STR_ending = true;					// show the rest, then stop
+		return;
+	}
+	STR_counter[STR_FRAMES]++;
+
+	uint16_t delta = time - STR_time;		// wraps around after 65 s
+	STR_time = time;
+	bool anchor = !STR_anchored || (delta >= 0x8000);	// first or back in time
+	if (!anchor) {
+		STR_due_fraction += delta * STR_TICK_HZ;
+		STR_interval = STR_due_fraction / 1000;
+		STR_due += STR_interval;
+		STR_due_fraction %= 1000;
+		if ((int32_t)(STR_due - now) < 0) {
+			STR_counter[STR_LATE]++;		// the link was slower than the delay
+			anchor = true;
+		} else if (STR_due - now > STR_delay + STR_MS_TO_TICKS(STR_DELAY_MAX_MS)) {
+			anchor = true;					// far ahead, e.g. a new stream
+		}
+	}
+	if (anchor) {
+		STR_anchored = true;
+		STR_due = now + STR_delay;
+		STR_due_fraction = 0;
+	}
+
+	uint32_t in = STR_in;
+	if (in - STR_out >= STR_BUFFER_SIZE) {
+		STR_counter[STR_OVERRUNS]++;		// more ahead than the buffer holds
+		return;
+	}
+	STR_frame_t *frame = &STR_buffer[in % STR_BUFFER_SIZE];
+	frame->due = STR_due;
+	for (uint32_t i = 0; i < PWR_SOLUTION_COUNT; i++) {
+		frame->value[i] = STR_rx[3 + i];
+	}
+	STR_in = in + 1;						// publish after the copy
+}
+
+/** ***************************************************************************
+ * @brief Feed one received byte
+ * @param [in] c received byte
+ * @param [in] now time in ticks
+ *
+ * Bytes before STR_SYNC are skipped, so the receiver finds the next frame
+ * after a wrong check byte.
+ * @note Called from the RX interrupt of the serial interface.
+ *****************************************************************************/
+void STR_Receive(uint8_t c, uint32_t now) {
+	if (!STR_active || STR_ending) {
+		return;
+	}
+	if ((0 == STR_rx_count) && (STR_SYNC != c)) {
+		return;								// wait for the start of a frame
+	}
+	STR_rx[STR_rx_count++] = c;
+	if (STR_rx_count < STR_FRAME_SIZE) {
+		return;
+	}
+	STR_rx_count = 0;
+	uint8_t sum = 0;
+	for (uint32_t i = 1; i < STR_FRAME_SIZE; i++) {
+		sum += STR_rx[i];
+	}
+	if (sum) {
+		STR_counter[STR_ERRORS]++;
+		return;
+	}
+	STR_Frame(now);
+}
+
+/** ***************************************************************************
+ * @brief Get the frame to show now
+ * @param [in] now time in ticks
+ * @param [out] value set points (only written if a frame is due)
+ * @return true = a new frame is due
+ *
+ * Also ends the stream after its last frame or after STR_TIMEOUT_MS.
+ * @note Called from the timer interrupt at the start of a PWM period.
+ *****************************************************************************/
+bool STR_Next(uint32_t now, uint8_t value[PWR_SOLUTION_COUNT]) {
+	if (!STR_active) {
+		return false;
+	}
+	bool due = false;
+	uint32_t out = STR_out;
+	while ((out != STR_in) && ((int32_t)(now - STR_buffer[out % STR_BUFFER_SIZE].due) >= 0)) {
+		const STR_frame_t *frame = &STR_buffer[out % STR_BUFFER_SIZE];
+		for (uint32_t i = 0; i < PWR_SOLUTION_COUNT; i++) {
+			value[i] = frame->value[i];
+		}
+		STR_shown = frame->due;
+		out++;								// an older one is overwritten
+		due = true;
+	}
+	STR_out = out;							// release after the copy
+
+	if (due) {
+		STR_playing = true;
+		STR_starved = false;
+	} else if (out == STR_in) {				// buffer empty
+		if (STR_ending || (now - STR_last_rx > STR_MS_TO_TICKS(STR_TIMEOUT_MS))) {
+			STR_active = false;
+		} else if (STR_playing && !STR_starved
+				&& ((int32_t)(now - STR_shown - STR_interval) > 0)) {
+			STR_counter[STR_UNDERRUNS]++;	// the next frame is overdue
+			STR_starved = true;
+		}
+	}
+	return due;
+}
+
+/** ***************************************************************************
+ * @brief Get a counter of the current or last stream
+ * @param [in] counter STR_counter_t
+ * @return count since the start of the stream, 0 for an invalid counter
+ *****************************************************************************/
+uint32_t STR_GetCounter(uint32_t counter) {
+	if (counter >= STR_COUNTER_COUNT) {
+		return 0;
+	}
+	return STR_counter[counter];
+}
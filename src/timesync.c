@@ -0,0 +1,300 @@
+/** ***************************************************************************
+ * @file
+ * @brief Synchronisation of the scene time with a master
+ *
+ * Several lamps show a shared scene in phase, e.g. the circadian curve
+ * or an effect, if they all follow the scene time of one master (a PC).
+ * The crystals of the lamps drift by some 10 ppm, so each lamp estimates
+ * the offset and the drift of its sleeptimer against the master
+ * and maps its ticks to the scene time (TS_SceneTime()).
+ *
+ * The master sends "ts <t1> [<t4>]" with its time in 0.1 ms
+ * (TS_UNITS_PER_MS), e.g. its time of day. All times of the exchange
+ * are taken at the end of a line, so the length of the lines doesn't matter:
+ * @n t1 master: end of the request sent,
+ * t2 lamp: end of the request received (TS_Request()),
+ * @n t3 lamp: end of the reply sent,
+ * t4 master: end of the reply received, sent with the next request
+ * (TS_Response()).
+ *
+ * A request to one lamp is answered, the exchange gives the delay
+ * of the link: ((t4 - t1) - (t3 - t2)) / 2. The jitter of the link
+ * only adds to the delay, so the smallest one is taken,
+ * slowly aging in case the link has become slower.
+ * @n A request to all the lamps (">* ts <t1>", also for a single lamp)
+ * is not answered, it is a sample of the scene time: at t2 it is t1 + delay.
+ * The master sends one e.g. once per second. As the lamps on a bus
+ * all get the same samples, the jitter of the link doesn't change
+ * their phase, only the error of their delay does.
+ *
+ * Of the samples within TS_WINDOW_S the one with the least delay is taken
+ * (the largest error): the scene time is corrected by a part of its error,
+ * by all of it after the first sample.
+ * The drift is measured from these samples over a baseline
+ * of TS_BASELINE_MIN_S up to TS_BASELINE_MAX_S, so the jitter hardly matters.
+ * The scene time runs at the rate of the master between the samples.
+ * @n A sample far off (TS_STEP_MS) is ignored, if TS_STEP_COUNT follow
+ * in a row, the master has set its time and the lamp follows at once.
+ *
+ * The times are given by the callers in ticks of TS_TICK_HZ,
+ * so the module runs on the PC as well (tools/tssim.c).
+ *
+ * Prefix: TS
+ *
+ * Board:  Starter Kit EFM32-G8XX-STK
+ * Device: EFM32G890F128 (Gecko)
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#include "timesync.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define TS_Q				16				///< fraction bits of the scene time in ms
+#define TS_Q_PER_TICK		(((int64_t)1000 << TS_Q) / TS_TICK_HZ)	///< exact for 32768 Hz
+#define TS_OFFSET_DIVIDER	2				///< part of the error corrected per window
+
+/** Drift in 2^-32, i.e. 1 ppm = 4295 */
+#define TS_DRIFT_MAX		((int64_t)TS_DRIFT_MAX_PPM * 4295)
+
+/** Convert the time of the master to ms with TS_Q fraction bits */
+#define TS_UNITS_TO_Q(t)	(((int64_t)(t) << TS_Q) / TS_UNITS_PER_MS)
+
+/** Convert seconds to ticks */
+#define TS_S_TO_TICKS(s)	((uint32_t)(s) * TS_TICK_HZ)
+
+/** A time of the master or the scene time at a tick of the lamp */
+typedef struct {
+	uint32_t tick;							///< of the lamp
+	int64_t time;							///< ms with TS_Q fraction bits
+} TS_sample_t;
+
+
+/******************************************************************************
+ * Variables
+ *****************************************************************************/
+static bool TS_synced = false;				///< a sample has been received
+static bool TS_locked = false;				///< a window has been taken since the anchor
+static TS_sample_t TS_ref;					///< scene time at a tick
+static int64_t TS_drift = 0;				///< rate against the master - 1, 2^-32
+static TS_sample_t TS_base;					///< start of the baseline of the drift
+static bool TS_base_valid = false;			///< TS_base has been taken
+static TS_sample_t TS_next_base;			///< start of the next baseline
+static bool TS_next_valid = false;			///< TS_next_base has been taken
+static uint32_t TS_large = 0;				///< large errors in a row
+
+static bool TS_window = false;				///< a window of samples has started
+static uint32_t TS_window_tick = 0;			///< start of the window
+static TS_sample_t TS_best;					///< time of the master with the largest error
+static int64_t TS_best_error = 0;			///< of TS_best
+
+static int64_t TS_delay = 0;				///< delay of the link
+static bool TS_delay_valid = false;			///< an exchange has been completed
+static bool TS_pending = false;				///< answered request, wait for t4
+static int32_t TS_t1 = 0;					///< of the pending exchange
+static uint32_t TS_t2 = 0;					///< of the pending exchange
+
+static int32_t TS_info[TS_INFO_COUNT];		///< see TS_info_t
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Forget the master, e.g. when the clock is set by hand
+ *****************************************************************************/
+void TS_Reset(void) {
+	TS_synced = false;
+	TS_drift = 0;
+	TS_large = 0;
+	TS_delay = 0;
+	TS_delay_valid = false;
+	TS_pending = false;
+	for (uint32_t info = 0; info < TS_INFO_COUNT; info++) {
+		TS_info[info] = 0;
+	}
+}
+
+/** ***************************************************************************
+ * @brief Get the scene time at a tick
+ * @param [in] tick of the lamp, not before the reference
+ * @return scene time in ms with TS_Q fraction bits
+ *****************************************************************************/
+static int64_t TS_Scene(uint32_t tick) {
+	uint32_t dt = tick - TS_ref.tick;
+	int64_t drift = ((int64_t)dt * TS_drift) >> TS_Q;	// in 2^-16 ticks
+	return TS_ref.time + (int64_t)dt * TS_Q_PER_TICK
+			+ ((drift * TS_Q_PER_TICK) >> TS_Q);
+}
+
+/** ***************************************************************************
+ * @brief Set the scene time and start anew with the drift measured so far
+ * @param [in] sample time of the master at a tick
+ *****************************************************************************/
+static void TS_Anchor(const TS_sample_t *sample) {
+	TS_ref.tick = sample->tick;
+	TS_ref.time = sample->time + TS_delay;
+	TS_base_valid = false;
+	TS_next_valid = false;
+	TS_window = false;
+	TS_synced = true;
+	TS_locked = false;
+}
+
+/** ***************************************************************************
+ * @brief Measure the drift from the start of the baseline up to a sample
+ * @param [in] sample the best one of a window
+ *
+ * The baseline grows up to TS_BASELINE_MAX_S, then it starts
+ * at the sample taken half way, so it is always long.
+ * @n The times of the master are taken without the delay,
+ * as the estimate of the delay changes meanwhile.
+ *****************************************************************************/
+static void TS_Drift(const TS_sample_t *sample) {
+	uint32_t span = sample->tick - TS_base.tick;
+	if (!TS_base_valid || (span >= 2 * TS_S_TO_TICKS(TS_BASELINE_MAX_S))) {
+		TS_base = *sample;					// the first or no samples for long
+		TS_base_valid = true;
+		TS_next_valid = false;
+		return;
+	}
+	int64_t elapsed = (int64_t)span * TS_Q_PER_TICK;	// ms of the lamp
+	int64_t difference = sample->time - TS_base.time - elapsed;
+	if ((span >= TS_S_TO_TICKS(TS_BASELINE_MIN_S))
+			&& (difference < ((int64_t)1 << 31)) && (difference > -((int64_t)1 << 31))) {
+		TS_drift = (difference << 32) / elapsed;
+		if (TS_drift > TS_DRIFT_MAX) { TS_drift = TS_DRIFT_MAX; }
+		if (TS_drift < -TS_DRIFT_MAX) { TS_drift = -TS_DRIFT_MAX; }
+		TS_info[TS_DRIFT_PPB] = (int32_t)((TS_drift * 1000000000) >> 32);
+	}
+	if ((span >= TS_S_TO_TICKS(TS_BASELINE_MAX_S)) && TS_next_valid) {
+		TS_base = TS_next_base;				// slide on by half
+		TS_next_valid = false;
+	}
+	if (!TS_next_valid && (sample->tick - TS_base.tick >= TS_S_TO_TICKS(TS_BASELINE_MAX_S / 2))) {
+		TS_next_base = *sample;
+		TS_next_valid = true;
+	}
+}
+
+/** ***************************************************************************
+ * @brief Take a request of the master
+ * @param [in] t1 time of the master at the end of the request, 0.1 ms
+ * @param [in] t2 tick of the lamp at the end of the request
+ * @param [in] answered true = the reply is sent, TS_Response() follows,
+ * false = a sample of the scene time
+ *
+ * The first request is taken as a sample in any case.
+ *****************************************************************************/
+void TS_Request(int32_t t1, uint32_t t2, bool answered) {
+	if (answered && TS_synced) {			// only for the delay
+		TS_pending = true;
+		TS_t1 = t1;
+		TS_t2 = t2;
+		return;
+	}
+	TS_info[TS_SAMPLES]++;
+
+	TS_sample_t sample = { t2, TS_UNITS_TO_Q(t1) };
+	if (!TS_synced) {
+		TS_Anchor(&sample);
+		return;
+	}
+	int64_t error = sample.time + TS_delay - TS_Scene(t2);
+	if ((error > ((int64_t)TS_STEP_MS << TS_Q))
+			|| (error < -((int64_t)TS_STEP_MS << TS_Q))) {
+		if (++TS_large < TS_STEP_COUNT) {
+			TS_info[TS_OUTLIERS]++;			// a spike of the link
+			return;
+		}
+		TS_info[TS_STEPS]++;				// the master has set its time
+		TS_large = 0;
+		TS_Anchor(&sample);
+		return;
+	}
+	TS_large = 0;
+	if (!TS_window) {
+		TS_window = true;
+		TS_window_tick = t2;
+	}
+	if ((TS_window_tick == t2) || (error > TS_best_error)) {
+		TS_best = sample;					// least delayed so far
+		TS_best_error = error;
+	}
+	if (t2 - TS_window_tick < TS_S_TO_TICKS(TS_WINDOW_S)) {
+		return;
+	}
+	TS_window = false;
+	TS_info[TS_ERROR_US] = (int32_t)((TS_best_error * 1000) >> TS_Q);
+	TS_ref.time = TS_Scene(TS_best.tick)	// fully after the anchor
+			+ (TS_locked ? TS_best_error / TS_OFFSET_DIVIDER : TS_best_error);
+	TS_ref.tick = TS_best.tick;
+	TS_locked = true;
+	TS_Drift(&TS_best);
+}
+
+/** ***************************************************************************
+ * @brief Complete the exchange of the last answered request
+ * @param [in] t3 tick of the lamp at the end of the reply
+ * @param [in] t4 time of the master at the end of the reply, 0.1 ms
+ *
+ * Updates the delay of the link, the next samples are corrected by it.
+ *****************************************************************************/
+void TS_Response(uint32_t t3, int32_t t4) {
+	if (!TS_pending) {
+		return;
+	}
+	TS_pending = false;
+	int64_t round = TS_UNITS_TO_Q((int32_t)((uint32_t)t4 - (uint32_t)TS_t1))
+			- (int64_t)(t3 - TS_t2) * TS_Q_PER_TICK;	// without the lamp
+	if (round < 0) {
+		round = 0;
+	}
+	int64_t delay = round / 2;
+	if (TS_delay_valid) {
+		TS_delay += ((int64_t)TS_DELAY_AGING_US << TS_Q) / 1000;
+	}
+	if (!TS_delay_valid || (delay < TS_delay)) {
+		TS_delay = delay;					// the least delayed exchange
+		TS_delay_valid = true;
+	}
+	TS_info[TS_DELAY_US] = (int32_t)((TS_delay * 1000) >> TS_Q);
+}
+
+/** ***************************************************************************
+ * @brief Check if the lamp follows a master
+ * @return true = TS_SceneTime() is the time of the master
+ *****************************************************************************/
+bool TS_Synced(void) {
+	return TS_synced;
+}
+
+/** ***************************************************************************
+ * @brief Get the scene time
+ * @param [in] now tick of the lamp
+ * @return time of the master in 0.1 ms (TS_UNITS_PER_MS),
+ * the time of the lamp if not synchronised
+ *****************************************************************************/
+uint32_t TS_SceneTime(uint32_t now) {
+	if (!TS_synced) {
+		return (uint32_t)(((uint64_t)now * 1000 * TS_UNITS_PER_MS) / TS_TICK_HZ);
+	}
+	return (uint32_t)((TS_Scene(now) * TS_UNITS_PER_MS) >> TS_Q);
+}
+
+/** ***************************************************************************
+ * @brief Get information on the synchronisation
+ * @param [in] info TS_info_t
+ * @return value, 0 for an invalid info
+ *****************************************************************************/
+int32_t TS_GetInfo(uint32_t info) {
+	if (info >= TS_INFO_COUNT) {
+		return 0;
+	}
+	return TS_info[info];
+}
@@ -20,6 +20,11 @@
  * Added function CAPSENSE_getSliderValue()
  * for freely definable range/resolution of slider position
  * @note
+ * The calibration (maximum value of each channel) is stored in the nvstore
+ * and restored in CAPSENSE_Init(). The first scan checks if the restored
+ * values are still plausible, otherwise a fresh calibration is started.
+ * So touch works correctly from the first scan after boot.
+ * @note
  * When using ACMP0 somewhere in a project, be aware of the fact that ACMP0 and ACMP1 share
  * the same interrupt service routine ACMP0_IRQHandler() which is placed in this file.
  *
@@ -41,6 +46,10 @@
 #include "touchslider.h"
 
 #include "powerLEDs.h"						// ACMP interrupt is shared!
+#include "nvstore.h"
+#include "latency.h"
+
+#include "sl_sleeptimer.h"
 
 
 /** ***************************************************************************
@@ -61,6 +70,11 @@ static volatile bool measurementComplete;
 /** ACMP interrupt count */
 static volatile uint32_t ACMPcount = 0;
 
+#ifdef LAT_TRACE
+/** End of the last sweep, a touch seen by the next one came after it */
+static uint32_t sweepTime = 0;
+#endif
+
 /**************************************************************************//**
  * @brief A bit vector which represents the channels to iterate through
  * @param ACMP_CHANNELS Vector of channels.
@@ -79,8 +93,24 @@ static volatile uint32_t channelValues[ACMP_CHANNELS] = { 0, 0, 0, 0, 0, 0, 0, 0
  *****************************************************************************/
 static volatile uint32_t channelMaxValues[ACMP_CHANNELS] = { 1, 1, 1, 1, 1, 1, 1, 1 };
 
+/**************************************************************************//**
+ * @brief  This stores the maximum values as they are in the nvstore
+ * @param ACMP_CHANNELS Vector of channels. 0 = not stored
+ *****************************************************************************/
+static uint32_t channelStoredValues[ACMP_CHANNELS] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+
+/** Restored calibration has to be checked with the first scan */
+static bool calibrationCheck = false;
+
 /** @endcond */
 
+/** Restored calibration is valid if the first (untouched) scan is within
+ * -50% ... +12.5% of it */
+#define CAPSENSE_CHECK_LOW(max)		((max) >> 1)
+#define CAPSENSE_CHECK_HIGH(max)	((max) + ((max) >> 3))
+/** Store the calibration again if it has grown by more than 6.25% */
+#define CAPSENSE_STORE_STEP(max)	((max) >> 4)
+
 /**************************************************************************//**
  * @brief TIMER1 interrupt handler.
  *        When TIMER1 expires the number of pulses on TIMER1 is inserted into
@@ -204,6 +234,52 @@ int32_t CAPSENSE_getSliderPosition(void)
   return position;
 }
 
+/**************************************************************************//**
+ * @brief Check the restored calibration and store an improved calibration
+ *
+ * After the first scan the restored maximum values are compared with the
+ * measured values. If one channel is out of range, the restored calibration
+ * is discarded and a fresh calibration starts with the measured values.
+ * @n Later on, the calibration is stored whenever it has grown noticeably.
+ * The nvstore writes it to flash only every now and then.
+ *****************************************************************************/
+static void CAPSENSE_Calibration(void)
+{
+  uint8_t ch;
+
+  if (calibrationCheck)
+  {
+    calibrationCheck = false;
+    for (ch = 0; ch < ACMP_CHANNELS; ch++)
+    {
+      uint32_t stored = channelStoredValues[ch];
+      if (channelsInUse[ch]
+          && ((channelValues[ch] < CAPSENSE_CHECK_LOW(stored))
+              || (channelValues[ch] > CAPSENSE_CHECK_HIGH(stored))))
+      {
+        /* Restored calibration does not fit: start anew */
+        for (ch = 0; ch < ACMP_CHANNELS; ch++)
+        {
+          channelMaxValues[ch] = channelValues[ch] ? channelValues[ch] : 1;
+          channelStoredValues[ch] = 0;
+        }
+        break;
+      }
+    }
+  }
+
+  for (ch = 0; ch < ACMP_CHANNELS; ch++)
+  {
+    uint32_t max = channelMaxValues[ch];
+    if (channelsInUse[ch]
+        && (max > channelStoredValues[ch] + CAPSENSE_STORE_STEP(channelStoredValues[ch])))
+    {
+      channelStoredValues[ch] = max;
+      NV_Write(NV_KEY_CAPSENSE + ch, max);
+    }
+  }
+}
+
 /**************************************************************************//**
  * @brief This function iterates through all the capsensors and reads and
  *        initiates a reading. Uses EM1 while waiting for the result from
@@ -246,6 +322,17 @@ void CAPSENSE_Sense(void)
 
   /* Disable ACMP while not sensing to reduce power consumption */
   ACMP_Disable(ACMP_CAPSENSE);
+
+#ifdef LAT_TRACE
+  /* The sweep runs in the main loop, once per pass. A touch seen now
+   * happened after the previous sweep, so the latency is taken from there:
+   * an upper bound, by at most the time between two sweeps. */
+  uint32_t now = sl_sleeptimer_get_tick_count();
+  LAT_Input(LAT_TOUCH, sweepTime ? sweepTime : now);
+  sweepTime = now;
+#endif
+
+  CAPSENSE_Calibration();
 }
 
 /**************************************************************************//**
@@ -277,6 +364,30 @@ void CAPSENSE_Init(void)
   /* Set up ACMP1 in capsense mode */
   ACMP_CapsenseInit(ACMP_CAPSENSE, &capsenseInit);
 
+  /* Restore the calibration, it is checked with the first scan */
+  calibrationCheck = true;
+  for (uint8_t ch = 0; ch < ACMP_CHANNELS; ch++)
+  {
+    uint32_t stored = 0;
+    NV_Read(NV_KEY_CAPSENSE + ch, &stored);
+    if (channelsInUse[ch] && (0 == stored))
+    {
+      calibrationCheck = false;		// incomplete, calibrate from scratch
+    }
+    channelStoredValues[ch] = stored;
+  }
+  for (uint8_t ch = 0; ch < ACMP_CHANNELS; ch++)
+  {
+    if (calibrationCheck && channelsInUse[ch])
+    {
+      channelMaxValues[ch] = channelStoredValues[ch];
+    }
+    else
+    {
+      channelStoredValues[ch] = 0;
+    }
+  }
+
   /* Enable TIMER1 interrupt */
   NVIC_EnableIRQ(TIMER1_IRQn);
 
@@ -7,22 +7,109 @@
  * The user interface is implemented as a Finite State Machine.
  *
  * The <b>states</b> are:
- * @n WHITE, AMBER, RED, GREEN, BLUE, IDLE, STOP, START
+ * @n WHITE, AMBER, RED, GREEN, BLUE, CIRCADIAN, CCT, IDLE, STOP, START
+ *
+ * In state CIRCADIAN white and amber follow a daily curve (see circadian.c).
+ * The value of this state is the time of day as hhmm.
+ *
+ * In state CCT white, amber and red are blended to a colour temperature
+ * (see cct.c). The value of this state is the colour temperature in K.
+ * The touchslider selects the colour temperature,
+ * the pushbuttons the brightness in steps of CCT_BRIGHTNESS_STEP.
+ * Pressing a pushbutton beyond 0 % or 100 % leaves the state.
+ * Colour temperature and brightness are stored on their own,
+ * the stored set points keep the last colour set channel by channel.
  *
  * The <b>events</b> and <b>transitions</b> are:<dl>
  * <dt>Touchgecko pressed</dt>
- * <dd>Go to state START, initialize the system and switch to state IDLE.</dd>
+ * <dd>Go to state START, restore the stored set points and switch to state IDLE.</dd>
  * <dt>Touchslider touched</dt>
  * <dd>Adjust value of the currently active state.</dd>
+ * <dt>Pushbutton 0 or 1 pressed in state CCT</dt>
+ * <dd>Decrease or increase the brightness.</dd>
  * <dt>Pushbutton 0 pressed</dt>
  * <dd>Go one state to the right, wrap around from IDLE to WHITE.</dd>
  * <dt>Pushbutton 1 pressed</dt>
  * <dd>Go one state to the left, wrap around from WHITE to IDLE.</dd>
  * <dt>Remote command from serial interface received</dt>
- * <dd>The received string is parsed and the new state and value set accordingly.</dd>
+ * <dd>The received string is parsed and the new state and value set accordingly.
+ * @n The names of the commands have to match completely (see commands.c),
+ * unknown commands are answered with "err 1", invalid arguments with "err 2".
+ * @n "em 0", "em 1" or "em 2" is answered with the time in s spent
+ * in that energy mode (see energymode.c).
+ * @n "bcm" is answered with the measured interrupt load of the amber driver
+ * in 1/1000 (see bcm.c).
+ * @n "reg" is answered with the max core cycles of a current control step
+ * (see regulation.c).
+ * @n "cut 0", "cut 1" or "cut 2" is answered with the PWM periods with an ACMP0 edge,
+ * the number of PWM periods cut off in hardware
+ * and 1 if the routing matches its model (see powerLEDs.c).
+ * @n "pwm 2000" selects the RGB PWM frequency in Hz
+ * and is answered with the resulting number of PWM steps.
+ * @n "col FFC080" mixes a linear sRGB colour with all 5 LEDs (see colour.c)
+ * and is answered with the core cycles of the conversion.
+ * @n "cct 2700 40" selects 2700 K at 40 % brightness,
+ * the brightness may be omitted.
+ * @n "out" is answered with the core cycles of one set point update
+ * (micro-benchmark of the output layer, see powerLEDs.c).
+ * @n "drop" is answered with the number of commands lost
+ * because the queue was full (see commands.c).</dd>
  * </dl>
  * Any changes in state or value are reflected on the <b>display</b>
  * and also sent over the serial interface to the <b>remote control</b>.
+ * @n These notifications are rate-limited, only the latest value
+ * of each state is sent (see communication.c).
+ * "sub 0" turns them off, "sub 200" sends at most one every 200 ms,
+ * "sub" is answered with the current interval.
+ *
+ * "stream 40" starts a colour stream with 40 ms playout delay (see stream.c),
+ * the delay may be omitted. It is answered with the baud rate of the stream,
+ * then the link switches to it. After the stream the link is back
+ * at the normal baud rate.
+ * @n "jit 0" ... "jit 4" is answered with a counter of the last stream:
+ * frames, late frames, underruns, overruns and errors.
+ *
+ * Several lamps may share the serial line as a bus (see communication.c).
+ * "adr 3" and "grp 2" set the address and the group of a lamp,
+ * without argument they are answered with the current one.
+ * Address 0 is a single lamp without bus.
+ * @n On a bus the commands start with an address, e.g. ">3 red 80",
+ * ">g2 red 80" or ">* red 80" (see commands.c).
+ * Only commands to a single lamp are answered, the reply starts with
+ * the address of the lamp, e.g. "<3 @17 ok".
+ * The commands to a group or to all the lamps are never answered.
+ *
+ * The lamps follow the scene time of a master (see timesync.c),
+ * so they show the circadian curve in phase.
+ * ">* ts 123450" gives all the lamps the time of the master in 0.1 ms,
+ * e.g. of the day. "ts 123450" to a single lamp measures the delay
+ * of the link and is answered with the error of the scene time in us,
+ * e.g. "ts -120". The next one to the same lamp also gives the time
+ * the master received this reply, e.g. "ts 133450 123570".
+ * @n "tsq 0" ... "tsq 5" is answered with the error in us,
+ * the drift in ppb, the delay of the link in us, the samples, the outliers
+ * and the times the scene time has been set anew.
+ *
+ * "lat 0 0" ... "lat 0 6" is answered with the latency of the state commands
+ * from the end of their line until the new value has been written
+ * to the LED driver (see latency.c): the samples, min, average,
+ * 50th, 90th and 99th percentile and max in us.
+ * "lat 1 i", "lat 2 i" and "lat 3 i" give the same for the touch slider,
+ * the pushbuttons (brightness in CCT) and a clap switching the lamp,
+ * from the interrupt of the input.
+ * @n The slider has no interrupt, it is swept once per main loop pass.
+ * Its latency is taken from the end of the sweep before the one that saw
+ * the touch, so it is an upper bound: the touch came up to one pass
+ * later (see touchslider.c).
+ * "lat 0" ... "lat 3" is answered with the samples and clears them.
+ * Without LAT_TRACE (see latency.h) "lat" is an unknown command.
+ *
+ * Any command may start with a request id 0 ... 65535, e.g. "@17 red 80".
+ * It is answered with exactly one reply starting with the same id,
+ * e.g. "@17 ok", "@18 reg 312" or "@19 err 2".
+ * Commands are executed in order, so up to CMD_WINDOW requests
+ * may be in flight and matched by their id.
+ * Notifications never carry an id.
  *
  * Prefix: UI
  *
@@ -34,6 +121,7 @@
 #include <string.h>
 
 #include "em_emu.h"
+#include "em_core.h"
 
 #include "segmentlcd.h"
 
@@ -43,6 +131,19 @@
 #include "touchslider.h"
 #include "communication.h"
 #include "powerLEDs.h"
+#include "circadian.h"
+#include "nvstore.h"
+#include "energymode.h"
+#include "bcm.h"
+#include "regulation.h"
+#include "colour.h"
+#include "cct.h"
+#include "commands.h"
+#include "stream.h"
+#include "timesync.h"
+#include "latency.h"
+
+#include "sl_sleeptimer.h"
 
 
 /******************************************************************************
@@ -50,20 +151,34 @@
  *****************************************************************************/
 
 /** @todo Adjust number of user interface states. */
-#define UI_STATE_COUNT		7				///< number of FSM states
+#define UI_STATE_COUNT		9				///< number of FSM states
 
 /** @todo Adjust display and remote control text of user interface states. */
 char * UI_text[UI_STATE_COUNT] = {
-		"white", "amber", "red", "green", "blue", "idle", "start"
+		"white", "amber", "red", "green", "blue", "circadian", "cct", "idle", "start"
 }; ///< text for display and remote control
 
 
-/** @todo Adjusting required? */
-#define UI_TEXT_COMPARE_LENGTH	3			///< compare first x chars of string
-// Must be long enough to distinguish all the texts
-// and not longer than the shortest text.
-
-#define UI_DELAY 			10000	///< user interface delay (in TIMER0 ticks)
+#define UI_EMM_COMMAND		"em"	///< query residency in energy mode, e.g. "em 2"
+#define UI_BCM_COMMAND		"bcm"	///< query ISR load of the BCM driver in 1/1000
+#define UI_REG_COMMAND		"reg"	///< query cycles of a current control step
+#define UI_CUT_COMMAND		"cut"	///< query diagnostics of the current cut-off
+#define UI_PWM_COMMAND		"pwm"	///< select PWM frequency of RGB, e.g. "pwm 2000"
+#define UI_COL_COMMAND		"col"	///< mix a colour, e.g. "col FFC080"
+#define UI_CCT_COMMAND		"cct"	///< colour temperature, e.g. "cct 2700 40"
+#define UI_OUT_COMMAND		"out"	///< query cycles of a set point update
+#define UI_SUB_COMMAND		"sub"	///< interval of notifications, e.g. "sub 200"
+#define UI_STREAM_COMMAND	"stream"	///< start a colour stream, e.g. "stream 40"
+#define UI_JIT_COMMAND		"jit"	///< query a counter of the stream, e.g. "jit 1"
+#define UI_ADR_COMMAND		"adr"	///< address on the bus, e.g. "adr 3"
+#define UI_GRP_COMMAND		"grp"	///< group on the bus, e.g. "grp 2"
+#define UI_TS_COMMAND		"ts"	///< time of the master, e.g. "ts 123450"
+#define UI_TSQ_COMMAND		"tsq"	///< query the time sync, e.g. "tsq 1"
+#define UI_DROP_COMMAND		"drop"	///< query the commands dropped
+#define UI_LAT_COMMAND		"lat"	///< query the latency to the light, e.g. "lat 0 5"
+#define UI_ADDRESS_MARK		'<'		///< start of a reply on the bus, e.g. "<3 ok"
+#define UI_ERR_REPLY		"err"	///< answer to an invalid command, e.g. "err 1"
+#define UI_OK_REPLY			"ok"	///< answer to a request without value, e.g. "@17 ok"
 
 
 /******************************************************************************
@@ -73,6 +188,7 @@ char * UI_text[UI_STATE_COUNT] = {
 /** @todo Adjust enum names of user interface states. */
 typedef enum {								///< enum with the FSM states
 	WHITE = 0, AMBER, RED, GREEN, BLUE,		// colours
+	CIRCADIAN, CCT,							// modes
 	IDLE, START								// special states
 } UI_state_t;								// count must be = UI_STATE_COUNT
 
@@ -82,6 +198,13 @@ bool UI_state_changed = true;				///< state transition of the FSM
 static int32_t UI_value_current = 0;		///< current value (if applicable)
 int32_t UI_value_next = 0;					///< next value (if applicable)
 bool UI_value_changed = true;				///< value changed
+#ifdef LAT_TRACE
+static uint32_t UI_value_source = LAT_SOURCE_COUNT;	///< input of the new value
+static uint32_t UI_value_stamp = 0;			///< time of that input in ticks
+#endif
+
+static const CMD_command_t *UI_request = NULL;	///< remote command being executed
+static bool UI_request_answered = false;	///< a reply has been sent to it
 
 
 /******************************************************************************
@@ -89,6 +212,22 @@ bool UI_value_changed = true;				///< value changed
  *****************************************************************************/
 
 
+/** **************************************************************************
+ * @brief Remember the input of the new value for UI_arm_latency()
+ * @param [in] source LAT_source_t, LAT_SOURCE_COUNT = none
+ * @param [in] stamp time of the input in ticks
+ *****************************************************************************/
+static inline void UI_trace_value(uint32_t source, uint32_t stamp) {
+#ifdef LAT_TRACE
+	UI_value_source = source;
+	UI_value_stamp = stamp;
+#else
+	(void)source;
+	(void)stamp;
+#endif
+}
+
+
 /** **************************************************************************
  * @brief Part of the user interface finite state machine: Touch events
  *
@@ -106,9 +245,21 @@ void UI_FSM_event_Touch(void) {
 		UI_value_next = CAPSENSE_getSliderValue(0, PWR_VALUE_MAX);	// read value
 		if (touchsliderFlag) {				// touchslider touched?
 			UI_value_changed = true;
+			UI_trace_value(LAT_TOUCH, LAT_InputTime(LAT_TOUCH));
 			touchsliderFlag = false;		// reset the flag
 		}
 		break;
+	case CCT:
+		/* Touchslider selects the colour temperature */
+		UI_value_next = CAPSENSE_getSliderValue(CCT_KELVIN_MIN, CCT_KELVIN_MAX);
+		if (touchsliderFlag) {				// touchslider touched?
+			UI_value_changed = true;
+			UI_trace_value(LAT_TOUCH, LAT_InputTime(LAT_TOUCH));
+			touchsliderFlag = false;		// reset the flag
+		} else {
+			UI_value_next = CCT_GetKelvin();	// keep the current value
+		}
+		break;
 	default:								// no value to change in other states
 		;
 	}
@@ -136,10 +287,21 @@ void UI_FSM_event_Pushbutton(void) {
 		case RED:
 		case GREEN:
 		case BLUE:
+		case CIRCADIAN:
 			UI_state_next--;
 			break;
+		case CCT:							// darker, leave the state below 0 %
+			if (CCT_GetBrightness() > 0) {
+				CCT_SetBrightness(CCT_GetBrightness() - CCT_BRIGHTNESS_STEP);
+				UI_value_next = CCT_GetKelvin();
+				UI_value_changed = true;
+				UI_trace_value(LAT_BUTTON, LAT_InputTime(LAT_BUTTON));
+			} else {
+				UI_state_next--;
+			}
+			break;
 		case IDLE:
-			UI_state_next = BLUE;
+			UI_state_next = CCT;
 			break;
 		default:
 			;
@@ -154,10 +316,19 @@ void UI_FSM_event_Pushbutton(void) {
 		case AMBER:
 		case RED:
 		case GREEN:
+		case BLUE:
+		case CIRCADIAN:
 			UI_state_next++;
 			break;
-		case BLUE:
-			UI_state_next = IDLE;
+		case CCT:							// brighter, leave the state above 100 %
+			if (CCT_GetBrightness() < CCT_BRIGHTNESS_MAX) {
+				CCT_SetBrightness(CCT_GetBrightness() + CCT_BRIGHTNESS_STEP);
+				UI_value_next = CCT_GetKelvin();
+				UI_value_changed = true;
+				UI_trace_value(LAT_BUTTON, LAT_InputTime(LAT_BUTTON));
+			} else {
+				UI_state_next = IDLE;
+			}
 			break;
 		case IDLE:
 			UI_state_next = WHITE;
@@ -170,45 +341,446 @@ void UI_FSM_event_Pushbutton(void) {
 	}
 }
 
+/** **************************************************************************
+ * @brief Append a text and a value for the remote control
+ * @param [in,out] message string to append to, e.g. "" gives "white 100"
+ * @param [in] text e.g. the name of the state
+ * @param [in] value to send after a ' '
+ *****************************************************************************/
+static void UI_format_text_value(char message[COM_BUF_SIZE], const char *text,
+		int32_t value) {
+	char value_string[COM_BUF_SIZE];
+	ltostr(value, value_string);			// convert number to string
+	strncat(message, text, COM_BUF_SIZE - 1 - strlen(message));
+	strncat(message, " ", COM_BUF_SIZE - 1 - strlen(message));
+	strncat(message, value_string, COM_BUF_SIZE - 1 - strlen(message));
+}
+
+
+/** **************************************************************************
+ * @brief Start a reply with the address and the request id
+ * @param [out] message e.g. "<3 @17 " on a bus, "@17 " without a bus,
+ * "" if the command has no request id
+ *****************************************************************************/
+static void UI_format_request(char message[COM_BUF_SIZE]) {
+	message[0] = '\0';
+	if (COM_GetAddress()) {
+		message[0] = UI_ADDRESS_MARK;
+		ltostr(COM_GetAddress(), message + 1);
+		strcat(message, " ");
+	}
+	if ((NULL != UI_request) && UI_request->tagged) {
+		char *tag = message + strlen(message);
+		tag[0] = CMD_TAG_MARK;
+		ltostr(UI_request->tag, tag + 1);
+		strcat(message, " ");
+	}
+	UI_request_answered = true;
+}
+
+
+/** **************************************************************************
+ * @brief Send a text and a value to the remote control as a reply
+ * @param [in] text e.g. the name of the command
+ * @param [in] value to send after a ' '
+ *
+ * The request id of the command being executed is echoed, e.g. "@17 reg 312".
+ * @n Not sent, if the command was sent to a group or to all the lamps.
+ *****************************************************************************/
+static void UI_send_text_value(const char *text, int32_t value) {
+	if ((NULL != UI_request) && UI_request->silent) {
+		return;
+	}
+	char message[COM_BUF_SIZE];
+	UI_format_request(message);
+	UI_format_text_value(message, text, value);
+	COM_TX_PutData(message, COM_BUF_SIZE);	// send the string
+}
+
+
+/** **************************************************************************
+ * @brief Measure the way of the new value to the light (see latency.c)
+ *
+ * Called right before the value is written to the power LEDs.
+ * @n With interrupts off as the clap in lightOnOrOff(),
+ * TIMER0_IRQHandler() stages and commits the samples.
+ *****************************************************************************/
+static inline void UI_arm_latency(void) {
+#ifdef LAT_TRACE
+	if (UI_value_source < LAT_SOURCE_COUNT) {
+		CORE_DECLARE_IRQ_STATE;
+		CORE_ENTER_CRITICAL();
+		LAT_Arm(UI_value_source, UI_value_stamp);
+		CORE_EXIT_CRITICAL();
+	}
+#endif
+}
+
+
+/** **************************************************************************
+ * @brief Set the power LEDs for the colour temperature and brightness
+ *
+ * Colour temperature and brightness are stored, not the set points,
+ * which keep the last colour of the lamp.
+ *****************************************************************************/
+static void UI_apply_cct(void) {
+	int32_t value[PWR_SOLUTION_COUNT];
+	CCT_Mix(value);
+	for (uint32_t solution = 0; solution < PWR_SOLUTION_COUNT; solution++) {
+		PWR_set_value(solution, value[solution]);
+	}
+	NV_Write(NV_KEY_CCT_KELVIN, CCT_GetKelvin());	// only written if changed
+	NV_Write(NV_KEY_CCT_BRIGHTNESS, CCT_GetBrightness());
+}
+
+
+/** **************************************************************************
+ * @brief Remote command: switch to a state and optionally set its value
+ * @param [in] command e.g. "white 100", the states come first in commands.txt
+ * @return CMD_OK
+ *****************************************************************************/
+static int32_t UI_cmd_state(const CMD_command_t *command) {
+	if (command->argc > 0) {				// a value has been sent
+		UI_value_next = command->arg[0];
+		UI_value_changed = true;			// set the value changed flag
+		UI_trace_value(LAT_REMOTE, command->received);
+	}
+	UI_state_next = (UI_state_t)(command->id - CMD_WHITE);	// change to that state
+	UI_state_changed = true;				// set the state changed flag
+	return CMD_OK;
+}
+
+
+/** **************************************************************************
+ * @brief Remote command: residency in an energy mode, e.g. "em 2"
+ * @param [in] command with mode 0 = EM0, 1 = EM1, 2 = EM2
+ * @return CMD_OK or CMD_ERR_ARGUMENT
+ *
+ * The answer is e.g. "em2 3600" for 3600 s in EM2.
+ *****************************************************************************/
+static int32_t UI_cmd_em(const CMD_command_t *command) {
+	int32_t mode = command->arg[0];
+	char text[] = UI_EMM_COMMAND "0";
+	if ((mode < 0) || (mode >= EMM_MODE_COUNT)) {
+		return CMD_ERR_ARGUMENT;			// no such mode
+	}
+	text[sizeof(UI_EMM_COMMAND) - 1] += mode;
+	UI_send_text_value(text, EMM_GetResidency(mode));
+	return CMD_OK;
+}
+
+
+/** **************************************************************************
+ * @brief Remote command: query a diagnostic value without argument
+ * @param [in] command bcm, reg or out
+ * @return CMD_OK
+ *****************************************************************************/
+static int32_t UI_cmd_query(const CMD_command_t *command) {
+	switch (command->id) {
+	case CMD_BCM:							// interrupt load of the amber BCM driver
+		UI_send_text_value(UI_BCM_COMMAND, BCM_GetLoad());
+		break;
+	case CMD_REG:							// CPU time of the current regulation
+		UI_send_text_value(UI_REG_COMMAND, REG_GetCycles());
+		break;
+	case CMD_OUT:							// micro-benchmark of the set point update
+		UI_send_text_value(UI_OUT_COMMAND, PWR_benchmark());
+		break;
+	case CMD_DROP:							// commands lost, the queue was full
+		UI_send_text_value(UI_DROP_COMMAND, CMD_GetDropped());
+		break;
+	default:
+		;
+	}
+	return CMD_OK;
+}
+
+
+/** **************************************************************************
+ * @brief Remote command: diagnostics of the hardware current cut-off
+ * @param [in] command with index 0 ... PWR_CUTOFF_COUNTER_COUNT-1,
+ * see PWR_cutoff_diagnostics()
+ * @return CMD_OK or CMD_ERR_ARGUMENT
+ *****************************************************************************/
+static int32_t UI_cmd_cut(const CMD_command_t *command) {
+	if ((command->arg[0] < 0) || (command->arg[0] >= PWR_CUTOFF_COUNTER_COUNT)) {
+		return CMD_ERR_ARGUMENT;
+	}
+	UI_send_text_value(UI_CUT_COMMAND, PWR_cutoff_diagnostics(command->arg[0]));
+	return CMD_OK;
+}
+
+
+/** **************************************************************************
+ * @brief Remote command: select the PWM frequency, answer with the resolution
+ * @param [in] command with the frequency in Hz
+ * @return CMD_OK or CMD_ERR_ARGUMENT
+ *****************************************************************************/
+static int32_t UI_cmd_pwm(const CMD_command_t *command) {
+	int32_t frequency = command->arg[0];
+	if (frequency < 0) {
+		return CMD_ERR_ARGUMENT;
+	}
+	UI_send_text_value(UI_PWM_COMMAND, PWR_set_frequency(frequency));
+	return CMD_OK;
+}
+
+
+/** **************************************************************************
+ * @brief Remote command: mix a colour, answer with the cycles needed
+ * @param [in] command with the linear sRGB colour as hex RRGGBB
+ * @return CMD_OK
+ *****************************************************************************/
+static int32_t UI_cmd_col(const CMD_command_t *command) {
+	int32_t value[PWR_SOLUTION_COUNT];
+	uint32_t start = G_Cycles();
+	COL_Mix(command->arg[0], PWR_VALUE_MAX, value);
+	uint32_t cycles = G_Cycles() - start;
+	for (uint32_t solution = 0; solution < PWR_SOLUTION_COUNT; solution++) {
+		PWR_set_value(solution, value[solution]);
+		NV_Write(NV_KEY_PWR_VALUE + solution, PWR_get_value(solution));
+	}
+	UI_send_text_value(UI_COL_COMMAND, cycles);
+	return CMD_OK;
+}
+
+
+/** **************************************************************************
+ * @brief Remote command: colour temperature with an optional brightness
+ * @param [in] command e.g. "cct 2700 40", "cct 2700" or "cct"
+ * @return CMD_OK
+ *****************************************************************************/
+static int32_t UI_cmd_cct(const CMD_command_t *command) {
+	if (command->argc > 1) {				// followed by the brightness
+		CCT_SetBrightness(command->arg[1]);
+	}
+	return UI_cmd_state(command);			// colour temperature is the value
+}
+
+
+/** **************************************************************************
+ * @brief Remote command: subscribe to the notifications of state changes
+ * @param [in] command with the min interval in ms, 0 = off, or without argument
+ * @return CMD_OK or CMD_ERR_ARGUMENT
+ *
+ * The answer is the interval in effect, e.g. "sub 100".
+ *****************************************************************************/
+static int32_t UI_cmd_sub(const CMD_command_t *command) {
+	if (command->argc > 0) {
+		if (command->arg[0] < 0) {
+			return CMD_ERR_ARGUMENT;
+		}
+		COM_Subscribe(command->arg[0]);
+	}
+	UI_send_text_value(UI_SUB_COMMAND, COM_GetSubscription());
+	return CMD_OK;
+}
+
+
+/** **************************************************************************
+ * @brief Remote command: start a colour stream
+ * @param [in] command with the playout delay in ms or without argument
+ * @return CMD_OK or CMD_ERR_ARGUMENT
+ *
+ * The answer is the baud rate of the stream, e.g. "stream 115200",
+ * it is sent before the link switches.
+ *****************************************************************************/
+static int32_t UI_cmd_stream(const CMD_command_t *command) {
+	int32_t delay = STR_DELAY_MS;
+	if (command->argc > 0) {
+		delay = command->arg[0];
+		if ((delay < 0) || (delay > STR_DELAY_MAX_MS)) {
+			return CMD_ERR_ARGUMENT;
+		}
+	}
+	UI_send_text_value(UI_STREAM_COMMAND, COM_STREAM_BAUDRATE);
+	STR_Start(delay, sl_sleeptimer_get_tick_count());
+	COM_Stream();
+	return CMD_OK;
+}
+
+
+/** **************************************************************************
+ * @brief Remote command: query a counter of the colour stream
+ * @param [in] command with the counter 0 ... STR_COUNTER_COUNT-1
+ * @return CMD_OK or CMD_ERR_ARGUMENT
+ *****************************************************************************/
+static int32_t UI_cmd_jit(const CMD_command_t *command) {
+	if ((command->arg[0] < 0) || (command->arg[0] >= STR_COUNTER_COUNT)) {
+		return CMD_ERR_ARGUMENT;
+	}
+	UI_send_text_value(UI_JIT_COMMAND, STR_GetCounter(command->arg[0]));
+	return CMD_OK;
+}
+
+
+/** **************************************************************************
+ * @brief Remote command: set or query the address or the group on the bus
+ * @param [in] command adr or grp, with the new one or without argument
+ * @return CMD_OK or CMD_ERR_ARGUMENT
+ *
+ * The answer is the one in effect, e.g. "<3 adr 3" (stored in the flash).
+ * @n An address to a group or to all the lamps is refused,
+ * they would all get the same one.
+ *****************************************************************************/
+static int32_t UI_cmd_address(const CMD_command_t *command) {
+	int32_t address = COM_GetAddress();
+	int32_t group = COM_GetGroup();
+	if ((CMD_ADR == command->id) && (command->argc > 0) && command->silent) {
+		return CMD_ERR_ARGUMENT;
+	}
+	if (command->argc > 0) {
+		if (CMD_ADR == command->id) {
+			address = command->arg[0];
+		} else {
+			group = command->arg[0];
+		}
+		if (!COM_SetAddress(address, group)) {
+			return CMD_ERR_ARGUMENT;
+		}
+	}
+	if (CMD_ADR == command->id) {
+		UI_send_text_value(UI_ADR_COMMAND, address);
+	} else {
+		UI_send_text_value(UI_GRP_COMMAND, group);
+	}
+	return CMD_OK;
+}
+
+
+/** **************************************************************************
+ * @brief Remote command: time of the master for the scene time
+ * @param [in] command with the time of the master in 0.1 ms
+ * and the time it received the last reply of this command
+ * @return CMD_OK
+ *
+ * The reply is stamped when it has been sent, so the next request
+ * completes the exchange (see timesync.c).
+ * A request to a group or to all is a sample of the time only.
+ *****************************************************************************/
+static int32_t UI_cmd_ts(const CMD_command_t *command) {
+	uint32_t sent;
+	if ((command->argc > 1) && COM_TX_GetStamp(&sent)) {
+		TS_Response(sent, command->arg[1]);
+	}
+	TS_Request(command->arg[0], command->received, !command->silent);
+	if (!command->silent) {
+		COM_TX_Stamp();
+		UI_send_text_value(UI_TS_COMMAND, TS_GetInfo(TS_ERROR_US));
+	}
+	return CMD_OK;
+}
+
+
+/** **************************************************************************
+ * @brief Remote command: query the synchronisation of the scene time
+ * @param [in] command with the information 0 ... TS_INFO_COUNT-1
+ * @return CMD_OK or CMD_ERR_ARGUMENT
+ *****************************************************************************/
+static int32_t UI_cmd_tsq(const CMD_command_t *command) {
+	if ((command->arg[0] < 0) || (command->arg[0] >= TS_INFO_COUNT)) {
+		return CMD_ERR_ARGUMENT;
+	}
+	UI_send_text_value(UI_TSQ_COMMAND, TS_GetInfo(command->arg[0]));
+	return CMD_OK;
+}
+
+
+/** **************************************************************************
+ * @brief Remote command: query the latency from an input to the light
+ * @param [in] command with the input 0 ... LAT_SOURCE_COUNT-1
+ *             and the information 0 ... LAT_INFO_COUNT-1
+ * @return CMD_OK or CMD_ERR_ARGUMENT, CMD_ERR_UNKNOWN without LAT_TRACE
+ *
+ * Without the information the samples are counted and cleared,
+ * e.g. "lat 0" before and after a measurement.
+ *****************************************************************************/
+static int32_t UI_cmd_lat(const CMD_command_t *command) {
+#ifndef LAT_TRACE
+	(void)command;
+	return CMD_ERR_UNKNOWN;					// compiled out
+#else
+	uint32_t source = command->arg[0];
+	if (source >= LAT_SOURCE_COUNT) {
+		return CMD_ERR_ARGUMENT;
+	}
+	if (command->argc < 2) {
+		UI_send_text_value(UI_LAT_COMMAND, LAT_GetInfo(source, LAT_COUNT));
+		LAT_Reset(source);
+		return CMD_OK;
+	}
+	if ((uint32_t)command->arg[1] >= LAT_INFO_COUNT) {
+		return CMD_ERR_ARGUMENT;
+	}
+	UI_send_text_value(UI_LAT_COMMAND, LAT_GetInfo(source, command->arg[1]));
+	return CMD_OK;
+#endif
+}
+
+
+/** Handlers of the remote commands, indexed by the id (see commands.txt) */
+static const CMD_handler_t UI_command[CMD_COUNT] = {
+	[CMD_WHITE] = UI_cmd_state,
+	[CMD_AMBER] = UI_cmd_state,
+	[CMD_RED] = UI_cmd_state,
+	[CMD_GREEN] = UI_cmd_state,
+	[CMD_BLUE] = UI_cmd_state,
+	[CMD_CIRCADIAN] = UI_cmd_state,
+	[CMD_CCT] = UI_cmd_cct,
+	[CMD_IDLE] = UI_cmd_state,
+	[CMD_START] = UI_cmd_state,
+	[CMD_EM] = UI_cmd_em,
+	[CMD_BCM] = UI_cmd_query,
+	[CMD_REG] = UI_cmd_query,
+	[CMD_CUT] = UI_cmd_cut,
+	[CMD_PWM] = UI_cmd_pwm,
+	[CMD_COL] = UI_cmd_col,
+	[CMD_OUT] = UI_cmd_query,
+	[CMD_SUB] = UI_cmd_sub,
+	[CMD_STREAM] = UI_cmd_stream,
+	[CMD_JIT] = UI_cmd_jit,
+	[CMD_ADR] = UI_cmd_address,
+	[CMD_GRP] = UI_cmd_address,
+	[CMD_TS] = UI_cmd_ts,
+	[CMD_TSQ] = UI_cmd_tsq,
+	[CMD_DROP] = UI_cmd_query,
+	[CMD_LAT] = UI_cmd_lat,
+};
+
+
 /** **************************************************************************
  * @brief Part of the user interface finite state machine: Remote control events
  *
- * If a string is available from the serial interface read and analyze it.
- * @n The core is a parser which analyzes the received command string.
- * @n It extracts the state and the value (if any).
- * The value is separated by a ' ' from the state.
- * @n There are 3 possible outcomes:
- * @n - No valid state is recognized
- * => nothing happens
- * @n - A valid state is recognized, but no valid value
- * => switch to that state, don't change the value
- * @n - Valid state and value received
- * => switch to that state and change the value
+ * If a command has been received from the serial interface execute it.
+ * @n The command has already been parsed while it was received
+ * (see commands.c), the handler gets the validated arguments.
+ * A state command without a value switches to that state,
+ * with a value also changes the value.
+ * @n Unknown commands and invalid arguments are answered
+ * with "err 1" and "err 2" respectively, nothing else happens.
+ *
+ * Queued commands are executed in order until one changes the state
+ * or the value, the FSM has to handle that one first.
+ * So a client may pipeline up to CMD_WINDOW commands.
+ * @n A command with a request id gets exactly one reply echoing the id:
+ * its answer, "@17 ok" or "@17 err 2".
  *****************************************************************************/
 void UI_FSM_event_RemoteControl(void) {
-	char command[COM_BUF_SIZE] = "";		// receive buffer
-	if (COM_RX_Available()) {				// check for a new command string
-		COM_RX_GetData(command, COM_BUF_SIZE);
-		/* loop through all valid states to check if one matches */
-		for (uint32_t state = 0; state < UI_STATE_COUNT; state++) {	// loop through states
-			/* check if the command contains a valid state */
-			if (0 == strncmp(UI_text[state], command, UI_TEXT_COMPARE_LENGTH)) {
-				UI_state_next = state;		// change to that state
-				/* check if the command contains a valid number */
-				char *pos, *end;	// temporary variables for char position and end
-				/* the number (if any) is separated by a ' ' from the state */
-				pos = strchr(command, ' ');	// so look for a ' '
-				if (pos) {					// a ' ' has been found
-					/* try to convert the remainder of the command into a number */
-					int32_t number = strtol(pos, &end, 10);	// convert, base 10
-					if ('\0' == *end) {		// conversion was successful
-						UI_value_next = number;
-						UI_value_changed = true;	// set the value changed flag
-					}
-				}
-			}
+	CMD_command_t command;
+	while (!UI_state_changed && !UI_value_changed
+			&& CMD_Get(&command)) {			// check for a new command
+		UI_request = &command;
+		UI_request_answered = false;
+		int32_t error = CMD_Execute(&command, UI_command);
+		if (CMD_OK != error) {
+			UI_send_text_value(UI_ERR_REPLY, error);
+		} else if (command.tagged && !command.silent && !UI_request_answered) {
+			char message[COM_BUF_SIZE];
+			UI_format_request(message);
+			strcat(message, UI_OK_REPLY);
+			COM_TX_PutData(message, COM_BUF_SIZE);	// acknowledge
 		}
-		UI_state_changed = true;			// set the state changed flag
+		UI_request = NULL;
 	}
 }
 
@@ -225,6 +797,22 @@ void UI_FSM_event(void) {
 }
 
 
+/** **************************************************************************
+ * @brief Display state and value and send them to the remote control
+ * @param [in] state to display and send
+ * @param [in] value to display and send
+ *****************************************************************************/
+void UI_show_state_value(UI_state_t state, int32_t value) {
+	/* display state and value */
+	SegmentLCD_Write(UI_text[state]);
+	SegmentLCD_Number(value);
+	/* notify the remote control, only the latest value of a state is sent */
+	char message[COM_BUF_SIZE] = "";
+	UI_format_text_value(message, UI_text[state], value);
+	COM_TX_Notify(state, message);
+}
+
+
 /** **************************************************************************
  * @brief User interface finite state machine: Handled the events
  *
@@ -241,12 +829,33 @@ void UI_FSM_state_value(void) {
 		case RED:
 		case GREEN:
 		case BLUE:
+			UI_arm_latency();
 			PWR_set_value(UI_state_next, UI_value_next);
+			NV_Write(NV_KEY_PWR_VALUE + UI_state_next, PWR_get_value(UI_state_next));
+			break;
+		case CIRCADIAN:
+			CIRC_SetClock(UI_value_next);	// value is the time of day
+			break;
+		case CCT:
+			CCT_SetKelvin(UI_value_next);	// value is the colour temperature
+			UI_arm_latency();
+			UI_apply_cct();
 			break;
 		default:
 			;
 		}
 	}
+	/* start or stop following the daily curve */
+	if (UI_state_changed) {
+		if (CIRCADIAN == UI_state_next) {
+			CIRC_Start();
+		} else {
+			CIRC_Stop();
+		}
+		if ((CCT == UI_state_next) && (CCT != UI_state_current)) {
+			UI_apply_cct();					// blend as soon as the state is entered
+		}
+	}
 	/* display new state and value and send this infos also to the remote control */
 	if (UI_state_changed || UI_value_changed) {
 		switch (UI_state_next) {
@@ -256,25 +865,23 @@ void UI_FSM_state_value(void) {
 		case GREEN:
 		case BLUE:
 			UI_value_next = PWR_get_value(UI_state_next);	// get the actual value
-			/* display state and value */
-			SegmentLCD_Write(UI_text[UI_state_next]);
-			SegmentLCD_Number(UI_value_next);
-			/* send state and value to the remote control over the serial interface */
-			char value_string[COM_BUF_SIZE];
-			char message[COM_BUF_SIZE];
-			ltostr(UI_value_next, value_string);	// convert number to string
-			strncpy(message, UI_text[UI_state_next], COM_BUF_SIZE);
-			strncat(message, " ", COM_BUF_SIZE);
-			strncat(message, value_string, COM_BUF_SIZE);
-			COM_TX_PutData(message, COM_BUF_SIZE);	// send the string
+			UI_show_state_value(UI_state_next, UI_value_next);
+			break;
+		case CIRCADIAN:
+			UI_value_next = CIRC_GetClock();	// get the actual time of day
+			UI_show_state_value(UI_state_next, UI_value_next);
+			break;
+		case CCT:
+			UI_value_next = CCT_GetKelvin();	// get the limited value
+			UI_show_state_value(UI_state_next, UI_value_next);
 			break;
 		case IDLE:
 		case START:
 			/* display state, blank display for value*/
 			SegmentLCD_Write(UI_text[UI_state_next]);
 			SegmentLCD_NumberOff();
-			/* send state to the remote control over the serial interface */
-			COM_TX_PutData(UI_text[UI_state_next], COM_BUF_SIZE);
+			/* notify the remote control of the state */
+			COM_TX_Notify(UI_state_next, UI_text[UI_state_next]);
 			break;
 		default:
 			;
@@ -285,19 +892,25 @@ void UI_FSM_state_value(void) {
 	UI_state_changed = false;
 	UI_value_current = UI_value_next;
 	UI_value_changed = false;
+	UI_trace_value(LAT_SOURCE_COUNT, 0);
 
-	/* delay for UI scan and update */
-	// RTCDRV_Delay(UI_delay, false);	// can't be used as this stops TIMER0 for about 2ms
-	for (uint32_t delay = 0; delay < UI_DELAY; delay++) {
-		/** @todo Adjust UI_DELAY to get a sensible responsiveness.
-		 * If a timer interrupt is activated, uncomment the following line. */
-		// EMU_EnterEM1();			// wakes up on an interrupt (mostly a timer)
+	/* follow the daily curve, updates are due only every now and then */
+	int32_t white, amber;
+	if ((CIRCADIAN == UI_state_current) && CIRC_Update(&white, &amber)) {
+		PWR_set_value(WHITE, white);
+		PWR_set_value(AMBER, amber);
+		SegmentLCD_Number(CIRC_GetClock());
 	}
 
+	/* wait for the next UI scan in the deepest legal energy mode */
+	EMM_Sleep();
+
 	/* treat START and STOP specifically */
 	if (START == UI_state_current){
 		for (uint32_t solution = 0; solution < PWR_SOLUTION_COUNT; solution++) {
-			PWR_set_value(solution, PWR_START_VALUE);
+			uint32_t value = PWR_START_VALUE;
+			NV_Read(NV_KEY_PWR_VALUE + solution, &value);	// last stored set point
+			PWR_set_value(solution, value);
 		}
 		UI_state_next = IDLE;
 		UI_state_changed = true;
@@ -0,0 +1,353 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host tool: several lamps on a virtual bus
+ *
+ * Starts a number of lamps as processes, each with the command parser
+ * of the firmware (src/commands.c) and its own address,
+ * and connects them to a master through a virtual bus:
+ * every line of the master reaches all the lamps,
+ * the answers of all the lamps reach the master.
+ * @n The lamps answer like the firmware (see userinterface.c),
+ * but only keep the set points instead of driving LEDs.
+ *
+ * The master sends a fixed sequence: commands to all the lamps,
+ * to groups, without address and to single lamps, and polls each lamp.
+ * Each step is checked: who answered, what was answered,
+ * and whether two lamps answered at the same time (collision).
+ * An address sent to all the lamps or to a group must be refused,
+ * otherwise they would share it.
+ * At the end the set points of all the lamps are checked.
+ *
+ * Usage (on the PC, not on the target):
+ * @n gcc -I../src/inc -o bussim bussim.c ../src/commands.c
+ * @n ./bussim [lamps] [-v]
+ *
+ * The lamps get the addresses 1 ... lamps,
+ * the odd ones group 1, the even ones group 2.
+ * -v prints all the lines on the bus.
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#define _DEFAULT_SOURCE
+
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "commands.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define END_OF_STRING		'\r'			///< COM_END_OF_STRING of the firmware
+#define LINE_LENGTH			64				///< max length of a line
+#define LAMP_MAX			32				///< max number of lamps
+#define ANSWER_WINDOW_MS	50				///< the master waits this long per line
+#define VALUE_COUNT			5				///< white, amber, red, green, blue
+
+/** A lamp as seen by the master */
+typedef struct {
+	pid_t pid;
+	int rx;									///< master -> lamp
+	int tx;									///< lamp -> master
+	int group;
+	int value[VALUE_COUNT];					///< expected set points
+} lamp_t;
+
+static lamp_t lamp[LAMP_MAX];
+static int lamp_count = 6;
+static int verbose = 0;
+static int failures = 0;
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Send a reply of a lamp like UI_send_text_value()
+ * @param [in] command being answered
+ * @param [in] address of the lamp
+ * @param [in] text and value, value < 0 = text only
+ *****************************************************************************/
+static void lamp_reply(const CMD_command_t *command, int address,
+		const char *text, long value) {
+	if (command->silent) {
+		return;
+	}
+	char line[LINE_LENGTH];
+	int n = 0;
+	if (address) {
+		n += snprintf(line + n, sizeof(line) - n, "<%d ", address);
+	}
+	if (command->tagged) {
+		n += snprintf(line + n, sizeof(line) - n, "@%u ", command->tag);
+	}
+	if (value >= 0) {
+		n += snprintf(line + n, sizeof(line) - n, "%s %ld%c", text, value, END_OF_STRING);
+	} else {
+		n += snprintf(line + n, sizeof(line) - n, "%s%c", text, END_OF_STRING);
+	}
+	if (write(STDOUT_FILENO, line, n) != n) {
+		exit(1);
+	}
+}
+
+/** ***************************************************************************
+ * @brief Run a lamp: parse the bus, execute and answer
+ * @param [in] address of the lamp
+ * @param [in] group of the lamp
+ *
+ * At the end of the bus the set points are sent as "dump w a r g b".
+ *****************************************************************************/
+static void lamp_run(int address, int group) {
+	int value[VALUE_COUNT] = { 0 };
+	CMD_SetAddress(address, group);
+	char c;
+	while (read(STDIN_FILENO, &c, 1) == 1) {
+		CMD_Parse((END_OF_STRING == c) ? CMD_END_OF_LINE : c);
+		CMD_command_t command;
+		while (CMD_Get(&command)) {
+			if (CMD_OK != command.error) {
+				lamp_reply(&command, address, "err", command.error);
+			} else if (command.id < VALUE_COUNT) {	// white ... blue
+				if (command.argc > 0) {
+					value[command.id] = command.arg[0];
+				}
+				if (command.tagged) {
+					lamp_reply(&command, address, "ok", -1);
+				}
+			} else if ((CMD_ADR == command.id) || (CMD_GRP == command.id)) {
+				int *setting = (CMD_ADR == command.id) ? &address : &group;
+				if (command.argc > 0) {
+					if ((command.arg[0] < 0) || (command.arg[0] > CMD_ADDRESS_MAX)
+							|| ((CMD_ADR == command.id) && command.silent)) {
+						lamp_reply(&command, address, "err", CMD_ERR_ARGUMENT);
+						continue;
+					}
+					*setting = command.arg[0];
+					CMD_SetAddress(address, group);
+				}
+				lamp_reply(&command, address, (CMD_ADR == command.id) ? "adr" : "grp", *setting);
+			} else if (command.tagged) {
+				lamp_reply(&command, address, "ok", -1);
+			}
+		}
+	}
+	char line[LINE_LENGTH];
+	int n = snprintf(line, sizeof(line), "dump %d %d %d %d %d%c",
+			value[0], value[1], value[2], value[3], value[4], END_OF_STRING);
+	if (write(STDOUT_FILENO, line, n) != n) {
+		exit(1);
+	}
+	exit(0);
+}
+
+/** ***************************************************************************
+ * @brief Send a line to all the lamps and collect the answers
+ * @param [in] line without end of string
+ * @param [in] expected lamp which has to answer (1 ... lamp_count), 0 = none
+ * @param [in] answer expected answer, NULL = any
+ *****************************************************************************/
+static void bus(const char *line, int expected, const char *answer) {
+	char text[LINE_LENGTH];
+	int n = snprintf(text, sizeof(text), "%s%c", line, END_OF_STRING);
+	for (int i = 0; i < lamp_count; i++) {
+		if (write(lamp[i].rx, text, n) != n) {
+			perror("write");
+		}
+	}
+	if (verbose) {
+		printf("> %s\n", line);
+	}
+
+	/* collect the answers within the window */
+	char received[LAMP_MAX][LINE_LENGTH] = { { 0 } };
+	int talkers = 0;
+	int from = 0;
+	struct pollfd p[LAMP_MAX];
+	for (int i = 0; i < lamp_count; i++) {
+		p[i].fd = lamp[i].tx;
+		p[i].events = POLLIN;
+	}
+	while (poll(p, lamp_count, ANSWER_WINDOW_MS) > 0) {
+		for (int i = 0; i < lamp_count; i++) {
+			if (p[i].revents & POLLIN) {
+				size_t length = strlen(received[i]);
+				ssize_t k = read(lamp[i].tx, received[i] + length,
+						sizeof(received[i]) - 1 - length);
+				if (k > 0) {
+					received[i][length + k] = '\0';
+				}
+			}
+		}
+	}
+	for (int i = 0; i < lamp_count; i++) {
+		char *end = strchr(received[i], END_OF_STRING);
+		if (end) {
+			*end = '\0';
+		}
+		if (received[i][0]) {
+			talkers++;
+			from = i + 1;
+			if (verbose) {
+				printf("< %s\n", received[i]);
+			}
+		}
+	}
+
+	const char *error = NULL;
+	if (talkers > 1) {
+		error = "collision";
+	} else if (from != expected) {
+		error = expected ? "wrong or no lamp answered" : "unexpected answer";
+	} else if (expected && answer && strcmp(received[from - 1], answer)) {
+		error = "wrong answer";
+	}
+	if (error) {
+		printf("FAIL \"%s\": %s", line, error);
+		if (from) {
+			printf(" (\"%s\")", received[from - 1]);
+		}
+		printf("\n");
+		failures++;
+	}
+}
+
+/** ***************************************************************************
+ * @brief Set the expected set point of the lamps of a group
+ * @param [in] group 1 ... CMD_ADDRESS_MAX, 0 = all the lamps
+ * @param [in] solution 0 ... VALUE_COUNT-1
+ * @param [in] value set point
+ *****************************************************************************/
+static void expect(int group, int solution, int value) {
+	for (int i = 0; i < lamp_count; i++) {
+		if (!group || (lamp[i].group == group)) {
+			lamp[i].value[solution] = value;
+		}
+	}
+}
+
+/** ***************************************************************************
+ * @brief Start the lamps, run the sequence of the master and check it
+ * @return 0 = all the checks passed
+ *****************************************************************************/
+int main(int argc, char *argv[]) {
+	for (int i = 1; i < argc; i++) {
+		if (0 == strcmp(argv[i], "-v")) {
+			verbose = 1;
+		} else {
+			lamp_count = atoi(argv[i]);
+		}
+	}
+	if ((lamp_count < 4) || (lamp_count > LAMP_MAX)) {
+		fprintf(stderr, "4 ... %d lamps\n", LAMP_MAX);
+		return 1;
+	}
+	signal(SIGPIPE, SIG_IGN);
+	for (int i = 0; i < lamp_count; i++) {
+		int rx[2];
+		int tx[2];
+		if (pipe(rx) || pipe(tx)) {
+			perror("pipe");
+			return 1;
+		}
+		lamp[i].group = (i % 2) ? 2 : 1;	// address 1, 3, ... in group 1
+		lamp[i].pid = fork();
+		if (0 == lamp[i].pid) {
+			dup2(rx[0], STDIN_FILENO);
+			dup2(tx[1], STDOUT_FILENO);
+			for (int j = 0; j < i; j++) {	// ends of the master
+				close(lamp[j].rx);
+				close(lamp[j].tx);
+			}
+			close(rx[0]);
+			close(rx[1]);
+			close(tx[0]);
+			close(tx[1]);
+			lamp_run(i + 1, lamp[i].group);
+		}
+		close(rx[0]);
+		close(tx[1]);
+		lamp[i].rx = rx[1];
+		lamp[i].tx = tx[0];
+	}
+
+	/* one line sets the whole room, nobody answers */
+	bus(">* white 100", 0, NULL);
+	expect(0, 0, 100);
+	bus(">* @1 amber 20", 0, NULL);
+	expect(0, 1, 20);
+	bus(">g2 red 50", 0, NULL);
+	expect(2, 2, 50);
+	bus(">g1 @2 green 60", 0, NULL);
+	expect(1, 3, 60);
+	/* lines without or with another address are ignored */
+	bus("white 7", 0, NULL);
+	bus("@3 white 7", 0, NULL);
+	bus(">99 white 7", 0, NULL);
+	bus(">g9 white 7", 0, NULL);
+	bus(">x white 7", 0, NULL);
+	/* an address to all or to a group is refused, the poll below checks it */
+	bus(">* adr 5", 0, NULL);
+	bus(">g1 @4 adr 9", 0, NULL);
+	/* the master polls each lamp, only that one answers */
+	char line[LINE_LENGTH];
+	char answer[LINE_LENGTH];
+	for (int i = 1; i <= lamp_count; i++) {
+		snprintf(line, sizeof(line), ">%d @%d adr", i, 100 + i);
+		snprintf(answer, sizeof(answer), "<%d @%d adr %d", i, 100 + i, i);
+		bus(line, i, answer);
+		snprintf(line, sizeof(line), ">%d grp", i);
+		snprintf(answer, sizeof(answer), "<%d grp %d", i, lamp[i - 1].group);
+		bus(line, i, answer);
+	}
+	/* a single lamp: set point, errors, change of the group */
+	bus(">2 @7 blue 9", 2, "<2 @7 ok");
+	lamp[1].value[4] = 9;
+	bus(">2 foo", 2, "<2 err 1");
+	bus(">2 em", 2, "<2 err 2");
+	bus(">4 grp 1", 4, "<4 grp 1");
+	lamp[3].group = 1;
+	bus(">g1 blue 33", 0, NULL);
+	expect(1, 4, 33);
+
+	/* end of the bus: check the set points of all the lamps */
+	for (int i = 0; i < lamp_count; i++) {
+		close(lamp[i].rx);
+	}
+	for (int i = 0; i < lamp_count; i++) {
+		char dump[LINE_LENGTH] = "";
+		char expected[LINE_LENGTH];
+		size_t length = 0;
+		ssize_t k;
+		while ((k = read(lamp[i].tx, dump + length, sizeof(dump) - 1 - length)) > 0) {
+			length += k;
+		}
+		dump[length] = '\0';
+		char *end = strchr(dump, END_OF_STRING);
+		if (end) {
+			*end = '\0';
+		}
+		const int *v = lamp[i].value;
+		snprintf(expected, sizeof(expected), "dump %d %d %d %d %d",
+				v[0], v[1], v[2], v[3], v[4]);
+		if (strcmp(dump, expected)) {
+			printf("FAIL lamp %d: \"%s\" instead of \"%s\"\n", i + 1, dump, expected);
+			failures++;
+		} else if (verbose) {
+			printf("lamp %d: %s\n", i + 1, dump);
+		}
+		waitpid(lamp[i].pid, NULL, 0);
+	}
+	printf("%d lamps: %s\n", lamp_count, failures ? "FAILED" : "passed");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,241 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host tool: benchmark of the command lookup, 10 and 50 commands
+ *
+ * Compares the lookup of the remote control commands for a set of
+ * 10 and of 50 commands:
+ * - loop: the former UI_FSM_event_RemoteControl(), the line is compared
+ *   with every name by strncmp() of the first 3 chars, without stopping
+ *   at a match, and the argument is converted by strchr() and strtol(),
+ * - hash: the lookup of commands.c, the name is hashed char by char,
+ *   one slot of a perfect hash is read and the name is compared once,
+ *   the argument is accumulated char by char.
+ * The seed of the perfect hash is searched as tools/cmdgen.c does.
+ * @n The names are made up, e.g. "abc3x", so the 3 char rule of the loop
+ * also shows its collisions: lines that match more than one command.
+ *
+ * Finally the parser of the firmware (src/commands.c) is run on lines
+ * of its own command set, with the request id and address handling.
+ *
+ * The times are ns per line on the PC, only the ratio tells something
+ * about the target.
+ *
+ * Usage (on the PC, not on the target):
+ * @n gcc -O2 -I../src/inc -o cmdbench cmdbench.c ../src/commands.c
+ * @n ./cmdbench
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "commands.h"
+#include "commands_hash.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define NAME_MAX_COUNT		64				///< names of the largest set
+#define NAME_LENGTH			16				///< incl. '\0'
+#define LINE_LENGTH			(NAME_LENGTH + 1 + 10)	///< name, space, 10 digits
+#define COMPARE_LENGTH		3				///< UI_TEXT_COMPARE_LENGTH of the loop
+#define SLOT_EMPTY			0xFF			///< slot without name
+#define ROUNDS				2000000			///< lines per measurement
+
+static const uint32_t name_count[] = { 10, 50 };	///< command sets measured
+
+static char name[NAME_MAX_COUNT][NAME_LENGTH];	///< made up names
+static uint32_t count;						///< names in the set
+static uint32_t seed;						///< of the perfect hash
+static uint32_t bits;						///< 2^bits slots
+static uint8_t slot[1u << 8];				///< ids by hash
+static volatile int32_t sink;				///< keeps the results alive
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Hash of commands.c and cmdgen.c
+ * @param [in] s name, ends at '\0' or ' '
+ * @param [in] start seed
+ * @param [in] width bits of the slot
+ * @return slot
+ *****************************************************************************/
+static uint32_t hash(const char *s, uint32_t start, uint32_t width) {
+	uint32_t h = start;
+	while (*s && (' ' != *s)) {
+		h = CMD_HashStep(h, *s++);
+	}
+	return CMD_HashSlot(h, width);
+}
+
+/** ***************************************************************************
+ * @brief Make up the names and search a seed for them
+ *****************************************************************************/
+static void build(void) {
+	for (uint32_t i = 0; i < count; i++) {
+		snprintf(name[i], NAME_LENGTH, "%c%c%c%lux", 'a' + i % 26, 'a' + (i * 7) % 26,
+				'a' + (i * 11) % 26, (unsigned long)i);
+	}
+	bits = 1;
+	while ((1u << bits) < 2 * count) {
+		bits++;
+	}
+	for (seed = 1; ; seed++) {
+		memset(slot, SLOT_EMPTY, sizeof(slot));
+		uint32_t i;
+		for (i = 0; i < count; i++) {
+			uint32_t h = hash(name[i], seed, bits);
+			if (SLOT_EMPTY != slot[h]) {
+				break;						// collision, try the next seed
+			}
+			slot[h] = i;
+		}
+		if (i == count) {
+			return;
+		}
+	}
+}
+
+/** ***************************************************************************
+ * @brief Lookup as the former loop over all names
+ * @param [in] line e.g. "abc3x 42"
+ * @param [out] matches names matching the first COMPARE_LENGTH chars
+ * @return id of the last match, -1 = none
+ *****************************************************************************/
+static int32_t lookup_loop(const char *line, uint32_t *matches) {
+	int32_t id = -1;
+	*matches = 0;
+	for (uint32_t i = 0; i < count; i++) {	// no break after a match
+		if (0 == strncmp(name[i], line, COMPARE_LENGTH)) {
+			id = i;
+			(*matches)++;
+			char *end;
+			const char *pos = strchr(line, ' ');
+			if (pos) {
+				int32_t number = strtol(pos, &end, 10);
+				if ('\0' == *end) {
+					sink = number;
+				}
+			}
+		}
+	}
+	return id;
+}
+
+/** ***************************************************************************
+ * @brief Lookup as commands.c: hash char by char, one slot, one compare
+ * @param [in] line e.g. "abc3x 42"
+ * @return id, -1 = unknown
+ *****************************************************************************/
+static int32_t lookup_hash(const char *line) {
+	uint32_t h = seed;
+	const char *end = line;
+	while (*end && (' ' != *end)) {
+		h = CMD_HashStep(h, *end++);
+	}
+	uint32_t id = slot[CMD_HashSlot(h, bits)];
+	if (SLOT_EMPTY == id) {
+		return -1;
+	}
+	const char *n = name[id];
+	const char *p = line;
+	while ((p < end) && (*n == *p)) {
+		n++;
+		p++;
+	}
+	if ((p != end) || *n) {
+		return -1;
+	}
+	if (' ' == *end) {						// argument, char by char
+		int32_t number = 0;
+		for (end++; (*end >= '0') && (*end <= '9'); end++) {
+			number = number * 10 + (*end - '0');
+		}
+		sink = number;
+	}
+	return id;
+}
+
+/** ***************************************************************************
+ * @brief Time of a function in ns
+ * @param [in] a start
+ * @param [in] b end
+ *****************************************************************************/
+static double ns(const struct timespec *a, const struct timespec *b) {
+	return (b->tv_sec - a->tv_sec) * 1e9 + (b->tv_nsec - a->tv_nsec);
+}
+
+/** ***************************************************************************
+ * @brief Run the parser of the firmware on its own commands
+ * @return ns per line
+ *****************************************************************************/
+static double bench_firmware(void) {
+	static const char *line[] = {
+		"white 100", "red 80", "cct 2700 40", "col FFC080", "@17 blue 12",
+		"pwm 2000", "sub 500", "lat 3", "ts 1000", "em 1",
+	};
+	const uint32_t line_count = sizeof(line) / sizeof(line[0]);
+	CMD_command_t command;
+	struct timespec a, b;
+	clock_gettime(CLOCK_MONOTONIC, &a);
+	for (uint32_t r = 0; r < ROUNDS; r++) {
+		for (const char *c = line[r % line_count]; *c; c++) {
+			CMD_Parse(*c);
+		}
+		CMD_Parse(CMD_END_OF_LINE);
+		CMD_Get(&command);
+		sink = command.id;
+	}
+	clock_gettime(CLOCK_MONOTONIC, &b);
+	return ns(&a, &b) / ROUNDS;
+}
+
+/** ***************************************************************************
+ * @brief Measure both lookups for each set of commands
+ *****************************************************************************/
+int main(void) {
+	printf("commands  loop ns/line  hash ns/line  lines matching >1 name (loop)\n");
+	for (uint32_t s = 0; s < sizeof(name_count) / sizeof(name_count[0]); s++) {
+		count = name_count[s];
+		build();
+		char line[NAME_MAX_COUNT][LINE_LENGTH];
+		uint32_t ambiguous = 0;
+		for (uint32_t i = 0; i < count; i++) {
+			uint32_t matches;
+			snprintf(line[i], LINE_LENGTH, "%s %lu", name[i], (unsigned long)(i * 3));
+			lookup_loop(line[i], &matches);
+			ambiguous += (matches > 1);
+			if (lookup_hash(line[i]) != (int32_t)i) {
+				printf("hash lookup of \"%s\" failed\n", line[i]);
+				return EXIT_FAILURE;
+			}
+		}
+		double t[2];
+		for (uint32_t way = 0; way < 2; way++) {
+			struct timespec a, b;
+			clock_gettime(CLOCK_MONOTONIC, &a);
+			for (uint32_t r = 0; r < ROUNDS; r++) {
+				uint32_t matches;
+				const char *l = line[r % count];
+				sink = way ? lookup_hash(l) : lookup_loop(l, &matches);
+			}
+			clock_gettime(CLOCK_MONOTONIC, &b);
+			t[way] = ns(&a, &b) / ROUNDS;
+		}
+		printf("%8lu  %12.1f  %12.1f  %29lu\n", (unsigned long)count, t[0], t[1],
+				(unsigned long)ambiguous);
+	}
+	printf("firmware parser, %u commands: %.1f ns/line\n", CMD_COUNT, bench_firmware());
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,154 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host tool: generate the perfect hash of the remote control commands
+ *
+ * Reads the commands, one per line, and writes
+ * src/inc/commands_table.h for commands.c.
+ * @n Each line holds the name, the min and max number of integer arguments
+ * and their base (10 or 16), e.g. "cct 0 2 10". Lines with '#' are comments.
+ *
+ * Usage (on the PC, not on the target):
+ * @n gcc -I../src/inc -o cmdgen cmdgen.c
+ * @n ./cmdgen < commands.txt > ../src/inc/commands_table.h
+ *
+ * The names get the ids CMD_<NAME> in the order of the input,
+ * so the states of the user interface have to come first
+ * and in the order of UI_state_t.
+ * @n A seed is searched which maps every name to a slot of its own
+ * in a table of at least twice the number of names.
+ * The firmware then needs one pass over the name and one compare.
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "commands_hash.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define NAME_MAX_LENGTH		15				///< COM_BUF_SIZE - 1
+#define NAME_MAX_COUNT		128				///< max number of commands
+#define ARG_MAX_COUNT		8				///< max number of arguments
+#define SEED_TRIALS			1000000			///< give up after this many seeds
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Hash of a name, with the steps of the parser (commands_hash.h)
+ *****************************************************************************/
+static uint32_t hash(const char *name, uint32_t seed, uint32_t bits) {
+	uint32_t h = seed;
+	while (*name) {
+		h = CMD_HashStep(h, *name++);
+	}
+	return CMD_HashSlot(h, bits);
+}
+
+/** ***************************************************************************
+ * @brief Read the names, search a seed and write the header
+ *****************************************************************************/
+int main(void) {
+	static char name[NAME_MAX_COUNT][NAME_MAX_LENGTH + 1];
+	static unsigned args[NAME_MAX_COUNT][3];	// min, max, base
+	char line[80];
+	uint32_t count = 0;
+	uint32_t name_max = 0;
+	uint32_t arg_max = 0;
+	while (fgets(line, sizeof(line), stdin)) {
+		char text[80];
+		unsigned min, max, base;
+		if (('#' == line[0]) || (1 > sscanf(line, "%79s", text))) {
+			continue;						// comment or empty line
+		}
+		if ((4 != sscanf(line, "%79s %u %u %u", text, &min, &max, &base))
+				|| (min > max) || (max > ARG_MAX_COUNT) || ((10 != base) && (16 != base))) {
+			fprintf(stderr, "expected 'name min max base': %s", line);
+			return EXIT_FAILURE;
+		}
+		if ((count >= NAME_MAX_COUNT) || (strlen(text) > NAME_MAX_LENGTH)) {
+			fprintf(stderr, "too many or too long names\n");
+			return EXIT_FAILURE;
+		}
+		if (strlen(text) > name_max) { name_max = strlen(text); }
+		if (max > arg_max) { arg_max = max; }
+		args[count][0] = min;
+		args[count][1] = max;
+		args[count][2] = base;
+		strcpy(name[count++], text);
+	}
+
+	uint32_t bits = 1;
+	while ((1u << bits) < 2 * count) {
+		bits++;
+	}
+	static int slot[1 << 8];
+	uint32_t seed;
+	for (seed = 1; seed < SEED_TRIALS; seed++) {
+		memset(slot, 0xFF, sizeof(slot));
+		uint32_t i;
+		for (i = 0; i < count; i++) {
+			uint32_t h = hash(name[i], seed, bits);
+			if (slot[h] >= 0) {
+				break;						// collision, try the next seed
+			}
+			slot[h] = i;
+		}
+		if (i == count) {
+			break;
+		}
+	}
+	if (seed == SEED_TRIALS) {
+		fprintf(stderr, "no perfect hash found, %u names\n", count);
+		return EXIT_FAILURE;
+	}
+
+	printf("/** ***************************************************************************\n");
+	printf(" * @file\n");
+	printf(" * @brief Remote control commands, generated by tools/cmdgen.c - do not edit\n");
+	printf(" *\n");
+	printf(" * Perfect hash of the names, see commands.c\n");
+	printf(" *****************************************************************************/\n\n");
+	printf("#ifndef COMMANDS_TABLE_H_\n#define COMMANDS_TABLE_H_\n\n");
+	printf("/** Ids of the commands */\ntypedef enum {\n");
+	for (uint32_t i = 0; i < count; i++) {
+		char upper[NAME_MAX_LENGTH + 1];
+		for (uint32_t c = 0; c <= strlen(name[i]); c++) {
+			upper[c] = toupper((unsigned char)name[i][c]);
+		}
+		printf("\tCMD_%s,\n", upper);
+	}
+	printf("\tCMD_COUNT\n} CMD_id_t;\n\n");
+	printf("#define CMD_HASH_SEED\t%uu\t\t///< start value of the hash\n", seed);
+	printf("#define CMD_HASH_BITS\t%u\t\t\t///< 2^bits slots\n", bits);
+	printf("#define CMD_NAME_MAX\t%u\t\t\t///< length of the longest name\n", name_max);
+	printf("#define CMD_ARG_MAX\t\t%u\t\t\t///< max number of arguments\n\n",
+			arg_max ? arg_max : 1);
+	printf("/** Names of the commands by id */\n#define CMD_NAMES\t{ \\\n");
+	for (uint32_t i = 0; i < count; i++) {
+		printf("\t\"%s\"%s \\\n", name[i], (i < count - 1) ? "," : "");
+	}
+	printf("}\n\n/** Min and max number of arguments and their base by id */\n");
+	printf("#define CMD_ARGS\t{ \\\n");
+	for (uint32_t i = 0; i < count; i++) {
+		printf("\t{ %u, %u, %2u }%s \\\n", args[i][0], args[i][1], args[i][2],
+				(i < count - 1) ? "," : "");
+	}
+	printf("}\n\n/** Id by slot, CMD_COUNT = empty slot */\n#define CMD_SLOTS\t{ \\\n");
+	for (uint32_t h = 0; h < (1u << bits); h++) {
+		printf("%s%d%s", ((h % 16) == 0) ? "\t" : " ", (slot[h] >= 0) ? slot[h] : (int)count,
+				(h == (1u << bits) - 1) ? " \\\n" : (((h % 16) == 15) ? ", \\\n" : ","));
+	}
+	printf("}\n\n#endif\n");
+	return EXIT_SUCCESS;
+}
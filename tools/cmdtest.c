@@ -0,0 +1,206 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host tool: test of the remote control command parser
+ *
+ * Feeds lines char by char to the parser of the firmware (src/commands.c),
+ * as the RX interrupt does, and checks the command taken from its queue:
+ * id, error, number and value of the arguments.
+ * @n The lines cover the names (complete match only, unknown, too long),
+ * the number of arguments given in tools/commands.txt, decimal and hex
+ * arguments, signs, spaces and the limit of an argument (INT32_MAX).
+ * @n Lines with a request id, e.g. "@17 red 80", check that the id is kept
+ * with the command, up to CMD_TAG_MAX, and that an invalid id is an error.
+ * A burst of BURST_LINES tagged lines without reading the queue checks
+ * that CMD_QUEUE_SIZE are queued in order and the rest are counted
+ * as dropped, the gap a client sees in the ids of the replies.
+ *
+ * The exit code tells whether all lines were parsed as expected.
+ *
+ * Usage (on the PC, not on the target):
+ * @n gcc -I../src/inc -o cmdtest cmdtest.c ../src/commands.c
+ * @n ./cmdtest [-v]
+ *
+ * -v prints every line, not only the failing ones.
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "commands.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define ID_NONE			CMD_COUNT			///< nothing is queued
+#define ID_ANY			(CMD_COUNT + 1)		///< error before the name
+#define BURST_LINES		(CMD_QUEUE_SIZE + 2)	///< lines sent at once
+
+/** A line and the command expected from it */
+typedef struct {
+	const char *line;						///< without end of line
+	uint32_t id;							///< CMD_id_t, ID_NONE = nothing queued
+	uint32_t error;							///< CMD_OK or error
+	uint32_t argc;							///< number of arguments (if CMD_OK)
+	int32_t arg[CMD_ARG_MAX];				///< arguments (if CMD_OK)
+	bool tagged;							///< has a request id
+	uint16_t tag;							///< request id (if tagged)
+} case_t;
+
+static const case_t cases[] = {
+	/* names */
+	{ "white 100",				CMD_WHITE,	CMD_OK,				1, { 100 }, false, 0 },
+	{ "white",					CMD_WHITE,	CMD_OK,				0, { 0 }, false, 0 },
+	{ "whi",					0,			CMD_ERR_UNKNOWN,	0, { 0 }, false, 0 },
+	{ "whitex 1",				0,			CMD_ERR_UNKNOWN,	0, { 0 }, false, 0 },
+	{ "foo",					0,			CMD_ERR_UNKNOWN,	0, { 0 }, false, 0 },
+	{ "verylongcommandname 5",	0,			CMD_ERR_UNKNOWN,	0, { 0 }, false, 0 },
+	{ "",						ID_NONE,	CMD_OK,				0, { 0 }, false, 0 },
+	{ "   ",					ID_NONE,	CMD_OK,				0, { 0 }, false, 0 },
+	/* number of arguments */
+	{ "cct 2700 40",			CMD_CCT,	CMD_OK,				2, { 2700, 40 }, false, 0 },
+	{ "cct 1 2 3",				CMD_CCT,	CMD_ERR_ARGUMENT,	0, { 0 }, false, 0 },
+	{ "em",						CMD_EM,		CMD_ERR_ARGUMENT,	0, { 0 }, false, 0 },
+	{ "em 2",					CMD_EM,		CMD_OK,				1, { 2 }, false, 0 },
+	{ "out",					CMD_OUT,	CMD_OK,				0, { 0 }, false, 0 },
+	{ "out 1",					CMD_OUT,	CMD_ERR_ARGUMENT,	0, { 0 }, false, 0 },
+	/* digits, signs and spaces */
+	{ "  white   7  ",			CMD_WHITE,	CMD_OK,				1, { 7 }, false, 0 },
+	{ "em x",					CMD_EM,		CMD_ERR_ARGUMENT,	0, { 0 }, false, 0 },
+	{ "em 1x",					CMD_EM,		CMD_ERR_ARGUMENT,	0, { 0 }, false, 0 },
+	{ "pwm -5",					CMD_PWM,	CMD_OK,				1, { -5 }, false, 0 },
+	{ "white -",				CMD_WHITE,	CMD_ERR_ARGUMENT,	0, { 0 }, false, 0 },
+	{ "col FFc080",				CMD_COL,	CMD_OK,				1, { 0xFFC080 }, false, 0 },
+	{ "col -1",					CMD_COL,	CMD_ERR_ARGUMENT,	0, { 0 }, false, 0 },
+	{ "cct 2a",					CMD_CCT,	CMD_ERR_ARGUMENT,	0, { 0 }, false, 0 },
+	/* limit of an argument */
+	{ "cct 2147483647",			CMD_CCT,	CMD_OK,				1, { INT32_MAX }, false, 0 },
+	{ "cct 2147483648",			CMD_CCT,	CMD_ERR_ARGUMENT,	0, { 0 }, false, 0 },
+	{ "cct 4294969996",			CMD_CCT,	CMD_ERR_ARGUMENT,	0, { 0 }, false, 0 },	// 2^32 + 2700
+	{ "cct 99999999999999999999 40", CMD_CCT, CMD_ERR_ARGUMENT,	0, { 0 }, false, 0 },
+	{ "white -2147483647",		CMD_WHITE,	CMD_OK,				1, { -INT32_MAX }, false, 0 },
+	{ "col 7FFFFFFF",			CMD_COL,	CMD_OK,				1, { INT32_MAX }, false, 0 },
+	{ "col 80000000",			CMD_COL,	CMD_ERR_ARGUMENT,	0, { 0 }, false, 0 },
+	{ "col 1000000C080",		CMD_COL,	CMD_ERR_ARGUMENT,	0, { 0 }, false, 0 },
+	/* request ids */
+	{ "@17 red 80",				CMD_RED,	CMD_OK,				1, { 80 }, true, 17 },
+	{ "@0 out",					CMD_OUT,	CMD_OK,				0, { 0 }, true, 0 },
+	{ "@65535 sub",				CMD_SUB,	CMD_OK,				0, { 0 }, true, CMD_TAG_MAX },
+	{ "  @9   white  3",		CMD_WHITE,	CMD_OK,				1, { 3 }, true, 9 },
+	{ "@65536 sub",				ID_ANY,		CMD_ERR_ARGUMENT,	0, { 0 }, false, 0 },
+	{ "@ red",					ID_ANY,		CMD_ERR_ARGUMENT,	0, { 0 }, false, 0 },
+	{ "@x red",					ID_ANY,		CMD_ERR_ARGUMENT,	0, { 0 }, false, 0 },
+	{ "@1@2 red",				ID_ANY,		CMD_ERR_ARGUMENT,	0, { 0 }, false, 0 },
+	{ "@5",						0,			CMD_ERR_UNKNOWN,	0, { 0 }, true, 5 },
+	{ "@7 foo 1",				0,			CMD_ERR_UNKNOWN,	0, { 0 }, true, 7 },
+	{ "@8 em",					CMD_EM,		CMD_ERR_ARGUMENT,	0, { 0 }, true, 8 },
+	{ "red @4",					CMD_RED,	CMD_ERR_ARGUMENT,	0, { 0 }, false, 0 },
+	/* the parser is back at the start after an error */
+	{ "red 80",					CMD_RED,	CMD_OK,				1, { 80 }, false, 0 },
+};
+
+static bool verbose = false;
+static int failures = 0;
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Feed a line char by char, as the RX interrupt does
+ * @param [in] line without end of line
+ *****************************************************************************/
+static void feed(const char *line) {
+	for (const char *c = line; *c; c++) {
+		CMD_Parse(*c);
+	}
+	CMD_Parse(CMD_END_OF_LINE);
+}
+
+/** ***************************************************************************
+ * @brief Parse a line and compare the command with the expected one
+ * @param [in] c line and expected command
+ *****************************************************************************/
+static void check(const case_t *c) {
+	CMD_command_t command;
+	feed(c->line);
+	bool queued = CMD_Get(&command);
+	bool ok;
+	if (ID_NONE == c->id) {
+		ok = !queued;
+	} else {
+		ok = queued && (command.error == c->error);
+		if (ok && (CMD_OK == c->error)) {
+			ok = (command.id == c->id) && (command.argc == c->argc)
+					&& (0 == memcmp(command.arg, c->arg, c->argc * sizeof(c->arg[0])));
+		} else if (ok && (CMD_ERR_UNKNOWN != c->error) && (ID_ANY != c->id)) {
+			ok = (command.id == c->id);
+		}
+		ok = ok && (command.tagged == c->tagged) && (!c->tagged || (command.tag == c->tag));
+	}
+	CMD_command_t extra;
+	if (CMD_Get(&extra)) {					// one line, one command at most
+		ok = false;
+	}
+	if (verbose || !ok) {
+		printf("%-30s %s", c->line, ok ? "ok" : "FAILED");
+		if (queued) {
+			printf("  (id %u error %u argc %u", command.id, command.error, command.argc);
+			if (command.tagged) {
+				printf(" tag %u", command.tag);
+			}
+			for (uint32_t i = 0; i < command.argc; i++) {
+				printf(" %ld", (long)command.arg[i]);
+			}
+			printf(")");
+		}
+		printf("\n");
+	}
+	failures += !ok;
+}
+
+/** ***************************************************************************
+ * @brief Send BURST_LINES tagged lines before the queue is read
+ *****************************************************************************/
+static void check_burst(void) {
+	uint32_t dropped = CMD_GetDropped();
+	for (uint32_t i = 0; i < BURST_LINES; i++) {
+		char line[16];
+		snprintf(line, sizeof(line), "@%lu out", (unsigned long)i);
+		feed(line);
+	}
+	CMD_command_t command;
+	uint32_t queued = 0;
+	bool ok = true;
+	while (CMD_Get(&command)) {				// in order, the first ones
+		ok = ok && (CMD_OUT == command.id) && command.tagged && (command.tag == queued);
+		queued++;
+	}
+	dropped = CMD_GetDropped() - dropped;
+	ok = ok && (CMD_QUEUE_SIZE == queued) && (BURST_LINES - CMD_QUEUE_SIZE == dropped);
+	printf("burst of %u lines: %lu queued, %lu dropped %s\n", BURST_LINES,
+			(unsigned long)queued, (unsigned long)dropped, ok ? "ok" : "FAILED");
+	failures += !ok;
+}
+
+/** ***************************************************************************
+ * @brief Run all the lines and the burst
+ *****************************************************************************/
+int main(int argc, char *argv[]) {
+	verbose = (argc > 1) && (0 == strcmp(argv[1], "-v"));
+	CMD_Reset();
+	for (uint32_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		check(&cases[i]);
+	}
+	check_burst();
+	printf("%lu lines, %d failures\n", (unsigned long)(sizeof(cases) / sizeof(cases[0])),
+			failures);
+	printf("%s\n", failures ? "FAILED" : "passed");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,265 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host tool: generate the colour calibration of a Moodlight
+ *
+ * Reads the measured primaries of the five power LEDs at full drive
+ * and writes src/inc/colour_calibration.h for colour.c.
+ *
+ * Input on stdin, one line per LED in the order white, amber, red, green, blue:
+ * @n x y Y  (CIE 1931 chromaticity and luminance, e.g. in cd or lm)
+ * @n Empty lines and lines starting with # are skipped.
+ * The primaries of the lamp are in tools/primaries.txt.
+ *
+ * Usage (on the PC, not on the target):
+ * @n gcc -o colgen colgen.c -lm
+ * @n ./colgen < primaries.txt > ../src/inc/colour_calibration.h
+ *
+ * The target colour space is linear sRGB with D65 white.
+ * Input (1, 1, 1) is scaled to the luminance of the white LED,
+ * so a neutral colour is mostly produced by the white LED.
+ *
+ * For the CCT mode (cct.c) the Planckian locus is mixed from white, amber
+ * and red in steps of CCT_STEP. All points have the same luminance,
+ * the one of the point with the least luminance at full drive of its
+ * strongest LED. So a brightness in % is the same luminance
+ * at every colour temperature.
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define Q12				4096.0				///< fixed point 1.0
+#define LED_COUNT		5					///< white, amber, red, green, blue
+#define MIN_SHARE		0.02				///< smaller components are ignored
+#define CCT_MIN			2000				///< first point of the CCT table in K
+#define CCT_MAX			6500				///< last point of the CCT table in K
+#define CCT_STEP		500					///< spacing of the CCT table in K
+#define CCT_COUNT		((CCT_MAX - CCT_MIN) / CCT_STEP + 1)
+
+/** linear sRGB -> XYZ (D65) */
+static const double SRGB_TO_XYZ[3][3] = {
+	{ 0.4124, 0.3576, 0.1805 },
+	{ 0.2126, 0.7152, 0.0722 },
+	{ 0.0193, 0.1192, 0.9505 },
+};
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Invert a 3x3 matrix
+ * @return 0 = ok, -1 = singular
+ *****************************************************************************/
+static int invert(const double m[3][3], double inv[3][3]) {
+	double det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+			- m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+			+ m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+	if (fabs(det) < 1e-12) {
+		return -1;
+	}
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			int a = (j + 1) % 3, b = (j + 2) % 3, c = (i + 1) % 3, d = (i + 2) % 3;
+			inv[i][j] = (m[a][c] * m[b][d] - m[a][d] * m[b][c]) / det;
+		}
+	}
+	return 0;
+}
+
+/** ***************************************************************************
+ * @brief Multiply a 3x3 matrix with a vector
+ *****************************************************************************/
+static void mul(const double m[3][3], const double v[3], double out[3]) {
+	for (int i = 0; i < 3; i++) {
+		out[i] = m[i][0] * v[0] + m[i][1] * v[1] + m[i][2] * v[2];
+	}
+}
+
+/** ***************************************************************************
+ * @brief Print a vector in Q12 and its reciprocal in Q12
+ *****************************************************************************/
+static void print_vector(const char *name, const double v[3]) {
+	printf("#define COL_%s\t\t{ %ld, %ld, %ld }\n", name,
+			lround(v[0] * Q12), lround(v[1] * Q12), lround(v[2] * Q12));
+	printf("#define COL_%s_INV\t{ ", name);
+	for (int i = 0; i < 3; i++) {			// 0 = component too small to use
+		long inv = (v[i] > MIN_SHARE) ? lround(Q12 * Q12 / v[i]) : 0;
+		printf("%ld%s", inv, (i < 2) ? ", " : " }\n");
+	}
+}
+
+/** ***************************************************************************
+ * @brief Chromaticity of a black body (Kim et al., 1667 K ... 25000 K)
+ *****************************************************************************/
+static void planck(double t, double *x, double *y) {
+	if (t < 4000) {
+		*x = -0.2661239e9 / (t * t * t) - 0.2343589e6 / (t * t) + 0.8776956e3 / t + 0.179910;
+	} else {
+		*x = -3.0258469e9 / (t * t * t) + 2.1070379e6 / (t * t) + 0.2226347e3 / t + 0.240390;
+	}
+	double u = *x;
+	if (t < 2222) {
+		*y = -1.1063814 * u * u * u - 1.34811020 * u * u + 2.18555832 * u - 0.20219683;
+	} else if (t < 4000) {
+		*y = -0.9549476 * u * u * u - 1.37418593 * u * u + 2.09137015 * u - 0.16748867;
+	} else {
+		*y = 3.0817580 * u * u * u - 5.87338670 * u * u + 3.75112997 * u - 0.37001483;
+	}
+}
+
+/** ***************************************************************************
+ * @brief Print the CCT table: white, amber and red along the Planckian locus
+ * @return 0 = ok, -1 = white, amber and red are not independent
+ *****************************************************************************/
+static int print_cct(double xyz[LED_COUNT][3]) {
+	double war[3][3], war_inv[3][3];		// columns: XYZ of white, amber, red
+	for (int i = 0; i < 3; i++) {
+		war[i][0] = xyz[0][i];
+		war[i][1] = xyz[1][i];
+		war[i][2] = xyz[2][i];
+	}
+	if (invert(war, war_inv)) {
+		return -1;
+	}
+	double drive[CCT_COUNT][3];
+	double luminance = 0;					// common to all points
+	for (int n = 0; n < CCT_COUNT; n++) {
+		double x, y, target[3];
+		planck(CCT_MIN + n * CCT_STEP, &x, &y);
+		target[0] = x / y;
+		target[1] = 1;
+		target[2] = (1 - x - y) / y;
+		mul(war_inv, target, drive[n]);
+		double max = 0;
+		for (int i = 0; i < 3; i++) {		// out of reach: nearest colour
+			if (drive[n][i] < 0) { drive[n][i] = 0; }
+			if (drive[n][i] > max) { max = drive[n][i]; }
+		}
+		double Y = 0;						// at full drive of the strongest LED
+		for (int i = 0; i < 3; i++) {
+			drive[n][i] /= max;
+			Y += drive[n][i] * war[1][i];
+		}
+		for (int i = 0; i < 3; i++) {		// per unit of luminance
+			drive[n][i] /= Y;
+		}
+		if ((0 == n) || (Y < luminance)) { luminance = Y; }
+	}
+	long table[CCT_COUNT][3];
+	for (int n = 0; n < CCT_COUNT; n++) {
+		for (int i = 0; i < 3; i++) {
+			table[n][i] = lround(drive[n][i] * luminance * 255);
+		}
+	}
+	printf("\n/** white, amber, red 0 ... 255 from %d K to %d K in steps of %d K,\n",
+			CCT_MIN, CCT_MAX, CCT_STEP);
+	printf(" * all with a luminance of %.1f (unit of the primaries) */\n", luminance);
+	printf("#define COL_CCT_MIN\t\t%d\n#define COL_CCT_STEP\t%d\n", CCT_MIN, CCT_STEP);
+	printf("#define COL_CCT_COUNT\t%d\n#define COL_CCT_TABLE\t{ \\\n", CCT_COUNT);
+	for (int n = 0; n < CCT_COUNT; n++) {
+		printf("\t{ %3ld, %3ld, %3ld }%s \\\n", table[n][0], table[n][1], table[n][2],
+				(n < CCT_COUNT - 1) ? "," : "");
+	}
+	printf("}\n");
+	return 0;
+}
+
+/** ***************************************************************************
+ * @brief Read the next line of primaries, skip comments
+ * @param [out] x, y chromaticity
+ * @param [out] Y luminance
+ * @return 0 = ok, -1 = no valid line
+ *****************************************************************************/
+static int read_primary(double *x, double *y, double *Y) {
+	char line[256];
+	while (fgets(line, sizeof(line), stdin)) {
+		char first = 0;
+		if ((1 != sscanf(line, " %c", &first)) || ('#' == first)) {
+			continue;						// empty or comment
+		}
+		return (3 == sscanf(line, "%lf %lf %lf", x, y, Y)) ? 0 : -1;
+	}
+	return -1;
+}
+
+/** ***************************************************************************
+ * @brief Read the primaries and write the calibration header
+ *****************************************************************************/
+int main(void) {
+	double xyz[LED_COUNT][3];
+	for (int led = 0; led < LED_COUNT; led++) {
+		double x, y, Y;
+		if ((0 != read_primary(&x, &y, &Y)) || (y <= 0)) {
+			fprintf(stderr, "expected 5 lines 'x y Y' (white amber red green blue)\n");
+			return EXIT_FAILURE;
+		}
+		xyz[led][0] = x / y * Y;
+		xyz[led][1] = Y;
+		xyz[led][2] = (1 - x - y) / y * Y;
+	}
+
+	/* lamp RGB: columns are the XYZ of red, green and blue at full drive */
+	double lamp[3][3], lamp_inv[3][3];
+	for (int i = 0; i < 3; i++) {
+		for (int c = 0; c < 3; c++) {
+			lamp[i][c] = xyz[2 + c][i];
+		}
+	}
+	if (invert(lamp, lamp_inv)) {
+		fprintf(stderr, "red, green and blue are not independent\n");
+		return EXIT_FAILURE;
+	}
+
+	/* sRGB (1,1,1) at the luminance of the white LED -> lamp RGB */
+	double matrix[3][3];
+	double scale = xyz[0][1];				// Y of sRGB white is 1.0
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 3; j++) {
+			matrix[i][j] = 0;
+			for (int k = 0; k < 3; k++) {
+				matrix[i][j] += lamp_inv[i][k] * SRGB_TO_XYZ[k][j] * scale;
+			}
+		}
+	}
+
+	/* white and amber expressed in lamp RGB */
+	double white[3], amber[3];
+	mul(lamp_inv, xyz[0], white);
+	mul(lamp_inv, xyz[1], amber);
+
+	printf("/** ***************************************************************************\n");
+	printf(" * @file\n");
+	printf(" * @brief Colour calibration, generated by tools/colgen.c - do not edit\n");
+	printf(" *\n");
+	printf(" * Fixed point Q12, see colour.c\n");
+	printf(" *\n");
+	printf(" * Regenerate in tools/ after a new measurement of the primaries:\n");
+	printf(" * @n gcc -o colgen colgen.c -lm\n");
+	printf(" * @n ./colgen < primaries.txt > ../src/inc/colour_calibration.h\n");
+	printf(" *****************************************************************************/\n\n");
+	printf("#ifndef COLOUR_CALIBRATION_H_\n#define COLOUR_CALIBRATION_H_\n\n");
+	printf("/** linear sRGB -> lamp RGB */\n#define COL_MATRIX\t\t{ \\\n");
+	for (int i = 0; i < 3; i++) {
+		printf("\t{ %ld, %ld, %ld }%s \\\n", lround(matrix[i][0] * Q12),
+				lround(matrix[i][1] * Q12), lround(matrix[i][2] * Q12), (i < 2) ? "," : "");
+	}
+	printf("}\n\n/** white and amber at full drive in lamp RGB, with reciprocals */\n");
+	print_vector("WHITE", white);
+	print_vector("AMBER", amber);
+	if (print_cct(xyz)) {
+		fprintf(stderr, "white, amber and red are not independent\n");
+		return EXIT_FAILURE;
+	}
+	printf("\n#endif\n");
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,141 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host tool: check of the hardware cut-off routing of RGB
+ *
+ * Takes the register values of the cut-off ACMP0 -> PRS -> TIMER0 DTI
+ * from the firmware, PWR_cutoff_model() of cutoff.h, and checks them
+ * field by field against the device header:
+ * - the PRS channel carries the ACMP0 output as a level,
+ * - it is not channel 0, the ADC trigger of regulation.c,
+ * - the DTI fault source 0 is that PRS channel, the fault action
+ *   drives the outputs inactive, debugger and lockup do not fault,
+ * - the DTI controls CC0 ... CC2 (red, green, blue) only.
+ *
+ * Then the routing is run period by period as the DTI does it: a fault
+ * ends the pulses until TIMER0_IRQHandler() clears it at the next overflow.
+ * The shunt current rises during the pulse, the comparator trips at the
+ * reference. The pulse must end at the trip and start again next period.
+ * @n A comparator that is high all the time, e.g. a floating input,
+ * keeps RGB dark. That is why PWR_HW_CUTOFF is off until the board
+ * has its comparator wiring.
+ * The exit code tells whether all checks passed.
+ *
+ * Usage (on the PC, not on the target), with the device header of the SDK:
+ * @n gcc -DEFM32G890F128 -I<sdk>/platform/Device/SiliconLabs/EFM32G/Include
+ *  -I<sdk>/platform/CMSIS/Include -I../src/inc -o cutcheck cutcheck.c
+ * @n ./cutcheck
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "cutoff.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define REG_PRS_CHANNEL		0				///< ADC trigger of regulation.c
+#define PERIOD_TICKS		1000			///< ticks of a PWM period
+#define PERIOD_COUNT		4				///< periods run per case
+
+/** One case of the shunt current */
+typedef struct {
+	const char *name;
+	uint32_t duty;							///< pulse width in ticks
+	uint32_t trip;							///< tick the comparator goes high
+	bool floating;							///< comparator high all the time
+	uint32_t expected;						///< pulse width with the cut-off
+} case_t;
+
+static const case_t cases[] = {
+	{ "below the reference", 400, PERIOD_TICKS, false, 400 },
+	{ "peak current cut", 400, 250, false, 250 },
+	{ "cut at the start", 400, 0, false, 0 },
+	{ "floating comparator", 400, 0, true, 0 },
+};
+
+static int failures = 0;
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Report a check
+ * @param [in] ok result of the check
+ * @param [in] what is checked
+ *****************************************************************************/
+static void check(bool ok, const char *what) {
+	printf("%-56s %s\n", what, ok ? "ok" : "FAILED");
+	failures += !ok;
+}
+
+/** ***************************************************************************
+ * @brief Run the DTI of one channel over a few periods
+ * @param [in] c case of the shunt current
+ * @param [in] regs register values of the model
+ * @return true = every period has the expected pulse width
+ *****************************************************************************/
+static bool run(const case_t *c, const PWR_cutoff_regs_t *regs) {
+	bool fault = false;
+	bool ok = true;
+	for (uint32_t period = 0; period < PERIOD_COUNT; period++) {
+		fault = false;						// DTFAULTC in TIMER0_IRQHandler()
+		uint32_t width = 0;
+		for (uint32_t tick = 0; tick < PERIOD_TICKS; tick++) {
+			bool acmp = c->floating || ((tick < c->duty) && (tick >= c->trip));
+			if (acmp && (regs->dtfc & TIMER_DTFC_DTPRS0FEN)) {
+				fault = true;				// latched until cleared
+			}
+			bool active = (tick < c->duty)
+					&& !(fault && (regs->dtogen & TIMER_DTOGEN_DTOGCC0EN));
+			width += active;
+		}
+		ok = ok && (width == c->expected);
+	}
+	return ok;
+}
+
+/** ***************************************************************************
+ * @brief Check the register fields and run the cases
+ *****************************************************************************/
+int main(void) {
+	PWR_cutoff_regs_t regs;
+	PWR_cutoff_model(&regs);
+
+	check((regs.prs_ctrl & _PRS_CH_CTRL_SOURCESEL_MASK) == PRS_CH_CTRL_SOURCESEL_ACMP0,
+			"PRS source is ACMP0");
+	check((regs.prs_ctrl & _PRS_CH_CTRL_SIGSEL_MASK) == PRS_CH_CTRL_SIGSEL_ACMP0OUT,
+			"PRS signal is the comparator output");
+	check((regs.prs_ctrl & _PRS_CH_CTRL_EDSEL_MASK) == PRS_CH_CTRL_EDSEL_OFF,
+			"PRS signal is a level, no edge pulse");
+	check(regs.prs_channel != REG_PRS_CHANNEL,
+			"PRS channel is not the ADC trigger of regulation.c");
+	check(((regs.dtfc & _TIMER_DTFC_DTPRS0FSEL_MASK) >> _TIMER_DTFC_DTPRS0FSEL_SHIFT)
+			== regs.prs_channel, "DTI fault source 0 is that PRS channel");
+	check(regs.dtfc & TIMER_DTFC_DTPRS0FEN, "DTI fault source 0 is enabled");
+	check((regs.dtfc & _TIMER_DTFC_DTFA_MASK) == TIMER_DTFC_DTFA_INACTIVE,
+			"DTI fault drives the outputs inactive");
+	check(!(regs.dtfc & (TIMER_DTFC_DTDBGFEN | TIMER_DTFC_DTLOCKUPFEN)),
+			"debugger and lockup do not fault");
+	check((regs.dtogen & _TIMER_DTOGEN_MASK) == (TIMER_DTOGEN_DTOGCC0EN
+			| TIMER_DTOGEN_DTOGCC1EN | TIMER_DTOGEN_DTOGCC2EN),
+			"DTI controls CC0 ... CC2 only");
+	check(regs.dtctrl & TIMER_DTCTRL_DTEN, "DTI is enabled");
+
+	for (uint32_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		char what[64];
+		snprintf(what, sizeof(what), "pulse %lu ticks: %s",
+				(unsigned long)cases[i].expected, cases[i].name);
+		check(run(&cases[i], &regs), what);
+	}
+
+	printf("%s\n", failures ? "FAILED" : "passed");
+	return failures ? 1 : 0;
+}
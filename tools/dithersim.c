@@ -0,0 +1,137 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host tool: duty error of the white dither over the wake-up latency
+ *
+ * Simulates LETIMER0 of white tick by tick (see powerLEDs.c):
+ * the counter counts down from PWR_WHITE_TOP, at the underflow the output
+ * goes idle and the underflow interrupt writes the next dithered COMP1,
+ * the output is active from the match with COMP1 until the next underflow.
+ * @n The interrupt writes COMP1 a number of ticks after the underflow,
+ * the wake-up latency. If the counter has already passed the new COMP1,
+ * the match is missed and the pulse of this period is lost.
+ *
+ * For every set point 0 ... 255 that is dithered (a fraction of a compare
+ * step, below PWR_WHITE_DITHER_MAX) the active time averaged over
+ * PERIOD_COUNT periods is compared with the set point, in % of full scale.
+ * The same is shown for plain truncation of the compare value.
+ *
+ * Latency 0 ... 2 ticks is a wake-up from EM2 on the HFRCO with
+ * the synchronisation of COMP1 to the LF domain (see energymode.c),
+ * 16 ticks is a wake-up that waits for the HF crystal (0.5 ms).
+ * The exit code tells whether the dither is exact up to 2 ticks.
+ *
+ * Usage (on the PC, not on the target):
+ * @n gcc -o dithersim dithersim.c
+ * @n ./dithersim
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define WHITE_TOP			66				///< PWR_WHITE_TOP of powerLEDs.c
+#define WHITE_SCALE			1060			///< PWR_WHITE_SCALE
+#define WHITE_DITHER_MAX	(WHITE_TOP - 4)	///< PWR_WHITE_DITHER_MAX
+#define CONVERSION_SHIFT	12				///< PWR_conversion_shift
+#define PERIOD_COUNT		4096			///< periods per set point
+#define LATENCY_OK			2				///< ticks the dither has to stand
+#define ERROR_OK			0.001			///< % of full scale, rounding only
+
+static const uint32_t latency[] = { 0, 1, 2, 4, 8, 16 };	///< ticks
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief One step of the sigma-delta modulator, as PWR_white_dither()
+ * @param [in,out] error accumulator in 1/4096
+ * @param [in] value_q12 compare value in 1/4096
+ * @return compare value for the next period
+ *****************************************************************************/
+static uint32_t white_dither(uint32_t *error, uint32_t value_q12) {
+	uint32_t sum = *error + value_q12;
+	*error = sum & ((1 << CONVERSION_SHIFT) - 1);
+	return sum >> CONVERSION_SHIFT;
+}
+
+/** ***************************************************************************
+ * @brief Run the LETIMER0 output for one set point
+ * @param [in] value_q12 compare value in 1/4096
+ * @param [in] late ticks from the underflow to the write of COMP1
+ * @param [out] lost periods without the pulse they should have had
+ * @return active ticks averaged over PERIOD_COUNT periods
+ *****************************************************************************/
+static double run(uint32_t value_q12, uint32_t late, uint32_t *lost) {
+	uint32_t error = 0;
+	uint32_t comp1 = 0;						// as left by the last period
+	uint64_t active = 0;
+	*lost = 0;
+	for (uint32_t period = 0; period < PERIOD_COUNT; period++) {
+		uint32_t next = white_dither(&error, value_q12);
+		bool on = false;
+		uint32_t ticks = 0;
+		for (uint32_t cnt = WHITE_TOP; cnt > 0; cnt--) {	// after the underflow
+			if (WHITE_TOP - cnt == late) {
+				comp1 = next;				// the interrupt writes COMP1
+			}
+			if (cnt == comp1) {
+				on = true;					// match: active until the underflow
+			}
+			ticks += on;
+		}
+		if (next && (ticks < next)) {
+			(*lost)++;
+		}
+		active += ticks;
+	}
+	return (double)active / PERIOD_COUNT;
+}
+
+/** ***************************************************************************
+ * @brief Worst averaged error of all dithered set points at each latency
+ *****************************************************************************/
+int main(void) {
+	int failures = 0;
+	double truncation = 0;
+	for (uint32_t value = 0; value <= 255; value++) {
+		uint32_t value_q12 = value * WHITE_SCALE;
+		double target = (double)value_q12 / (1 << CONVERSION_SHIFT);
+		double error = ((value_q12 >> CONVERSION_SHIFT) - target) * 100 / WHITE_TOP;
+		if (-error > truncation) { truncation = -error; }
+	}
+	printf("truncation without dither: max error %.3f %% of full scale\n", truncation);
+	printf("latency ticks  max error %% of full scale  periods lost\n");
+	for (uint32_t i = 0; i < sizeof(latency) / sizeof(latency[0]); i++) {
+		double worst = 0;
+		uint32_t lost_total = 0;
+		for (uint32_t value = 0; value <= 255; value++) {
+			uint32_t value_q12 = value * WHITE_SCALE;
+			if (!(value_q12 & ((1 << CONVERSION_SHIFT) - 1))
+					|| ((value_q12 >> CONVERSION_SHIFT) >= WHITE_DITHER_MAX)) {
+				continue;					// not dithered
+			}
+			uint32_t lost;
+			double target = (double)value_q12 / (1 << CONVERSION_SHIFT);
+			double error = (run(value_q12, latency[i], &lost) - target) * 100 / WHITE_TOP;
+			if (error < 0) { error = -error; }
+			if (error > worst) { worst = error; }
+			lost_total += lost;
+		}
+		printf("%13lu  %26.4f  %12lu\n", (unsigned long)latency[i], worst,
+				(unsigned long)lost_total);
+		if ((latency[i] <= LATENCY_OK) && ((worst > ERROR_OK) || lost_total)) {
+			failures++;
+		}
+	}
+	printf("%s\n", failures ? "FAILED" : "passed");
+	return failures ? 1 : 0;
+}
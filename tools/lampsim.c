@@ -0,0 +1,396 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host tool: the remote control interface of a lamp behind a pty
+ *
+ * Stands in for a lamp at the other end of the serial link,
+ * so host programs (e.g. tools/mlbench.cpp) can be tried without the board.
+ * @n The lines are parsed by the command parser of the firmware
+ * (src/commands.c) and answered like userinterface.c:
+ * - "[<adr ]@tag ok" for state commands with a request id,
+ * - "[<adr ][@tag ]err n" for errors,
+ * - "[<adr ][@tag ]name value" for queries, e.g. "sub 100",
+ * - untagged "red 80" notifications of the changed set points,
+ *   only the latest value of a state, at most once per "sub" interval
+ *   and not on a bus (address != 0).
+ *
+ * The timing of the firmware is kept where it matters to a client:
+ * each character takes its time on the link in both directions,
+ * the parsed commands wait in the queue of CMD_QUEUE_SIZE,
+ * and the main loop executes them once per tick of 20 ms
+ * until one of them changes the state or the value.
+ * @n The latency of the state commands to the light is measured
+ * with the module of the firmware (src/latency.c):
+ * white, amber and cct are written at once,
+ * red, green and blue at the start of the next PWM period.
+ * "lat" and "drop" are answered like the firmware.
+ *
+ * Usage (on the PC, not on the target):
+ * @n gcc -I../src/inc -o lampsim lampsim.c ../src/commands.c ../src/latency.c
+ * @n socat -d -d pty,raw,echo=0 pty,raw,echo=0
+ * @n ./lampsim /dev/pts/3 [-a address] [-b baud] [-p period] [-v]
+ *
+ * -a sets the address of the lamp on a bus, -b the baud rate (default 9600),
+ * -p the PWM period in us (default 2000), -v prints all the lines.
+ * At the end of the link (the other side closed) the counters are printed.
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "commands.h"
+#include "latency.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define END_OF_STRING		'\r'			///< COM_END_OF_STRING of the firmware
+#define BAUDRATE			9600			///< COM_BAUDRATE of the firmware
+#define LINE_LENGTH			32				///< COM_BUF_SIZE of the firmware
+#define REPLY_COUNT			8				///< COM_TX_REPLY_COUNT of the firmware
+#define TICK_NS				20000000LL		///< main loop, EMM_TICK_MS of the firmware
+#define NOTIFY_MS			100				///< COM_NOTIFY_INTERVAL_MS of the firmware
+#define PWM_PERIOD_US		2000			///< PWR_PWM_FREQUENCY of the firmware
+#define STATE_COUNT			CMD_EM			///< the states come first in commands.txt
+
+static const char *name[CMD_COUNT] = CMD_NAMES;
+
+static int fd;								///< the pseudo-terminal
+static int address = 0;
+static int group = 0;
+static int verbose = 0;
+static int64_t char_ns;						///< time of one character on the link
+static int64_t pwm_ns = PWM_PERIOD_US * 1000LL;	///< PWM period of TIMER0
+
+static int32_t value[STATE_COUNT];			///< set points by state
+static uint32_t notify_ms = NOTIFY_MS;		///< 0 = no notifications
+static int notify_pending[STATE_COUNT];
+static int64_t notify_last;					///< time of the last notifications
+static int notify_burst = 0;				///< the pending ones are being sent
+
+static char reply[REPLY_COUNT][LINE_LENGTH];	///< replies waiting
+static uint32_t reply_head = 0;
+static uint32_t reply_tail = 0;
+static char tx_line[LINE_LENGTH];			///< line being sent
+static size_t tx_length = 0;
+static size_t tx_position = 0;
+
+static uint32_t count_lines = 0;
+static uint32_t count_changes = 0;
+static uint32_t count_replies = 0;
+static uint32_t count_notifications = 0;
+static uint32_t count_lost = 0;				///< replies dropped, queue full
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Get the time
+ * @return monotonic time in ns
+ *****************************************************************************/
+static int64_t now_ns(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (int64_t)t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
+/** ***************************************************************************
+ * @brief Convert a time to ticks of the sleeptimer
+ * @param [in] ns monotonic time
+ * @return ticks of LAT_TICK_HZ
+ *****************************************************************************/
+static uint32_t ns_to_ticks(int64_t ns) {
+	return (uint32_t)((ns / 1000) * LAT_TICK_HZ / 1000000);
+}
+
+/** ***************************************************************************
+ * @brief Queue a reply like UI_send_text_value()
+ * @param [in] command being answered
+ * @param [in] text and number, number < 0 = text only
+ *****************************************************************************/
+static void lamp_reply(const CMD_command_t *command, const char *text, long number) {
+	if (command->silent) {
+		return;
+	}
+	if (reply_head - reply_tail >= REPLY_COUNT) {
+		count_lost++;
+		return;
+	}
+	char *line = reply[reply_head++ % REPLY_COUNT];
+	int n = 0;
+	if (address) {
+		n += snprintf(line + n, LINE_LENGTH - n, "<%d ", address);
+	}
+	if (command->tagged) {
+		n += snprintf(line + n, LINE_LENGTH - n, "@%u ", command->tag);
+	}
+	if (number >= 0) {
+		snprintf(line + n, LINE_LENGTH - n, "%s %ld", text, number);
+	} else {
+		snprintf(line + n, LINE_LENGTH - n, "%s", text);
+	}
+	count_replies++;
+}
+
+/** ***************************************************************************
+ * @brief Execute the commands like UI_FSM_event_RemoteControl()
+ *
+ * @param [in] now time in ns
+ *
+ * Stops after a command which changes the state or the value,
+ * the next one waits for the next tick.
+ *****************************************************************************/
+static void lamp_tick(int64_t now) {
+	CMD_command_t command;
+	while (CMD_Get(&command)) {
+		if (CMD_OK != command.error) {
+			lamp_reply(&command, "err", command.error);
+		} else if (command.id < STATE_COUNT) {
+			if (command.argc > 0) {
+				value[command.id] = command.arg[0];
+			}
+			if ((command.argc > 0) && ((command.id <= CMD_BLUE) || (CMD_CCT == command.id))) {
+				LAT_Arm(LAT_REMOTE, command.received);	// UI_FSM_state_value()
+				LAT_Stage();				// PWR_set_value()
+				if ((CMD_WHITE == command.id) || (CMD_AMBER == command.id)
+						|| (CMD_CCT == command.id)) {
+					LAT_Commit(ns_to_ticks(now));	// white is written first
+				}
+			}
+			if (command.tagged) {
+				lamp_reply(&command, "ok", -1);
+			}
+			notify_pending[command.id] = 1;	// UI_show_state_value()
+			count_changes++;
+			return;
+		} else if (CMD_SUB == command.id) {
+			if (command.argc > 0) {
+				if (command.arg[0] < 0) {
+					lamp_reply(&command, "err", CMD_ERR_ARGUMENT);
+					continue;
+				}
+				notify_ms = command.arg[0];
+			}
+			lamp_reply(&command, name[command.id], notify_ms);
+		} else if (CMD_LAT == command.id) {	// like UI_cmd_lat()
+			uint32_t source = command.arg[0];
+			uint32_t info = (command.argc > 1) ? (uint32_t)command.arg[1] : LAT_COUNT;
+			if ((source >= LAT_SOURCE_COUNT) || (info >= LAT_INFO_COUNT)) {
+				lamp_reply(&command, "err", CMD_ERR_ARGUMENT);
+				continue;
+			}
+			lamp_reply(&command, name[command.id], LAT_GetInfo(source, info));
+			if (command.argc < 2) {
+				LAT_Reset(source);
+			}
+		} else if (CMD_DROP == command.id) {
+			lamp_reply(&command, name[command.id], CMD_GetDropped());
+		} else if ((CMD_ADR == command.id) || (CMD_GRP == command.id)) {
+			int *setting = (CMD_ADR == command.id) ? &address : &group;
+			if (command.argc > 0) {
+				if ((command.arg[0] < 0) || (command.arg[0] > CMD_ADDRESS_MAX)) {
+					lamp_reply(&command, "err", CMD_ERR_ARGUMENT);
+					continue;
+				}
+				*setting = command.arg[0];
+				CMD_SetAddress(address, group);
+			}
+			lamp_reply(&command, name[command.id], *setting);
+		} else {							// diagnostics are not simulated
+			lamp_reply(&command, name[command.id], 0);
+		}
+	}
+}
+
+/** ***************************************************************************
+ * @brief Take the next line to send like the TX interrupt
+ * @param [in] now time in ns
+ *
+ * Replies come first, the notifications follow when the interval is over.
+ *****************************************************************************/
+static void lamp_next_line(int64_t now) {
+	if (reply_head != reply_tail) {
+		strcpy(tx_line, reply[reply_tail++ % REPLY_COUNT]);
+	} else if (notify_ms && !address) {
+		if (!notify_burst) {
+			if (now - notify_last < (int64_t)notify_ms * 1000000) {
+				return;
+			}
+			notify_burst = 1;				// all the pending ones go out together
+			notify_last = now;
+		}
+		uint32_t state = 0;
+		while ((state < STATE_COUNT) && !notify_pending[state]) {
+			state++;
+		}
+		if (state == STATE_COUNT) {
+			notify_burst = 0;
+			return;
+		}
+		notify_pending[state] = 0;
+		snprintf(tx_line, LINE_LENGTH, "%s %ld", name[state], (long)value[state]);
+		count_notifications++;
+	} else {
+		return;
+	}
+	if (verbose) {
+		printf("-> %s\n", tx_line);
+	}
+	tx_length = strlen(tx_line);
+	tx_line[tx_length++] = END_OF_STRING;
+	tx_position = 0;
+}
+
+/** ***************************************************************************
+ * @brief Check whether notifications are still pending
+ * @return 1 = at least one
+ *****************************************************************************/
+static int lamp_notify_pending(void) {
+	for (uint32_t state = 0; state < STATE_COUNT; state++) {
+		if (notify_pending[state]) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/** ***************************************************************************
+ * @brief Serve the pseudo-terminal until the other side closes it
+ *****************************************************************************/
+int main(int argc, char *argv[]) {
+	long baudrate = BAUDRATE;
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s pty [-a address] [-b baud] [-p period] [-v]\n", argv[0]);
+		return 1;
+	}
+	for (int i = 2; i < argc; i++) {
+		if ((0 == strcmp(argv[i], "-a")) && (i + 1 < argc)) {
+			address = atoi(argv[++i]);
+		} else if ((0 == strcmp(argv[i], "-b")) && (i + 1 < argc)) {
+			baudrate = atol(argv[++i]);
+		} else if ((0 == strcmp(argv[i], "-p")) && (i + 1 < argc)) {
+			pwm_ns = atol(argv[++i]) * 1000LL;
+		} else if (0 == strcmp(argv[i], "-v")) {
+			verbose = 1;
+		}
+	}
+	fd = open(argv[1], O_RDWR | O_NOCTTY | O_NONBLOCK);
+	if (fd < 0) {
+		perror(argv[1]);
+		return 1;
+	}
+	struct termios tio;
+	tcgetattr(fd, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(fd, TCSANOW, &tio);
+	CMD_SetAddress(address, group);
+	char_ns = 10 * 1000000000LL / baudrate;	// start, 8 data, stop bit
+
+	char line[LINE_LENGTH];
+	size_t length = 0;
+	int64_t now = now_ns();
+	int64_t next_rx = now;
+	int64_t next_tx = now;
+	int64_t next_tick = now + TICK_NS;
+	int64_t next_pwm = now + pwm_ns;
+	notify_last = now - (int64_t)NOTIFY_MS * 1000000;
+	for (;;) {
+		now = now_ns();
+		int64_t next = next_tick;
+		if (next_rx < next) {
+			next = next_rx;
+		}
+		if ((tx_position < tx_length) && (next_tx < next)) {
+			next = next_tx;
+		}
+		if (LAT_Staged() && (next_pwm < next)) {
+			next = next_pwm;
+		}
+		if (next > now) {
+			struct pollfd p = { .fd = fd, .events = 0 };
+			int wait_ms = (int)((next - now + 999999) / 1000000);
+			poll(&p, 1, wait_ms);			// only for the hang-up
+			if (p.revents & (POLLHUP | POLLERR)) {
+				break;
+			}
+			continue;
+		}
+
+		if (now >= next_rx) {				// RX interrupt, one character
+			char c;
+			ssize_t n = read(fd, &c, 1);
+			if (1 == n) {
+				if (END_OF_STRING == c) {
+					line[length] = '\0';
+					if (verbose) {
+						printf("<- %s\n", line);
+					}
+					length = 0;
+					count_lines++;
+				} else if (length < sizeof(line) - 1) {
+					line[length++] = c;
+				}
+				if (END_OF_STRING == c) {
+					CMD_Stamp(ns_to_ticks(now));
+				}
+				CMD_Parse((END_OF_STRING == c) ? CMD_END_OF_LINE : c);
+				next_rx += char_ns;
+				if (next_rx < now) {
+					next_rx = now;			// the line was idle
+				}
+			} else if ((0 == n) || ((EAGAIN != errno) && (EINTR != errno))) {
+				break;						// the other side has closed
+			} else {
+				next_rx = now + char_ns;	// nothing yet, look again
+			}
+		}
+
+		if (now >= next_pwm) {				// TIMER0 interrupt, start of a period
+			if (LAT_Staged()) {
+				LAT_Commit(ns_to_ticks(next_pwm));
+			}
+			next_pwm += ((now - next_pwm) / pwm_ns + 1) * pwm_ns;
+		}
+
+		if (now >= next_tick) {				// main loop
+			lamp_tick(now);
+			next_tick += TICK_NS;
+		}
+
+		if ((tx_position == tx_length)
+				&& ((reply_head != reply_tail) || lamp_notify_pending())) {
+			lamp_next_line(now);
+			if (next_tx < now) {
+				next_tx = now;
+			}
+		}
+		if ((tx_position < tx_length) && (now >= next_tx)) {	// TX interrupt
+			if (write(fd, &tx_line[tx_position], 1) == 1) {
+				tx_position++;
+				next_tx += char_ns;
+			} else if ((EAGAIN != errno) && (EINTR != errno)) {
+				break;
+			}
+		}
+		fflush(stdout);
+	}
+	printf("lampsim: lines %u changes %u replies %u notifications %u lost %u dropped %u\n",
+			count_lines, count_changes, count_replies, count_notifications,
+			count_lost, CMD_GetDropped());
+	return 0;
+}
@@ -0,0 +1,357 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host tool: latency and throughput of the controller library
+ *
+ * Runs tools/moodlight.cpp against the lamp simulation (tools/lampsim.c),
+ * each scenario with a new lamp behind a new pseudo-terminal:
+ * - set points and queries one at a time (window 1) and pipelined
+ *   (window CMD_WINDOW), latency per request and requests per second,
+ * - a slider: a new value every ms, coalesced to what the lamp takes,
+ *   checked with the notification of the last value,
+ * - a reconnection: the lamp is killed while set points are in flight,
+ *   the controller opens a new one and all the set points have to arrive.
+ *
+ * Usage (on the PC, not on the target):
+ * @n gcc -I../src/inc -o lampsim lampsim.c ../src/commands.c ../src/latency.c
+ * @n g++ -std=c++17 -o mlbench mlbench.cpp moodlight.cpp
+ * @n ./mlbench [lampsim] [-v]
+ *
+ * lampsim is the path of the simulation, default ./lampsim,
+ * -v shows the counters of the simulation.
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#include "moodlight.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <signal.h>
+#include <string>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace moodlight;
+using std::chrono::milliseconds;
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+constexpr int REQUEST_COUNT = 200;			///< per pipelining scenario
+constexpr int SLIDER_MS = 2000;				///< duration of the slider
+constexpr int RECONNECT_COUNT = 100;		///< set points over the reconnection
+constexpr int KILL_LEFT = 5;				///< set points not answered at the kill
+constexpr int RUN_LIMIT_MS = 30000;			///< a scenario fails after
+
+static const char *lampsim = "./lampsim";
+static bool verbose = false;
+static pid_t lamp_pid = -1;
+static int failures = 0;
+
+/** Results of a scenario */
+struct Result {
+	std::vector<double> latency_ms;
+	int completed = 0;
+	int failed = 0;
+	double seconds = 0;
+};
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Start a simulated lamp behind a new pseudo-terminal
+ * @return fd of the controller side or -1
+ *
+ * The lamp keeps its side open until it ends,
+ * so the controller sees a hang-up when the lamp is killed.
+ *****************************************************************************/
+static int lamp_start() {
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	if ((master < 0) || grantpt(master) || unlockpt(master)) {
+		perror("posix_openpt");
+		return -1;
+	}
+	std::string path = ptsname(master);
+	int slave = open(path.c_str(), O_RDWR | O_NOCTTY);
+	if (slave < 0) {
+		perror(path.c_str());
+		close(master);
+		return -1;
+	}
+	struct termios tio;						// no echo before the lamp is up
+	tcgetattr(slave, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(slave, TCSANOW, &tio);
+	pid_t pid = fork();
+	if (0 == pid) {
+		close(master);
+		if (!verbose) {
+			int null = open("/dev/null", O_WRONLY);
+			dup2(null, STDOUT_FILENO);
+		}
+		execl(lampsim, lampsim, path.c_str(), (char *)nullptr);
+		perror(lampsim);
+		_exit(127);
+	}
+	close(slave);
+	lamp_pid = pid;
+	return master;
+}
+
+/** ***************************************************************************
+ * @brief Wait for the end of the current lamp
+ * @param [in] kill_it true = kill it first
+ *****************************************************************************/
+static void lamp_stop(bool kill_it) {
+	if (lamp_pid > 0) {
+		if (kill_it) {
+			kill(lamp_pid, SIGKILL);
+		}
+		waitpid(lamp_pid, nullptr, 0);
+		lamp_pid = -1;
+	}
+}
+
+/** ***************************************************************************
+ * @brief Time since a start
+ * @param [in] start time
+ * @return ms
+ *****************************************************************************/
+static double since_ms(Clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/** ***************************************************************************
+ * @brief Run a controller until a condition holds
+ * @param [in] controller to run
+ * @param [in] done condition
+ * @return false = RUN_LIMIT_MS passed
+ *****************************************************************************/
+template <typename Condition>
+static bool run_until(Controller &controller, Condition done) {
+	Clock::time_point start = Clock::now();
+	while (!done()) {
+		if (since_ms(start) > RUN_LIMIT_MS) {
+			return false;
+		}
+		controller.run(milliseconds(10));
+	}
+	return true;
+}
+
+/** ***************************************************************************
+ * @brief Print a result
+ * @param [in] name of the scenario
+ * @param [in] result to print
+ *****************************************************************************/
+static void print_result(const char *name, Result &result) {
+	std::sort(result.latency_ms.begin(), result.latency_ms.end());
+	size_t n = result.latency_ms.size();
+	double p50 = n ? result.latency_ms[n / 2] : 0;
+	double p99 = n ? result.latency_ms[n * 99 / 100] : 0;
+	double max = n ? result.latency_ms[n - 1] : 0;
+	printf("%-22s %5d done %3d failed  %7.1f /s  latency p50 %6.1f p99 %6.1f max %6.1f ms\n",
+			name, result.completed, result.failed, result.completed / result.seconds,
+			p50, p99, max);
+	if (result.failed) {
+		failures++;
+	}
+}
+
+/** ***************************************************************************
+ * @brief Send requests, a new one as soon as the window allows
+ * @param [in] name of the scenario
+ * @param [in] window requests in flight
+ * @param [in] set_window set points in flight
+ * @param [in] query true = "sub" queries, false = set points
+ *
+ * Set points go to changing states with changing values
+ * and are not coalesced, so each one reaches the lamp.
+ *****************************************************************************/
+static void bench_window(const char *name, int window, int set_window, bool query) {
+	Options options;
+	options.window = window;
+	options.set_window = set_window;
+	options.coalesce = false;
+	Controller controller(lamp_start, options);
+	static const char *state[] = { "white", "amber", "red", "green", "blue" };
+	Result result;
+	Callback done = [&](const Reply &reply) {
+		if (Status::OK == reply.status) {
+			result.latency_ms.push_back(reply.latency.count() / 1000.0);
+			result.completed++;
+		} else {
+			result.failed++;
+		}
+	};
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < REQUEST_COUNT; i++) {
+		if (query) {
+			controller.request(ADDRESS_NONE, "sub", done);
+		} else {
+			controller.set(ADDRESS_NONE, state[i % 5], i, done);
+		}
+	}
+	if (!run_until(controller, [&]() { return controller.idle(); })) {
+		printf("%s: not idle\n", name);
+	}
+	result.seconds = since_ms(start) / 1000;
+	print_result(name, result);
+	if (controller.stats().writes && verbose) {
+		printf("%22s %5lu lines in %lu writes\n", "",
+				(unsigned long)controller.stats().lines,
+				(unsigned long)controller.stats().writes);
+	}
+}
+
+/** ***************************************************************************
+ * @brief Move a slider: a new value every ms
+ *
+ * The lamp takes one set point per tick of its main loop,
+ * without coalescing the requests would pile up.
+ * The notification of the last value has to come within 200 ms.
+ *****************************************************************************/
+static void bench_slider() {
+	Controller controller(lamp_start);
+	long notified = -1;
+	controller.onNotify([&](int address, const std::string &line) {
+		(void)address;
+		if (0 == line.compare(0, 6, "white ")) {
+			notified = atol(line.c_str() + 6);
+		}
+	});
+	Result result;
+	int coalesced = 0;
+	Callback done = [&](const Reply &reply) {
+		if (Status::OK == reply.status) {
+			if (reply.latency.count()) {	// not skipped
+				result.latency_ms.push_back(reply.latency.count() / 1000.0);
+			}
+			result.completed++;
+		} else if (Status::COALESCED == reply.status) {
+			coalesced++;
+		} else {
+			result.failed++;
+		}
+	};
+	Clock::time_point start = Clock::now();
+	long value = 0;
+	int updates = 0;
+	while (since_ms(start) < SLIDER_MS) {
+		value = (long)(since_ms(start) / 10);	// 0 ... 200 %
+		controller.set(ADDRESS_NONE, "white", value, done);
+		updates++;
+		controller.run(milliseconds(1));
+	}
+	Clock::time_point last = Clock::now();
+	bool arrived = run_until(controller, [&]() { return notified == value; });
+	double settle = since_ms(last);
+	result.seconds = since_ms(start) / 1000;
+	print_result("slider, coalesced", result);
+	const Stats &stats = controller.stats();
+	printf("%22s %5d updates -> %lu lines, %d coalesced, %lu skipped, "
+			"last value %s after %.1f ms\n", "", updates,
+			(unsigned long)stats.lines, coalesced, (unsigned long)stats.skipped,
+			arrived ? "shown" : "NOT shown", settle);
+	if (!arrived || (settle > 200)) {
+		failures++;
+	}
+}
+
+/** ***************************************************************************
+ * @brief Kill the lamp while set points are in flight
+ *
+ * The set points go to changing states and are not coalesced,
+ * the ones in flight at the kill have to be sent again to the new lamp,
+ * which has to notify the last value of each state.
+ *****************************************************************************/
+static void bench_reconnect() {
+	Options options;
+	options.coalesce = false;
+	Controller controller(lamp_start, options);
+	static const char *state[] = { "white", "amber", "red", "green", "blue" };
+	long notified[5] = { -1, -1, -1, -1, -1 };
+	controller.onNotify([&](int address, const std::string &line) {
+		(void)address;
+		for (int s = 0; s < 5; s++) {
+			size_t length = strlen(state[s]);
+			if ((0 == line.compare(0, length, state[s])) && (' ' == line[length])) {
+				notified[s] = atol(line.c_str() + length + 1);
+			}
+		}
+	});
+	Result result;
+	Callback done = [&](const Reply &reply) {
+		if ((Status::OK == reply.status) || (Status::COALESCED == reply.status)) {
+			result.latency_ms.push_back(reply.latency.count() / 1000.0);
+			result.completed++;
+		} else {
+			result.failed++;
+		}
+	};
+	Clock::time_point start = Clock::now();
+	for (int i = 0; i < RECONNECT_COUNT; i++) {
+		controller.set(ADDRESS_NONE, state[i % 5], i, done);
+	}
+	run_until(controller, [&]() { return result.completed >= RECONNECT_COUNT - KILL_LEFT; });
+	lamp_stop(true);						// the rest goes to a new lamp
+	Clock::time_point killed = Clock::now();
+	bool arrived = run_until(controller, [&]() {
+		bool shown = controller.idle();
+		for (int s = 0; s < 5; s++) {
+			shown = shown && (notified[s] == RECONNECT_COUNT - 5 + s);
+		}
+		return shown;
+	});
+	double recovery = since_ms(killed);
+	result.seconds = since_ms(start) / 1000;
+	print_result("reconnection", result);
+	const Stats &stats = controller.stats();
+	printf("%22s %lu reconnects, %lu retries, last values %s after %.1f ms\n", "",
+			(unsigned long)stats.reconnects, (unsigned long)stats.retries,
+			arrived ? "shown" : "NOT shown", recovery);
+	if (!arrived || !stats.reconnects || !stats.retries) {
+		failures++;
+	}
+}
+
+/** ***************************************************************************
+ * @brief Run all the scenarios
+ *****************************************************************************/
+int main(int argc, char *argv[]) {
+	for (int i = 1; i < argc; i++) {
+		if (0 == strcmp(argv[i], "-v")) {
+			verbose = true;
+		} else {
+			lampsim = argv[i];
+		}
+	}
+	signal(SIGPIPE, SIG_IGN);
+	setvbuf(stdout, nullptr, _IOLBF, 0);
+	bench_window("set points, window 1", 1, 1, false);
+	lamp_stop(false);						// ends with the controller
+	bench_window("set points, window 2", WINDOW, 2, false);
+	lamp_stop(false);
+	bench_window("set points, window 8", WINDOW, WINDOW, false);
+	lamp_stop(false);
+	bench_window("queries, window 1", 1, 1, true);
+	lamp_stop(false);
+	bench_window("queries, window 8", WINDOW, WINDOW, true);
+	lamp_stop(false);
+	bench_slider();
+	lamp_stop(false);
+	bench_reconnect();
+	lamp_stop(false);
+	printf("%s\n", failures ? "FAILED" : "passed");
+	return failures ? 1 : 0;
+}
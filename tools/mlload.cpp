@@ -0,0 +1,382 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host tool: load generator for the remote control of a lamp
+ *
+ * Drives a lamp with a mix of commands at a given rate
+ * through the controller library (tools/moodlight.cpp) and reports
+ * - the throughput: commands answered per second,
+ * - the errors, the commands lost (no answer) and the ones shed
+ *   because more than BACKLOG_MAX were waiting on the PC,
+ * - the latency on the PC: from the command being generated
+ *   to its answer, including the wait for the window,
+ * - the commands dropped by the lamp ("drop") and the latency
+ *   of the state commands from the end of their line
+ *   to the LED driver, measured by the lamp ("lat 0 ...", see latency.c).
+ *
+ * The lamp is either the simulation (tools/lampsim.c) behind a new
+ * pseudo-terminal with a modelled baud rate, or a real one (-d).
+ *
+ * Usage (on the PC, not on the target):
+ * @n gcc -I../src/inc -o lampsim lampsim.c ../src/commands.c ../src/latency.c
+ * @n g++ -std=c++17 -o mlload mlload.cpp moodlight.cpp
+ * @n ./mlload [-d device | -s lampsim] [-b baud] [-r rate] [-t seconds]
+ *             [-m mix] [-w window] [-c] [-B]
+ *
+ * -d the serial port of a lamp, else the simulation is started,
+ * -s the path of the simulation (default ./lampsim),
+ * -b its baud rate (default 9600),
+ * -r commands per second, 0 = as fast as the window allows (default 20),
+ * at random times (Poisson), so they don't lock to the main loop of the lamp,
+ * -t the duration in s (default 10),
+ * -m the mix of the commands with their weights
+ * (default "red=3,green=3,blue=3,white=1,sub=1"),
+ * the states get random values, the other commands none,
+ * -w the requests in flight (default CMD_WINDOW),
+ * -c coalesces the set points,
+ * -B runs the benchmark: the mix at several rates and as fast as possible.
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#include "moodlight.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <random>
+#include <signal.h>
+#include <string>
+#include <sys/wait.h>
+#include <termios.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace moodlight;
+using std::chrono::milliseconds;
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+constexpr int BACKLOG_MAX = 64;				///< more waiting commands are shed
+constexpr int DRAIN_MS = 5000;				///< max wait for the last answers
+constexpr int VALUE_MAX = 255;				///< PWR_VALUE_MAX of the firmware
+constexpr int KELVIN_MIN = 2000;			///< CCT_KELVIN_MIN of the firmware
+constexpr int KELVIN_MAX = 6500;			///< CCT_KELVIN_MAX of the firmware
+constexpr int LAT_INFO_COUNT = 7;			///< count, min, avg, p50, p90, p99, max
+
+/** A command of the mix */
+struct Entry {
+	std::string name;
+	bool state;								///< set point with a random value
+	int weight;
+};
+
+/** Settings of a run */
+struct Config {
+	std::string device;						///< empty = simulation
+	std::string lampsim = "./lampsim";
+	std::string baudrate = "9600";
+	double rate = 20;						///< 0 = as fast as the window allows
+	int seconds = 10;
+	std::string mix = "red=3,green=3,blue=3,white=1,sub=1";
+	int window = WINDOW;
+	bool coalesce = false;
+};
+
+/** Results of a run */
+struct Result {
+	int offered = 0;
+	int completed = 0;
+	int errors = 0;
+	int lost = 0;							///< no answer
+	int shed = 0;							///< not sent, too many waiting
+	int outstanding = 0;
+	std::vector<double> latency_ms;
+	double seconds = 0;
+	long dropped = 0;						///< by the lamp
+	long lamp[LAT_INFO_COUNT] = { 0 };		///< "lat 0 ...", us
+};
+
+static Config config;
+static pid_t lamp_pid = -1;
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Start the simulated lamp behind a new pseudo-terminal
+ * @return fd of the controller side or -1
+ *****************************************************************************/
+static int lamp_start() {
+	int master = posix_openpt(O_RDWR | O_NOCTTY);
+	if ((master < 0) || grantpt(master) || unlockpt(master)) {
+		perror("posix_openpt");
+		return -1;
+	}
+	std::string path = ptsname(master);
+	int slave = open(path.c_str(), O_RDWR | O_NOCTTY);
+	if (slave < 0) {
+		perror(path.c_str());
+		close(master);
+		return -1;
+	}
+	struct termios tio;						// no echo before the lamp is up
+	tcgetattr(slave, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(slave, TCSANOW, &tio);
+	pid_t pid = fork();
+	if (0 == pid) {
+		close(master);
+		int null = open("/dev/null", O_WRONLY);
+		dup2(null, STDOUT_FILENO);
+		execl(config.lampsim.c_str(), config.lampsim.c_str(), path.c_str(),
+				"-b", config.baudrate.c_str(), (char *)nullptr);
+		perror(config.lampsim.c_str());
+		_exit(127);
+	}
+	close(slave);
+	lamp_pid = pid;
+	return master;
+}
+
+/** ***************************************************************************
+ * @brief Wait for the end of the simulated lamp, after the controller
+ *****************************************************************************/
+static void lamp_stop() {
+	if (lamp_pid > 0) {
+		waitpid(lamp_pid, nullptr, 0);
+		lamp_pid = -1;
+	}
+}
+
+/** ***************************************************************************
+ * @brief Parse a mix of commands
+ * @param [in] text e.g. "red=3,sub=1", a missing weight is 1
+ * @return entries, empty if invalid
+ *****************************************************************************/
+static std::vector<Entry> parse_mix(const std::string &text) {
+	static const char *states[] = { "white", "amber", "red", "green", "blue", "cct" };
+	std::vector<Entry> mix;
+	size_t start = 0;
+	while (start < text.size()) {
+		size_t end = text.find(',', start);
+		if (end == std::string::npos) {
+			end = text.size();
+		}
+		std::string item = text.substr(start, end - start);
+		size_t equal = item.find('=');
+		Entry entry;
+		entry.name = item.substr(0, equal);
+		entry.weight = (equal == std::string::npos) ? 1 : atoi(item.c_str() + equal + 1);
+		entry.state = std::any_of(std::begin(states), std::end(states),
+				[&](const char *s) { return entry.name == s; });
+		if (entry.name.empty() || (entry.weight <= 0)) {
+			return {};
+		}
+		mix.push_back(entry);
+		start = end + 1;
+	}
+	return mix;
+}
+
+/** ***************************************************************************
+ * @brief Time since a start
+ * @param [in] start time
+ * @return ms
+ *****************************************************************************/
+static double since_ms(Clock::time_point start) {
+	return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+/** ***************************************************************************
+ * @brief Send a query and wait for its answer
+ * @param [in] controller of the lamp
+ * @param [in] command e.g. "drop"
+ * @return first value of the answer, -1 without
+ *****************************************************************************/
+static long query(Controller &controller, const std::string &command) {
+	long value = -1;
+	bool done = false;
+	controller.request(ADDRESS_NONE, command, [&](const Reply &reply) {
+		if ((Status::OK == reply.status) && !reply.values.empty()) {
+			value = reply.values[0];
+		}
+		done = true;
+	});
+	Clock::time_point start = Clock::now();
+	while (!done && (since_ms(start) < DRAIN_MS)) {
+		controller.run(milliseconds(10));
+	}
+	return value;
+}
+
+/** ***************************************************************************
+ * @brief Run the mix at a rate
+ * @param [in] mix commands with their weights
+ * @param [in] rate commands per second, 0 = as fast as the window allows
+ * @return results
+ *****************************************************************************/
+static Result run(const std::vector<Entry> &mix, double rate) {
+	Options options;
+	options.window = config.window;
+	options.coalesce = config.coalesce;
+	Opener opener = config.device.empty() ? Opener(lamp_start) : Opener();
+	Controller controller = config.device.empty()
+			? Controller(opener, options) : Controller(config.device, options);
+	Result result;
+
+	query(controller, "lat 0");				// clears the samples
+	long dropped = query(controller, "drop");
+
+	std::mt19937 random(1);
+	int total = 0;
+	for (auto &entry : mix) {
+		total += entry.weight;
+	}
+	Clock::time_point start = Clock::now();
+	Clock::time_point next = start;
+	std::exponential_distribution<double> interval(rate > 0 ? rate : 1);
+	while (since_ms(start) < config.seconds * 1000.0) {
+		bool due = (rate > 0) ? (Clock::now() >= next)
+				: (result.outstanding < config.window);
+		if (!due) {
+			auto wait = std::chrono::duration_cast<milliseconds>(next - Clock::now());
+			controller.run((rate > 0) ? std::max(milliseconds(0), wait) : milliseconds(10));
+			continue;
+		}
+		next += std::chrono::duration_cast<Clock::duration>(
+				std::chrono::duration<double>(interval(random)));
+		result.offered++;
+		if (result.outstanding >= BACKLOG_MAX) {
+			result.shed++;
+			continue;
+		}
+		int pick = std::uniform_int_distribution<int>(0, total - 1)(random);
+		const Entry *entry = &mix[0];
+		for (auto &e : mix) {
+			if (pick < e.weight) {
+				entry = &e;
+				break;
+			}
+			pick -= e.weight;
+		}
+		Clock::time_point issued = Clock::now();
+		Callback done = [&result, issued](const Reply &reply) {
+			result.outstanding--;
+			switch (reply.status) {
+			case Status::OK:
+			case Status::COALESCED:
+				result.completed++;
+				result.latency_ms.push_back(since_ms(issued));
+				break;
+			case Status::ERROR:
+				result.errors++;
+				break;
+			default:
+				result.lost++;
+			}
+		};
+		result.outstanding++;
+		if (entry->state) {
+			long value = ("cct" == entry->name)
+					? std::uniform_int_distribution<long>(KELVIN_MIN, KELVIN_MAX)(random)
+					: std::uniform_int_distribution<long>(0, VALUE_MAX)(random);
+			controller.set(ADDRESS_NONE, entry->name, value, done);
+		} else {
+			controller.request(ADDRESS_NONE, entry->name, done);
+		}
+	}
+	Clock::time_point end = Clock::now();
+	while (!controller.idle() && (since_ms(end) < DRAIN_MS)) {
+		controller.run(milliseconds(10));
+	}
+	result.seconds = since_ms(start) / 1000;
+
+	result.dropped = query(controller, "drop") - dropped;
+	for (int info = 0; info < LAT_INFO_COUNT; info++) {
+		result.lamp[info] = query(controller, "lat 0 " + std::to_string(info));
+	}
+	return result;
+}
+
+/** ***************************************************************************
+ * @brief Print the header of the results
+ *****************************************************************************/
+static void print_header() {
+	printf("  rate offered  done  err lost shed   cmd/s   pc p50    p99 ms"
+			"  drop   lamp n  p50    p99    max ms\n");
+}
+
+/** ***************************************************************************
+ * @brief Print a result
+ * @param [in] rate offered, 0 = as fast as the window allows
+ * @param [in] result of the run
+ *****************************************************************************/
+static void print_result(double rate, Result &result) {
+	std::sort(result.latency_ms.begin(), result.latency_ms.end());
+	size_t n = result.latency_ms.size();
+	double p50 = n ? result.latency_ms[n / 2] : 0;
+	double p99 = n ? result.latency_ms[n * 99 / 100] : 0;
+	char offered[16] = "   max";
+	if (rate > 0) {
+		snprintf(offered, sizeof(offered), "%6.0f", rate);
+	}
+	printf("%s %7d %5d %4d %4d %4d %7.1f %8.1f %6.1f %5ld %8ld %5.1f %6.1f %6.1f\n",
+			offered, result.offered, result.completed, result.errors, result.lost,
+			result.shed, result.completed / result.seconds, p50, p99, result.dropped,
+			result.lamp[0], result.lamp[3] / 1000.0, result.lamp[5] / 1000.0,
+			result.lamp[6] / 1000.0);
+}
+
+/** ***************************************************************************
+ * @brief Run the load or the benchmark
+ *****************************************************************************/
+int main(int argc, char *argv[]) {
+	bool benchmark = false;
+	int option;
+	while ((option = getopt(argc, argv, "d:s:b:r:t:m:w:cB")) != -1) {
+		switch (option) {
+		case 'd': config.device = optarg; break;
+		case 's': config.lampsim = optarg; break;
+		case 'b': config.baudrate = optarg; break;
+		case 'r': config.rate = atof(optarg); break;
+		case 't': config.seconds = atoi(optarg); break;
+		case 'm': config.mix = optarg; break;
+		case 'w': config.window = atoi(optarg); break;
+		case 'c': config.coalesce = true; break;
+		case 'B': benchmark = true; break;
+		default:
+			fprintf(stderr, "usage: %s [-d device | -s lampsim] [-b baud] [-r rate]"
+					" [-t seconds] [-m mix] [-w window] [-c] [-B]\n", argv[0]);
+			return 1;
+		}
+	}
+	std::vector<Entry> mix = parse_mix(config.mix);
+	if (mix.empty()) {
+		fprintf(stderr, "invalid mix: %s\n", config.mix.c_str());
+		return 1;
+	}
+	signal(SIGPIPE, SIG_IGN);
+	setvbuf(stdout, nullptr, _IOLBF, 0);
+	printf("mix %s, window %d, %s, %s\n", config.mix.c_str(), config.window,
+			config.coalesce ? "coalesced" : "not coalesced",
+			config.device.empty() ? ("simulation at " + config.baudrate + " baud").c_str()
+					: config.device.c_str());
+	print_header();
+	std::vector<double> rates = { config.rate };
+	if (benchmark) {
+		rates = { 5, 10, 20, 40, 80, 0 };
+	}
+	for (double rate : rates) {
+		Result result = run(mix, rate);
+		lamp_stop();						// ends with the controller
+		print_result(rate, result);
+	}
+	return 0;
+}
@@ -0,0 +1,648 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host library: controller of one or more lamps on a serial link
+ *
+ * A request goes through three stages:
+ * waiting (in the order of the calls) -> in flight (per lamp, in the order
+ * sent) -> completed (callback called after the controller is consistent,
+ * so a callback may send the next request).
+ * @n The firmware answers the requests of a lamp in order,
+ * so a reply to a later id means the earlier ones have been lost,
+ * e.g. dropped by a full command queue or garbled on the link.
+ *
+ * Usage (on the PC, not on the target), see tools/mlbench.cpp:
+ * @n g++ -std=c++17 -c moodlight.cpp
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#include "moodlight.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+
+namespace moodlight {
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+constexpr size_t LINE_MAX = 256;			///< longer lines are cut
+constexpr size_t READ_SIZE = 256;			///< bytes per read()
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Open a serial port or pseudo-terminal like the lamp expects it
+ * @param [in] path e.g. /dev/ttyUSB0 or /dev/pts/3
+ * @return fd or -1
+ *
+ * Raw, 8 data bits, no parity, 1 stop bit, BAUDRATE.
+ *****************************************************************************/
+static int open_serial(const std::string &path) {
+	int fd = ::open(path.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK);
+	if (fd < 0) {
+		return -1;
+	}
+	struct termios tio;
+	if (0 == tcgetattr(fd, &tio)) {
+		cfmakeraw(&tio);
+		cfsetspeed(&tio, B9600);
+		tio.c_cflag |= CLOCAL | CREAD;
+		tcsetattr(fd, TCSANOW, &tio);
+	}
+	return fd;
+}
+
+/** ***************************************************************************
+ * @brief Create a controller for a serial port or pseudo-terminal
+ * @param [in] path opened again after a failure
+ * @param [in] options see Options
+ *****************************************************************************/
+Controller::Controller(const std::string &path, Options options)
+	: Controller(Opener([path]() { return open_serial(path); }), options) {
+}
+
+/** ***************************************************************************
+ * @brief Create a controller for any link
+ * @param [in] opener called to open the link and after a failure
+ * @param [in] options see Options
+ *****************************************************************************/
+Controller::Controller(Opener opener, Options options)
+	: opener_(std::move(opener)), options_(options) {
+	options_.window = std::clamp(options_.window, 1, WINDOW);
+	options_.set_window = std::clamp(options_.set_window, 1, options_.window);
+	reopen_at_ = Clock::now();
+	open_link();
+}
+
+/** ***************************************************************************
+ * @brief Close the link, requests not completed are dropped
+ *****************************************************************************/
+Controller::~Controller() {
+	if (fd_ >= 0) {
+		::close(fd_);
+	}
+}
+
+/** ***************************************************************************
+ * @brief Send a command
+ * @param [in] address of the lamp, ADDRESS_NONE, ADDRESS_ALL or group()
+ * @param [in] command e.g. "sub 50", without address and id
+ * @param [in] done called with the reply, once the command has been sent
+ *             for a group or for all the lamps
+ *
+ * A command may change any set point, so they are sent again by set().
+ *****************************************************************************/
+void Controller::request(int address, const std::string &command, Callback done) {
+	stats_.requests++;
+	forget(address, "");
+	waiting_.push_back(Pending{ address, command, "", 0, std::move(done),
+			serial_++, 0, 0, Clock::time_point() });
+	pump();
+	deliver();
+}
+
+/** ***************************************************************************
+ * @brief Set the value of a state, e.g. "red 80"
+ * @param [in] address of the lamp, ADDRESS_NONE, ADDRESS_ALL or group()
+ * @param [in] state e.g. "red" or "cct"
+ * @param [in] value new set point
+ * @param [in] done called with the reply, Status::COALESCED when replaced
+ *
+ * A set point still waiting for the same lamp and state is replaced,
+ * so a slider sends only as fast as the lamp takes the values.
+ * A set point equal to the last one sent to a lamp is completed at once.
+ *****************************************************************************/
+void Controller::set(int address, const std::string &state, long value, Callback done) {
+	stats_.requests++;
+	if (options_.coalesce) {
+		auto previous = std::find_if(waiting_.begin(), waiting_.end(),
+				[&](const Pending &p) { return (p.address == address) && (p.state == state); });
+		if (previous != waiting_.end()) {	// the newer one goes to the back
+			Reply answer;
+			answer.status = Status::COALESCED;
+			answer.address = address;
+			complete(*previous, answer);
+			waiting_.erase(previous);
+			stats_.coalesced++;
+		}
+		auto last = last_.find({ address, state });
+		if ((last != last_.end()) && (last->second == value)) {
+			Reply answer;
+			answer.address = address;
+			answer.text = "ok";
+			Pending skipped{ address, "", state, value, std::move(done), 0, 0, 0,
+					Clock::time_point() };
+			complete(skipped, answer);
+			stats_.skipped++;
+			deliver();
+			return;
+		}
+	}
+	if (address >= ADDRESS_ALL) {
+		forget(address, state);
+	}
+	waiting_.push_back(Pending{ address, state + " " + std::to_string(value), state,
+			value, std::move(done), serial_++, 0, 0, Clock::time_point() });
+	pump();
+	deliver();
+}
+
+/** ***************************************************************************
+ * @brief Receive the notifications of the lamps
+ * @param [in] notify called with the address and the line without address
+ *****************************************************************************/
+void Controller::onNotify(Notify notify) {
+	notify_ = std::move(notify);
+}
+
+/** ***************************************************************************
+ * @brief Get the fd to poll
+ * @return fd or -1 while disconnected, see run()
+ *****************************************************************************/
+int Controller::fd() const {
+	return fd_;
+}
+
+/** ***************************************************************************
+ * @brief Get the events to poll
+ * @return POLLIN and POLLOUT while lines could not be written
+ *****************************************************************************/
+short Controller::events() const {
+	return (fd_ < 0) ? 0 : (POLLIN | (tx_.empty() ? 0 : POLLOUT));
+}
+
+/** ***************************************************************************
+ * @brief Handle the events of the link and the timeouts
+ * @param [in] revents returned by poll(), 0 = only the timeouts
+ *
+ * Has to be called at least every few ms while requests are in flight
+ * and while disconnected.
+ *****************************************************************************/
+void Controller::process(short revents) {
+	Clock::time_point now = Clock::now();
+	if ((fd_ < 0) && (now >= reopen_at_)) {
+		open_link();
+	}
+	if ((fd_ >= 0) && (revents & POLLIN)) {
+		receive();
+	}
+	if ((fd_ >= 0) && (revents & (POLLERR | POLLHUP | POLLNVAL))) {
+		close_link();						// e.g. the adapter has been unplugged
+	}
+	expire(now);
+	pump();
+	flush();
+	deliver();
+}
+
+/** ***************************************************************************
+ * @brief Wait for the link and handle it
+ * @param [in] timeout max time to wait
+ *****************************************************************************/
+void Controller::run(std::chrono::milliseconds timeout) {
+	Clock::time_point now = Clock::now();
+	Clock::time_point until = now + timeout;
+	for (auto &lamp : flight_) {			// the next timeout of a request
+		if (!lamp.second.empty()) {
+			until = std::min(until, lamp.second.front().sent + options_.timeout);
+		}
+	}
+	if (fd_ < 0) {
+		until = std::min(until, reopen_at_);
+		std::this_thread::sleep_until(until);
+		process(0);
+		return;
+	}
+	struct pollfd p = { fd_, events(), 0 };
+	auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(until - now);
+	if (poll(&p, 1, std::max<int>(0, (int)wait.count() + 1)) < 0) {
+		p.revents = 0;
+	}
+	process(p.revents);
+}
+
+/** ***************************************************************************
+ * @brief Check whether all the requests have been completed
+ * @return true = nothing waiting, in flight or being written
+ *****************************************************************************/
+bool Controller::idle() const {
+	for (auto &lamp : flight_) {
+		if (!lamp.second.empty()) {
+			return false;
+		}
+	}
+	return waiting_.empty() && tx_.empty() && completed_.empty();
+}
+
+/** ***************************************************************************
+ * @brief Check whether the link is open
+ * @return true = open, false = waiting to reconnect
+ *****************************************************************************/
+bool Controller::connected() const {
+	return fd_ >= 0;
+}
+
+/** ***************************************************************************
+ * @brief Get the counters
+ * @return counters since the creation
+ *****************************************************************************/
+const Stats &Controller::stats() const {
+	return stats_;
+}
+
+/** ***************************************************************************
+ * @brief Open the link, on failure try again after the backoff
+ *****************************************************************************/
+void Controller::open_link() {
+	fd_ = opener_();
+	if (fd_ < 0) {
+		backoff_ = std::clamp(backoff_ * 2, options_.backoff_min, options_.backoff_max);
+		reopen_at_ = Clock::now() + backoff_;
+		return;
+	}
+	fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) | O_NONBLOCK);
+	if (opened_) {
+		stats_.reconnects++;
+	}
+	opened_ = true;
+	received_ = Clock::now();
+}
+
+/** ***************************************************************************
+ * @brief Close a failed link
+ *
+ * The requests in flight fail, the set points are sent again
+ * after the reconnection, the lamp may have lost them.
+ *****************************************************************************/
+void Controller::close_link() {
+	::close(fd_);
+	fd_ = -1;
+	tx_.clear();
+	rx_.clear();
+	broadcasts_.clear();
+	last_.clear();
+	std::vector<Pending> lost;
+	for (auto &lamp : flight_) {
+		for (auto &pending : lamp.second) {
+			lost.push_back(std::move(pending));
+		}
+		lamp.second.clear();
+	}
+	std::sort(lost.begin(), lost.end(),
+			[](const Pending &a, const Pending &b) { return a.serial < b.serial; });
+	for (auto &pending : lost) {
+		fail(pending, Status::DISCONNECTED);
+	}
+	backoff_ = std::clamp(backoff_ * 2, options_.backoff_min, options_.backoff_max);
+	reopen_at_ = Clock::now() + backoff_;
+}
+
+/** ***************************************************************************
+ * @brief Move the waiting requests in flight as far as the window allows
+ *
+ * A request which has to wait holds back the ones behind it,
+ * so the lamps see the commands in the order of the calls.
+ * The lines are written by process(), all the ones of a loop in one go.
+ *****************************************************************************/
+void Controller::pump() {
+	if (fd_ < 0) {
+		return;
+	}
+	Clock::time_point now = Clock::now();
+	while (!waiting_.empty()) {
+		Pending &pending = waiting_.front();
+		std::string line = prefix(pending.address);
+		if (pending.address >= ADDRESS_ALL) {	// takes room in all the queues
+			bool free = (room(ADDRESS_NONE, now) > 0);
+			for (auto &lamp : flight_) {
+				free = free && (room(lamp.first, now) > 0);
+			}
+			if (!free) {
+				break;
+			}
+			broadcasts_.push_back(now + options_.broadcast_hold);
+			tx_ += line + pending.command + END_OF_STRING;
+			Reply answer;
+			answer.address = pending.address;
+			complete(pending, answer);
+		} else {
+			if ((room(pending.address, now) <= 0)
+					|| (!pending.state.empty() && !room_for_set(pending.address))) {
+				break;
+			}
+			pending.tag = tag_++;			// wraps at TAG_MAX
+			pending.sent = now;
+			tx_ += line + "@" + std::to_string(pending.tag) + " "
+					+ pending.command + END_OF_STRING;
+			if (!pending.state.empty()) {
+				last_[{ pending.address, pending.state }] = pending.value;
+			}
+			flight_[pending.address].push_back(std::move(pending));
+		}
+		stats_.lines++;
+		waiting_.pop_front();
+	}
+}
+
+/** ***************************************************************************
+ * @brief Write as much as the link takes in one go
+ *****************************************************************************/
+void Controller::flush() {
+	while ((fd_ >= 0) && !tx_.empty()) {
+		ssize_t n = ::write(fd_, tx_.data(), tx_.size());
+		if (n > 0) {
+			stats_.writes++;
+			tx_.erase(0, n);
+		} else if ((n < 0) && (EINTR == errno)) {
+			continue;
+		} else if ((n < 0) && ((EAGAIN == errno) || (EWOULDBLOCK == errno))) {
+			break;							// rest with POLLOUT
+		} else {
+			close_link();
+		}
+	}
+}
+
+/** ***************************************************************************
+ * @brief Read the lines of the lamps
+ *****************************************************************************/
+void Controller::receive() {
+	char buffer[READ_SIZE];
+	for (;;) {
+		ssize_t n = ::read(fd_, buffer, sizeof(buffer));
+		if (n > 0) {
+			received_ = Clock::now();
+			for (ssize_t i = 0; i < n; i++) {
+				if ((END_OF_STRING == buffer[i]) || ('\n' == buffer[i])) {
+					if (!rx_.empty()) {
+						reply(rx_);
+						rx_.clear();
+					}
+				} else if (rx_.size() < LINE_MAX) {
+					rx_ += buffer[i];
+				}
+			}
+			if (fd_ < 0) {
+				return;
+			}
+		} else if ((n < 0) && (EINTR == errno)) {
+			continue;
+		} else if ((n < 0) && ((EAGAIN == errno) || (EWOULDBLOCK == errno))) {
+			return;
+		} else {							// end of file or EIO of a pty
+			close_link();
+			return;
+		}
+	}
+}
+
+/** ***************************************************************************
+ * @brief Handle a line of a lamp
+ * @param [in] line "[<adr ][@tag ]text [value ...]"
+ *****************************************************************************/
+void Controller::reply(const std::string &line) {
+	const char *p = line.c_str();
+	char *end;
+	Reply answer;
+	if ('<' == *p) {
+		answer.address = (int)strtol(p + 1, &end, 10);
+		p = end;
+		while (' ' == *p) {
+			p++;
+		}
+	}
+	bool tagged = false;
+	unsigned long tag = 0;
+	if ('@' == *p) {
+		tag = strtoul(p + 1, &end, 10);
+		tagged = (end != p + 1);
+		p = end;
+		while (' ' == *p) {
+			p++;
+		}
+	}
+	if (!tagged) {							// e.g. "red 80"
+		stats_.notifications++;
+		if (notify_) {
+			notify_(answer.address, p);
+		}
+		return;
+	}
+	const char *word = p;
+	while (*p && (' ' != *p)) {
+		p++;
+	}
+	answer.text.assign(word, p);
+	for (;;) {
+		long value = strtol(p, &end, 10);
+		if (end == p) {
+			break;
+		}
+		answer.values.push_back(value);
+		p = end;
+	}
+
+	auto lamp = flight_.find(answer.address);
+	if (lamp == flight_.end()) {
+		return;								// e.g. after a timeout
+	}
+	auto &flight = lamp->second;
+	auto match = std::find_if(flight.begin(), flight.end(),
+			[tag](const Pending &q) { return q.tag == tag; });
+	if (match == flight.end()) {
+		return;
+	}
+	std::vector<Pending> lost(std::make_move_iterator(flight.begin()),
+			std::make_move_iterator(match));
+	Pending pending = std::move(*match);
+	flight.erase(flight.begin(), match + 1);
+	for (auto &earlier : lost) {			// answered in order
+		stats_.timeouts++;
+		fail(earlier, Status::TIMEOUT);
+	}
+	stats_.replies++;
+	backoff_ = std::chrono::milliseconds(0);	// the link works
+	answer.latency = std::chrono::duration_cast<std::chrono::microseconds>(
+			Clock::now() - pending.sent);
+	if ("err" == answer.text) {
+		stats_.errors++;
+		answer.status = Status::ERROR;
+		if (!pending.state.empty()) {
+			forget(pending.address, pending.state);
+		}
+	}
+	complete(pending, answer);
+}
+
+/** ***************************************************************************
+ * @brief Fail the requests not answered in time
+ * @param [in] now time
+ *
+ * When nothing at all comes back the link is opened again.
+ *****************************************************************************/
+void Controller::expire(Clock::time_point now) {
+	bool expired = false;
+	std::vector<Pending> lost;
+	for (auto &lamp : flight_) {
+		auto &flight = lamp.second;
+		while (!flight.empty() && (now - flight.front().sent >= options_.timeout)) {
+			lost.push_back(std::move(flight.front()));
+			flight.pop_front();
+			expired = true;
+		}
+	}
+	for (auto &pending : lost) {
+		stats_.timeouts++;
+		fail(pending, Status::TIMEOUT);
+	}
+	if (expired && (fd_ >= 0) && (now - received_ >= options_.timeout)) {
+		close_link();						// e.g. the lamp has been switched off
+	}
+}
+
+/** ***************************************************************************
+ * @brief Handle a request which has not been answered
+ * @param [in] pending request, moved away
+ * @param [in] status Status::TIMEOUT or Status::DISCONNECTED
+ *
+ * A set point is sent again unless a newer one for the same state
+ * is already on its way.
+ *****************************************************************************/
+void Controller::fail(Pending &pending, Status status) {
+	Reply answer;
+	answer.address = pending.address;
+	if (!pending.state.empty()) {
+		forget(pending.address, pending.state);
+		if (newer(pending)) {
+			answer.status = Status::COALESCED;
+			complete(pending, answer);
+			return;
+		}
+		if (pending.retries < options_.retries) {
+			pending.retries++;
+			stats_.retries++;
+			waiting_.push_back(std::move(pending));
+			return;
+		}
+	}
+	answer.status = status;
+	complete(pending, answer);
+}
+
+/** ***************************************************************************
+ * @brief Complete a request, the callback is called by deliver()
+ * @param [in] pending request
+ * @param [in] answer reply to pass
+ *****************************************************************************/
+void Controller::complete(Pending &pending, const Reply &answer) {
+	if (pending.done) {
+		completed_.emplace_back(std::move(pending.done), answer);
+	}
+}
+
+/** ***************************************************************************
+ * @brief Call the callbacks of the completed requests
+ *****************************************************************************/
+void Controller::deliver() {
+	while (!completed_.empty()) {
+		auto done = std::move(completed_.front());
+		completed_.pop_front();
+		done.first(done.second);
+	}
+}
+
+/** ***************************************************************************
+ * @brief Forget the set points sent, so equal ones are sent again
+ * @param [in] address of a lamp, group() or ADDRESS_ALL = all the lamps
+ * @param [in] state empty = all the states
+ *****************************************************************************/
+void Controller::forget(int address, const std::string &state) {
+	for (auto last = last_.begin(); last != last_.end();) {
+		if (((address >= ADDRESS_ALL) || (last->first.first == address))
+				&& (state.empty() || (last->first.second == state))) {
+			last = last_.erase(last);
+		} else {
+			++last;
+		}
+	}
+}
+
+/** ***************************************************************************
+ * @brief Check for a newer set point of the same lamp and state
+ * @param [in] pending set point
+ * @return true = one is waiting or in flight
+ *****************************************************************************/
+bool Controller::newer(const Pending &pending) const {
+	auto later = [&](const Pending &p) {
+		return (p.address == pending.address) && (p.state == pending.state)
+				&& (p.serial > pending.serial);
+	};
+	if (std::any_of(waiting_.begin(), waiting_.end(), later)) {
+		return true;
+	}
+	auto lamp = flight_.find(pending.address);
+	return (lamp != flight_.end())
+			&& std::any_of(lamp->second.begin(), lamp->second.end(), later);
+}
+
+/** ***************************************************************************
+ * @brief Get the room left in the command queue of a lamp
+ * @param [in] address of the lamp
+ * @param [in] now time
+ * @return requests which may still be sent
+ *****************************************************************************/
+int Controller::room(int address, Clock::time_point now) {
+	while (!broadcasts_.empty() && (broadcasts_.front() <= now)) {
+		broadcasts_.pop_front();			// executed by now
+	}
+	auto lamp = flight_.find(address);
+	int used = (lamp == flight_.end()) ? 0 : (int)lamp->second.size();
+	return options_.window - used - (int)broadcasts_.size();
+}
+
+/** ***************************************************************************
+ * @brief Check whether another set point may be sent to a lamp
+ * @param [in] address of the lamp
+ * @return true = less than Options::set_window in flight
+ *
+ * The lamp takes one set point per tick of its main loop,
+ * more in its queue only delay the newest one, which could replace them.
+ *****************************************************************************/
+bool Controller::room_for_set(int address) const {
+	auto lamp = flight_.find(address);
+	if (lamp == flight_.end()) {
+		return true;
+	}
+	int used = (int)std::count_if(lamp->second.begin(), lamp->second.end(),
+			[](const Pending &p) { return !p.state.empty(); });
+	return used < options_.set_window;
+}
+
+/** ***************************************************************************
+ * @brief Format the address of a line
+ * @param [in] address of a lamp, group() or ADDRESS_ALL
+ * @return e.g. ">3 ", ">g2 ", ">* " or "" for ADDRESS_NONE
+ *****************************************************************************/
+std::string Controller::prefix(int address) {
+	if (ADDRESS_NONE == address) {
+		return "";
+	} else if (ADDRESS_ALL == address) {
+		return ">* ";
+	} else if (address > ADDRESS_ALL) {
+		return ">g" + std::to_string(address - ADDRESS_ALL) + " ";
+	}
+	return ">" + std::to_string(address) + " ";
+}
+
+}
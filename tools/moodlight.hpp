@@ -0,0 +1,194 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host library: controller of one or more lamps on a serial link
+ *
+ * Speaks the remote control protocol of the firmware
+ * (see communication.h, commands.h and userinterface.c) without blocking,
+ * so a host program can drive lamps from its own event loop.
+ * - Pipelining: each request gets a request id ("@17 red 80")
+ *   and up to CMD_WINDOW requests per lamp are in flight,
+ *   the in-order replies are matched to them by the id.
+ *   The lamp takes one set point per tick of its main loop (20 ms),
+ *   so only Options::set_window of them are in flight.
+ * - Batching: the lines are written by process(),
+ *   all the ones requested since the last call in one write.
+ * - Coalescing: a set point which has not been sent yet
+ *   is replaced by a newer one for the same lamp and state,
+ *   a set point equal to the last one sent is not sent again.
+ * - Reconnection: when the link fails it is opened again with backoff,
+ *   requests in flight fail, set points are sent again.
+ *
+ * Commands to a group or to all the lamps are not answered by the firmware,
+ * they are sent as they are and only take room in the queues of the lamps.
+ * Untagged lines of the lamps are notifications, e.g. "red 80".
+ *
+ * Usage (on the PC, not on the target), see tools/mlbench.cpp:
+ * @n g++ -std=c++17 -c moodlight.cpp
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#ifndef MOODLIGHT_HPP_
+#define MOODLIGHT_HPP_
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace moodlight {
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+constexpr char END_OF_STRING = '\r';		///< COM_END_OF_STRING of the firmware
+constexpr int BAUDRATE = 9600;				///< COM_BAUDRATE of the firmware
+constexpr int WINDOW = 8;					///< CMD_WINDOW of the firmware
+constexpr unsigned TAG_MAX = 0xFFFF;		///< CMD_TAG_MAX of the firmware
+constexpr int ADDRESS_NONE = 0;				///< a single lamp, not on a bus
+constexpr int ADDRESS_MAX = 254;			///< CMD_ADDRESS_MAX of the firmware
+constexpr int ADDRESS_ALL = 1000;			///< ">* red 80", not answered
+
+/** Address of a group, ">g2 red 80", not answered */
+constexpr int group(int number) {
+	return ADDRESS_ALL + number;
+}
+
+using Clock = std::chrono::steady_clock;
+
+/** Outcome of a request */
+enum class Status {
+	OK,										///< answered, see Reply::text
+	ERROR,									///< answered with "err n"
+	TIMEOUT,								///< no answer, e.g. dropped by a full queue
+	DISCONNECTED,							///< the link failed while in flight
+	COALESCED,								///< replaced by a newer set point
+};
+
+/** Answer to a request */
+struct Reply {
+	Status status = Status::OK;
+	int address = ADDRESS_NONE;				///< of the lamp which answered
+	std::string text;						///< e.g. "ok", "sub", "err"
+	std::vector<long> values;				///< numbers after the text
+	std::chrono::microseconds latency{0};	///< from the write to the reply
+};
+
+using Callback = std::function<void(const Reply &reply)>;
+using Notify = std::function<void(int address, const std::string &line)>;
+using Opener = std::function<int()>;	///< returns an open fd or -1
+
+/** Settings of a controller */
+struct Options {
+	int window = WINDOW;					///< requests in flight per lamp
+	int set_window = 2;						///< set points in flight per lamp
+	bool coalesce = true;					///< replace and skip set points
+	std::chrono::milliseconds timeout{1000};	///< per request
+	std::chrono::milliseconds broadcast_hold{60};	///< queue room of a broadcast
+	std::chrono::milliseconds backoff_min{50};	///< first reconnection delay
+	std::chrono::milliseconds backoff_max{2000};	///< reconnection delay doubles up to
+	int retries = 3;						///< set points are sent again so often
+};
+
+/** Counters of a controller */
+struct Stats {
+	uint64_t requests = 0;					///< handed to the controller
+	uint64_t lines = 0;						///< written to the link
+	uint64_t writes = 0;					///< write() calls
+	uint64_t replies = 0;
+	uint64_t errors = 0;
+	uint64_t timeouts = 0;
+	uint64_t coalesced = 0;					///< replaced before being sent
+	uint64_t skipped = 0;					///< equal to the last one sent
+	uint64_t retries = 0;
+	uint64_t notifications = 0;
+	uint64_t reconnects = 0;
+};
+
+/******************************************************************************
+ * Classes
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Non-blocking controller of the lamps on one serial link
+ *
+ * Either call run() in a loop or add fd() with events() to an own poll()
+ * and call process() with the events returned.
+ *****************************************************************************/
+class Controller {
+public:
+	explicit Controller(const std::string &path, Options options = Options());
+	explicit Controller(Opener opener, Options options = Options());
+	~Controller();
+	Controller(const Controller &) = delete;
+	Controller &operator=(const Controller &) = delete;
+
+	void request(int address, const std::string &command, Callback done = nullptr);
+	void set(int address, const std::string &state, long value, Callback done = nullptr);
+	void onNotify(Notify notify);
+
+	int fd() const;
+	short events() const;
+	void process(short revents);
+	void run(std::chrono::milliseconds timeout);
+	bool idle() const;
+	bool connected() const;
+	const Stats &stats() const;
+
+private:
+	/** A request waiting or in flight */
+	struct Pending {
+		int address;
+		std::string command;				///< without address and id
+		std::string state;					///< of a set point, else empty
+		long value;
+		Callback done;
+		uint64_t serial;					///< order of the calls
+		uint16_t tag;
+		int retries;
+		Clock::time_point sent;
+	};
+
+	void open_link();
+	void close_link();
+	void pump();
+	void flush();
+	void receive();
+	void reply(const std::string &line);
+	void expire(Clock::time_point now);
+	void fail(Pending &pending, Status status);
+	void complete(Pending &pending, const Reply &answer);
+	void deliver();
+	void forget(int address, const std::string &state);
+	bool newer(const Pending &pending) const;
+	int room(int address, Clock::time_point now);
+	bool room_for_set(int address) const;
+	static std::string prefix(int address);
+
+	Opener opener_;
+	Options options_;
+	Stats stats_;
+	Notify notify_;
+	int fd_ = -1;
+	bool opened_ = false;					///< the link has been open before
+	Clock::time_point reopen_at_;
+	Clock::time_point received_;			///< last character from the link
+	std::chrono::milliseconds backoff_{0};
+	uint64_t serial_ = 0;
+	uint16_t tag_ = 0;
+	std::deque<Pending> waiting_;			///< in the order of the calls
+	std::map<int, std::deque<Pending>> flight_;	///< by address, in the order sent
+	std::deque<Clock::time_point> broadcasts_;	///< until then in the queues
+	std::map<std::pair<int, std::string>, long> last_;	///< set point sent by lamp and state
+	std::deque<std::pair<Callback, Reply>> completed_;	///< callbacks not called yet
+	std::string tx_;						///< written when the link takes it
+	std::string rx_;						///< line being received
+};
+
+}
+
+#endif
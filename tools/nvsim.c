@@ -0,0 +1,174 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host tool: power loss at every flash step of the settings store
+ *
+ * Runs the settings store of the firmware (src/nvstore.c) on an emulated
+ * flash (NV_FLASH_EMULATION) and cuts the power at every single flash
+ * operation of a workload: each record, each erase and each word
+ * of a compaction, at the first and at the second half of the page log.
+ * @n After each cut the lamp boots again (NV_Init()) and every key is checked:
+ * - a key keeps the value of its last completed NV_Flush()
+ *   or has the value that was being written at the cut,
+ * - a key that never had a value has none,
+ * - a value written after the boot is stored and read back,
+ *   so a torn record or page does not block the log.
+ *
+ * The workload writes KEY_USED keys one after the other, each followed by
+ * NV_Flush() like NV_Process() after the commit delay. It starts from a log
+ * that has already been filled PREFILL_WRITES times, so it runs through
+ * several compactions and wraps around the NV_PAGE_COUNT pages.
+ *
+ * Usage (on the PC, not on the target):
+ * @n gcc -DNV_FLASH_EMULATION -I../src/inc -o nvsim nvsim.c ../src/nvstore.c
+ * @n ./nvsim [-v]
+ *
+ * -v prints every failing check instead of the first 10.
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "nvstore.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define PAGE_WORDS			(512 / 4)		///< NV_PAGE_WORDS of nvstore.c
+#define FLASH_WORDS			(NV_PAGE_COUNT * PAGE_WORDS)
+#define KEY_USED			12				///< keys written by the workload
+#define PREFILL_WRITES		250				///< writes before the workload
+#define WORKLOAD_WRITES		200				///< writes with a power loss each step
+#define BUDGET_UNLIMITED	1000000000		///< flash operations, never reached
+
+/** What a key may hold after the boot */
+typedef struct {
+	bool valid;								///< has a value
+	uint32_t durable;						///< value of the last completed flush
+	bool pending;							///< a flush was cut
+	uint32_t written;						///< value of that flush
+} expected_t;
+
+static uint32_t snapshot[FLASH_WORDS];		///< flash before the workload
+static bool verbose = false;
+static int failures = 0;
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Value of a write of the workload
+ * @param [in] write number
+ * @return key in the low byte, so no two writes have the same value
+ *****************************************************************************/
+static uint32_t value_of(uint32_t write) {
+	return (write << 8) | (write % KEY_USED);
+}
+
+/** ***************************************************************************
+ * @brief Write and flush one value, as the firmware does
+ * @param [in] write number
+ *****************************************************************************/
+static void write_flush(uint32_t write) {
+	NV_Write(write % KEY_USED, value_of(write));
+	NV_Flush();
+}
+
+/** ***************************************************************************
+ * @brief Report a failed check
+ * @param [in] cut flash operation of the power loss
+ * @param [in] key checked
+ * @param [in] what went wrong
+ *****************************************************************************/
+static void fail(int32_t cut, uint32_t key, const char *what) {
+	if (verbose || (failures < 10)) {
+		printf("power loss at step %ld: key %lu %s\n", (long)cut, (unsigned long)key, what);
+	}
+	failures++;
+}
+
+/** ***************************************************************************
+ * @brief Run the workload with a power loss and check the boot after it
+ * @param [in] cut flash operations before the power loss, 1 = the first
+ *****************************************************************************/
+static void cut_at(int32_t cut) {
+	expected_t key[NV_KEY_COUNT];
+	memcpy(NV_emulation_flash, snapshot, sizeof(snapshot));
+	NV_emulation_budget = -1;
+	NV_Init();
+	for (uint32_t k = 0; k < NV_KEY_COUNT; k++) {
+		key[k].valid = NV_Read(k, &key[k].durable);
+		key[k].pending = false;
+	}
+	NV_emulation_budget = cut;
+	for (uint32_t write = PREFILL_WRITES;
+			(write < PREFILL_WRITES + WORKLOAD_WRITES) && NV_emulation_budget; write++) {
+		write_flush(write);
+		expected_t *k = &key[write % KEY_USED];
+		if (NV_emulation_budget) {			// power still on, the flush is done
+			k->valid = true;
+			k->durable = value_of(write);
+		} else {
+			k->pending = true;
+			k->written = value_of(write);
+		}
+	}
+	/* boot again */
+	NV_emulation_budget = -1;
+	NV_Init();
+	for (uint32_t k = 0; k < NV_KEY_COUNT; k++) {
+		uint32_t value;
+		bool valid = NV_Read(k, &value);
+		if (!valid) {
+			if (key[k].valid) { fail(cut, k, "lost its value"); }
+		} else if (key[k].pending && (value == key[k].written)) {
+			;								// the cut flush made it
+		} else if (!key[k].valid) {
+			fail(cut, k, "got a value it never had");
+		} else if (value != key[k].durable) {
+			fail(cut, k, "has a wrong value");
+		}
+	}
+	/* the log goes on after the boot */
+	NV_Write(0, 0xC0FFEEu);
+	NV_Flush();
+	NV_Init();
+	uint32_t value = 0;
+	if (!NV_Read(0, &value) || (value != 0xC0FFEEu)) {
+		fail(cut, 0, "not written after the boot");
+	}
+}
+
+/** ***************************************************************************
+ * @brief Prepare the log, count the steps of the workload and cut each one
+ *****************************************************************************/
+int main(int argc, char *argv[]) {
+	verbose = (argc > 1) && (0 == strcmp(argv[1], "-v"));
+	memset(NV_emulation_flash, 0xFF, sizeof(snapshot));	// erased flash
+	NV_Init();
+	for (uint32_t write = 0; write < PREFILL_WRITES; write++) {
+		write_flush(write);
+	}
+	memcpy(snapshot, NV_emulation_flash, sizeof(snapshot));
+	/* the workload without power loss gives the number of steps */
+	NV_Init();
+	NV_emulation_budget = BUDGET_UNLIMITED;
+	for (uint32_t write = PREFILL_WRITES; write < PREFILL_WRITES + WORKLOAD_WRITES; write++) {
+		write_flush(write);
+	}
+	int32_t steps = BUDGET_UNLIMITED - NV_emulation_budget;
+	for (int32_t cut = 1; cut <= steps; cut++) {
+		cut_at(cut);
+	}
+	printf("%ld flash steps of %d writes cut, %d failures\n",
+			(long)steps, WORKLOAD_WRITES, failures);
+	printf("%s\n", failures ? "FAILED" : "passed");
+	return failures ? 1 : 0;
+}
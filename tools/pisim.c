@@ -0,0 +1,108 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host tool: current regulation of RGB against a plant model
+ *
+ * Runs the PI controller of the firmware, REG_PI_Step() of regulation.h,
+ * with the parameters of regulation.c against a model of one LED channel:
+ * - the driver gives gain times the nominal current (tolerance of the
+ *   driver and the LED, 0.8 ... 1.2), times the trim,
+ * - the shunt with its RC filter is a first order low pass,
+ *   FILTER of the difference per PWM period,
+ * - the ADC rounds and clips to 12 bit.
+ *
+ * For every gain and set point the periods until the average current stays
+ * within SETTLE_OK of the set point are counted, the error after
+ * PERIOD_COUNT periods must be below ERROR_OK. Both are at least one
+ * ADC code, the resolution of the measurement at low set points.
+ * @n A set point near full scale with a driver above nominal clips the ADC,
+ * the controller then only sees the limit and settles slower.
+ * The exit code tells whether all cases passed.
+ *
+ * Usage (on the PC, not on the target):
+ * @n gcc -I../src/inc -o pisim pisim.c
+ * @n ./pisim
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include "regulation.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define KP					1024			///< REG_KP of regulation.c
+#define KI					512				///< REG_KI
+#define TRIM_LIMIT			1024			///< REG_TRIM_LIMIT
+#define FILTER				0.3				///< low pass of driver and shunt
+#define PERIOD_COUNT		500				///< PWM periods per case
+#define SETTLE_OK			2.0				///< % of the set point
+#define SETTLE_MAX			100				///< periods allowed to settle
+#define ERROR_OK			0.5				///< % of the set point at the end
+#define ADC_CODE			1.0				///< tolerance at least one code
+
+static const double gain[] = { 0.8, 0.9, 1.0, 1.1, 1.2 };	///< of the driver
+static const int32_t setpoint[] = { 16, 200, 1000, 4000 };	///< ADC codes
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Regulate one channel, as REG_DmaDone() does each period
+ * @param [in] g gain of the driver
+ * @param [in] sp set point in ADC codes
+ * @param [out] settle periods until within SETTLE_OK for good, -1 = never
+ * @return error after PERIOD_COUNT periods in ADC codes
+ *****************************************************************************/
+static double run(double g, int32_t sp, int32_t *settle) {
+	double band = sp * SETTLE_OK / 100;
+	if (band < ADC_CODE) { band = ADC_CODE; }
+	REG_pi_t pi = { .kp = KP, .ki = KI, .limit = TRIM_LIMIT, .integral = 0 };
+	int32_t trim = REG_TRIM_ONE;
+	double current = 0;
+	double error = 0;
+	*settle = -1;
+	for (int32_t period = 0; period < PERIOD_COUNT; period++) {
+		current += (sp * g * trim / REG_TRIM_ONE - current) * FILTER;
+		int32_t sample = (int32_t)(current + 0.5);
+		if (sample > 4095) { sample = 4095; }
+		trim = REG_TRIM_ONE + REG_PI_Step(&pi, (sp - sample) * 4096 / sp);
+		error = current - sp;
+		if ((error < band) && (error > -band)) {
+			if (*settle < 0) { *settle = period; }
+		} else {
+			*settle = -1;
+		}
+	}
+	return error;
+}
+
+/** ***************************************************************************
+ * @brief Settling and final error of all gains and set points
+ *****************************************************************************/
+int main(void) {
+	int failures = 0;
+	printf("gain  set point  final error %%  settled after periods\n");
+	for (uint32_t i = 0; i < sizeof(gain) / sizeof(gain[0]); i++) {
+		for (uint32_t j = 0; j < sizeof(setpoint) / sizeof(setpoint[0]); j++) {
+			int32_t settle;
+			double error = run(gain[i], setpoint[j], &settle);
+			double limit = setpoint[j] * ERROR_OK / 100;
+			if (limit < ADC_CODE) { limit = ADC_CODE; }
+			printf("%4.1f  %9ld  %13.2f  %21ld\n", gain[i], (long)setpoint[j],
+					error * 100 / setpoint[j], (long)settle);
+			if ((error > limit) || (error < -limit)
+					|| (settle < 0) || (settle > SETTLE_MAX)) {
+				failures++;
+			}
+		}
+	}
+	printf("%s\n", failures ? "FAILED" : "passed");
+	return failures ? 1 : 0;
+}
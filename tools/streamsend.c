@@ -0,0 +1,261 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host tool: send a colour stream to the lamp
+ *
+ * Starts a stream with "stream <delay>", switches to the baud rate
+ * of the answer and sends frames of a colour wheel at the given rate
+ * (see src/stream.c for the frame format).
+ * At the end the counters of the lamp are queried with "jit 0" ... "jit 4".
+ *
+ * Usage (on the PC, not on the target):
+ * @n gcc -o streamsend streamsend.c
+ * @n ./streamsend /dev/rfcomm0 [fps [seconds [delay_ms [jitter_ms]]]]
+ *
+ * jitter_ms delays each frame by a random time up to this value,
+ * to see how the jitter buffer of the lamp copes with a bad link.
+ *
+ * Without a lamp, a pair of pseudo-terminals and tools/streamsink.c
+ * stand in for the Bluetooth serial link and the firmware:
+ * @n socat -d -d pty,raw,echo=0 pty,raw,echo=0
+ * @n ./streamsink /dev/pts/3 &
+ * @n ./streamsend /dev/pts/4 100 10 40 20
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#define _DEFAULT_SOURCE
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define END_OF_STRING		'\r'			///< COM_END_OF_STRING of the firmware
+#define TEXT_BAUDRATE		B9600			///< COM_BAUDRATE of the firmware
+#define LINE_LENGTH			64				///< max length of an answer
+#define ANSWER_TIMEOUT_MS	1000			///< wait this long for an answer
+#define SWITCH_MS			50				///< time of the lamp to switch the link
+
+#define SYNC				0xA5			///< STR_SYNC
+#define TIME_END			0xFFFF			///< STR_TIME_END
+#define CHANNEL_COUNT		5				///< white, amber, red, green, blue
+#define FRAME_SIZE			(3 + CHANNEL_COUNT + 1)	///< STR_FRAME_SIZE
+#define COUNTER_COUNT		5				///< STR_COUNTER_COUNT
+
+static const char *counter_name[COUNTER_COUNT] = {
+		"frames", "late", "underruns", "overruns", "errors"
+};
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Get a monotonic time
+ * @return time in ms
+ *****************************************************************************/
+static uint64_t now_ms(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint64_t)t.tv_sec * 1000 + t.tv_nsec / 1000000;
+}
+
+/** ***************************************************************************
+ * @brief Set the serial port to raw mode at a baud rate
+ * @param [in] fd of the serial port
+ * @param [in] speed e.g. B9600
+ *****************************************************************************/
+static void set_baudrate(int fd, speed_t speed) {
+	struct termios tio;
+	tcgetattr(fd, &tio);
+	cfmakeraw(&tio);
+	cfsetispeed(&tio, speed);
+	cfsetospeed(&tio, speed);
+	tcsetattr(fd, TCSADRAIN, &tio);
+}
+
+/** ***************************************************************************
+ * @brief Map a baud rate to the termios constant
+ * @param [in] baudrate e.g. 115200
+ * @return termios speed, B0 if not supported
+ *****************************************************************************/
+static speed_t speed_of(long baudrate) {
+	switch (baudrate) {
+	case 9600:		return B9600;
+	case 19200:		return B19200;
+	case 38400:		return B38400;
+	case 57600:		return B57600;
+	case 115200:	return B115200;
+	case 230400:	return B230400;
+	default:		return B0;
+	}
+}
+
+/** ***************************************************************************
+ * @brief Send a command line
+ * @param [in] fd of the serial port
+ * @param [in] command without end of string
+ *****************************************************************************/
+static void send_command(int fd, const char *command) {
+	char line[LINE_LENGTH];
+	int n = snprintf(line, sizeof(line), "%s%c", command, END_OF_STRING);
+	if (write(fd, line, n) != n) {
+		perror("write");
+	}
+}
+
+/** ***************************************************************************
+ * @brief Read the answer starting with a text, skip notifications
+ * @param [in] fd of the serial port
+ * @param [in] text e.g. "stream"
+ * @param [out] value after the text
+ * @return 0 = answer received, -1 = timeout
+ *****************************************************************************/
+static int read_answer(int fd, const char *text, long *value) {
+	char line[LINE_LENGTH];
+	size_t length = 0;
+	uint64_t end = now_ms() + ANSWER_TIMEOUT_MS;
+	while (now_ms() < end) {
+		struct pollfd p = { .fd = fd, .events = POLLIN };
+		if (poll(&p, 1, 10) <= 0) {
+			continue;
+		}
+		char c;
+		if (read(fd, &c, 1) != 1) {
+			continue;
+		}
+		if ((END_OF_STRING != c) && ('\n' != c)) {
+			if (length < sizeof(line) - 1) {
+				line[length++] = c;
+			}
+			continue;
+		}
+		line[length] = '\0';
+		length = 0;
+		size_t n = strlen(text);
+		if ((0 == strncmp(line, text, n)) && (' ' == line[n])) {
+			*value = strtol(line + n + 1, NULL, 10);
+			return 0;
+		}
+	}
+	return -1;
+}
+
+/** ***************************************************************************
+ * @brief Send one frame
+ * @param [in] fd of the serial port
+ * @param [in] time stamp in ms
+ * @param [in] value set points, NULL for the end of the stream
+ *****************************************************************************/
+static void send_frame(int fd, uint16_t time, const uint8_t value[CHANNEL_COUNT]) {
+	uint8_t frame[FRAME_SIZE] = { SYNC, time & 0xFF, time >> 8 };
+	uint8_t sum = frame[1] + frame[2];
+	for (int i = 0; i < CHANNEL_COUNT; i++) {
+		frame[3 + i] = value ? value[i] : 0;
+		sum += frame[3 + i];
+	}
+	frame[FRAME_SIZE - 1] = -sum;			// all bytes after SYNC add up to 0
+	if (write(fd, frame, FRAME_SIZE) != FRAME_SIZE) {
+		perror("write");
+	}
+}
+
+/** ***************************************************************************
+ * @brief Colour wheel: red, green and blue one after the other
+ * @param [in] phase 0 ... 767
+ * @param [out] value set points, white and amber off
+ *****************************************************************************/
+static void colour_wheel(uint32_t phase, uint8_t value[CHANNEL_COUNT]) {
+	uint32_t step = phase % 256;
+	memset(value, 0, CHANNEL_COUNT);
+	switch ((phase / 256) % 3) {
+	case 0:  value[2] = 255 - step; value[3] = step; break;
+	case 1:  value[3] = 255 - step; value[4] = step; break;
+	default: value[4] = 255 - step; value[2] = step; break;
+	}
+}
+
+/** ***************************************************************************
+ * @brief Stream to the lamp and report its counters
+ *****************************************************************************/
+int main(int argc, char *argv[]) {
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s port [fps [seconds [delay_ms [jitter_ms]]]]\n", argv[0]);
+		return 1;
+	}
+	int fps = (argc > 2) ? atoi(argv[2]) : 50;
+	int seconds = (argc > 3) ? atoi(argv[3]) : 10;
+	int delay = (argc > 4) ? atoi(argv[4]) : 40;
+	int jitter = (argc > 5) ? atoi(argv[5]) : 0;
+	if ((fps <= 0) || (fps > 1000)) {
+		fprintf(stderr, "fps must be 1 ... 1000\n");
+		return 1;
+	}
+
+	int fd = open(argv[1], O_RDWR | O_NOCTTY);
+	if (fd < 0) {
+		perror(argv[1]);
+		return 1;
+	}
+	set_baudrate(fd, TEXT_BAUDRATE);
+	tcflush(fd, TCIOFLUSH);
+
+	char command[LINE_LENGTH];
+	snprintf(command, sizeof(command), "stream %d", delay);
+	send_command(fd, command);
+	long baudrate;
+	if (read_answer(fd, "stream", &baudrate) || (B0 == speed_of(baudrate))) {
+		fprintf(stderr, "no answer to \"%s\"\n", command);
+		return 1;
+	}
+	usleep(SWITCH_MS * 1000);
+	set_baudrate(fd, speed_of(baudrate));
+	printf("streaming %d fps for %d s at %ld baud, delay %d ms, jitter %d ms\n",
+			fps, seconds, baudrate, delay, jitter);
+
+	uint64_t start = now_ms();
+	uint64_t next = start;
+	for (int frame = 0; frame < fps * seconds; frame++) {
+		uint64_t time = next;				// time stamp = planned send time
+		if (jitter) {
+			next += rand() % (jitter + 1);
+		}
+		int64_t wait = (int64_t)(next - now_ms());
+		if (wait > 0) {
+			usleep(wait * 1000);
+		}
+		uint8_t value[CHANNEL_COUNT];
+		colour_wheel(frame * 768 / (2 * fps), value);	// one turn in 2 s
+		uint16_t stamp = (time - start) & 0xFFFF;
+		if (TIME_END == stamp) {
+			stamp = 0;						// reserved for the end
+		}
+		send_frame(fd, stamp, value);
+		next = time + 1000 / fps;
+	}
+	send_frame(fd, TIME_END, NULL);
+
+	usleep((delay + SWITCH_MS) * 1000);		// the lamp shows the rest and switches
+	set_baudrate(fd, TEXT_BAUDRATE);
+	tcflush(fd, TCIFLUSH);
+	for (int counter = 0; counter < COUNTER_COUNT; counter++) {
+		long value = -1;
+		snprintf(command, sizeof(command), "jit %d", counter);
+		send_command(fd, command);
+		read_answer(fd, "jit", &value);
+		printf("%-10s %ld\n", counter_name[counter], value);
+	}
+	close(fd);
+	return 0;
+}
@@ -0,0 +1,166 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host tool: stand-in for the lamp at the end of a colour stream
+ *
+ * Runs the jitter buffer of the firmware (src/stream.c) on the PC
+ * behind a pseudo-terminal, so tools/streamsend.c can be tried without
+ * the lamp and the Bluetooth link.
+ * @n It answers "stream <delay>" and "jit <counter>" like the firmware,
+ * takes the frames like the RX interrupt and shows them
+ * like the TIMER0 interrupt once per PWM period.
+ * Each frame shown is printed with its time in ms.
+ *
+ * Usage (on the PC, not on the target):
+ * @n gcc -I../src/inc -o streamsink streamsink.c ../src/stream.c
+ * @n socat -d -d pty,raw,echo=0 pty,raw,echo=0
+ * @n ./streamsink /dev/pts/3 [-q]
+ *
+ * -q prints only the counters at the end of each stream.
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#define _DEFAULT_SOURCE
+
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "stream.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define END_OF_STRING		'\r'			///< COM_END_OF_STRING of the firmware
+#define STREAM_BAUDRATE		115200			///< COM_STREAM_BAUDRATE of the firmware
+#define LINE_LENGTH			64				///< max length of a command
+#define PWM_PERIOD_US		2000			///< default PWM period of TIMER0
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Get the time like the sleeptimer
+ * @return time in ticks of STR_TICK_HZ
+ *****************************************************************************/
+static uint32_t now_ticks(void) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (uint32_t)((uint64_t)t.tv_sec * STR_TICK_HZ
+			+ (uint64_t)t.tv_nsec * STR_TICK_HZ / 1000000000);
+}
+
+/** ***************************************************************************
+ * @brief Send an answer
+ * @param [in] fd of the pseudo-terminal
+ * @param [in] text e.g. the name of the command
+ * @param [in] value after the text
+ *****************************************************************************/
+static void answer(int fd, const char *text, long value) {
+	char line[LINE_LENGTH];
+	int n = snprintf(line, sizeof(line), "%s %ld%c", text, value, END_OF_STRING);
+	if (write(fd, line, n) != n) {
+		perror("write");
+	}
+}
+
+/** ***************************************************************************
+ * @brief Execute a command line like the firmware
+ * @param [in] fd of the pseudo-terminal
+ * @param [in] line without end of string
+ *****************************************************************************/
+static void command(int fd, const char *line) {
+	long value = STR_DELAY_MS;
+	if (0 == strncmp(line, "stream", 6)) {
+		if (' ' == line[6]) {
+			value = strtol(line + 7, NULL, 10);
+		}
+		if ((value < 0) || (value > STR_DELAY_MAX_MS)) {
+			answer(fd, "err", 2);
+			return;
+		}
+		answer(fd, "stream", STREAM_BAUDRATE);
+		STR_Start(value, now_ticks());
+	} else if (0 == strncmp(line, "jit ", 4)) {
+		value = strtol(line + 4, NULL, 10);
+		if ((value < 0) || (value >= STR_COUNTER_COUNT)) {
+			answer(fd, "err", 2);
+			return;
+		}
+		answer(fd, "jit", STR_GetCounter(value));
+	} else if (line[0]) {
+		answer(fd, "err", 1);
+	}
+}
+
+/** ***************************************************************************
+ * @brief Serve the pseudo-terminal forever
+ *****************************************************************************/
+int main(int argc, char *argv[]) {
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s pty [-q]\n", argv[0]);
+		return 1;
+	}
+	int quiet = (argc > 2) && (0 == strcmp(argv[2], "-q"));
+	int fd = open(argv[1], O_RDWR | O_NOCTTY);
+	if (fd < 0) {
+		perror(argv[1]);
+		return 1;
+	}
+	struct termios tio;
+	tcgetattr(fd, &tio);
+	cfmakeraw(&tio);
+	tcsetattr(fd, TCSANOW, &tio);
+
+	char line[LINE_LENGTH];
+	size_t length = 0;
+	int streaming = 0;
+	uint32_t start = now_ticks();
+	for (;;) {
+		struct pollfd p = { .fd = fd, .events = POLLIN };
+		if (poll(&p, 1, PWM_PERIOD_US / 1000) > 0) {	// RX interrupt
+			uint8_t buffer[256];
+			ssize_t n = read(fd, buffer, sizeof(buffer));
+			for (ssize_t i = 0; i < n; i++) {
+				if (streaming) {
+					STR_Receive(buffer[i], now_ticks());
+				} else if (END_OF_STRING == buffer[i]) {
+					line[length] = '\0';
+					length = 0;
+					command(fd, line);
+					streaming = STR_Active();
+				} else if (length < sizeof(line) - 1) {
+					line[length++] = buffer[i];
+				}
+			}
+		}
+
+		if (streaming) {					// TIMER0 interrupt
+			uint8_t value[PWR_SOLUTION_COUNT];
+			uint32_t now = now_ticks();
+			if (STR_Next(now, value) && !quiet) {
+				printf("%8u ms  W %3u  A %3u  R %3u  G %3u  B %3u\n",
+						(unsigned)((uint64_t)(now - start) * 1000 / STR_TICK_HZ),
+						value[0], value[1], value[2], value[3], value[4]);
+			}
+			if (!STR_Active()) {			// back to the commands
+				streaming = 0;
+				printf("end of stream: frames %u late %u underruns %u overruns %u errors %u\n",
+						STR_GetCounter(STR_FRAMES), STR_GetCounter(STR_LATE),
+						STR_GetCounter(STR_UNDERRUNS), STR_GetCounter(STR_OVERRUNS),
+						STR_GetCounter(STR_ERRORS));
+				fflush(stdout);
+			}
+		}
+	}
+}
@@ -0,0 +1,355 @@
+/** ***************************************************************************
+ * @file
+ * @brief Host tool: synchronisation of lamps with drifting clocks
+ *
+ * Simulates a master and a number of lamps, each running the
+ * synchronisation of the firmware (src/timesync.c) in its own process.
+ * The clock of each lamp drifts by a few 10 ppm and starts at a random time.
+ * @n The master sends its time to all the lamps once per second
+ * ("ts t1" as broadcast) and polls one lamp after the other in between
+ * ("ts t1 t4", answered). The link adds a delay and a random jitter,
+ * the lamp answers within a main loop tick like the firmware.
+ * Half way the master sets its time 1 h ahead, e.g. at midnight.
+ *
+ * The scene time of each lamp is compared with the master every 100 ms.
+ * After the lamps have settled (SETTLE_S, STEP_SETTLE_S), the lamps must
+ * stay within 1 ms of each other (the phase of a shared scene),
+ * the exit code tells.
+ * @n With the default jitter of 2 ms (a wired link or USB) this holds
+ * for up to 16 lamps on a bus and 8 lamps with links of their own.
+ * With more jitter the delays of the lamps are less certain,
+ * e.g. 1 ... 2 ms apart with 5 ms of jitter.
+ *
+ * Usage (on the PC, not on the target):
+ * @n gcc -I../src/inc -o tssim tssim.c ../src/timesync.c -lm
+ * @n ./tssim [lamps [jitter_ms [seconds]]] [-s]
+ *
+ * Without -s the lamps share a bus: a broadcast reaches all of them
+ * at the same time. With -s each lamp has a link of its own,
+ * e.g. Bluetooth, and the jitter differs from lamp to lamp.
+ *
+ * @author schmiaa1@students.zhaw.ch, bodenma2@students.zhaw.ch
+ * @date 19.10.2026
+ *****************************************************************************/
+
+#define _DEFAULT_SOURCE
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "timesync.h"
+
+
+/******************************************************************************
+ * Defines
+ *****************************************************************************/
+#define LAMP_MAX			32				///< max number of lamps
+#define SECONDS_MAX			3600			///< max simulated time
+#define CHECK_PER_S			10				///< comparisons with the master
+#define DRIFT_PPM			100				///< drift of the lamps -100 ... +100 ppm
+#define BASE_DELAY_MS		5.0				///< delay of the link without jitter
+#define LOOP_MS				20.0			///< EMM_TICK_MS: the reply waits up to this
+#define REPLY_MS			8.3				///< "ts -123\r" at 9600 baud
+#define SETTLE_S			180				///< not checked after the start
+#define STEP_UNITS			(3600L * 1000 * TS_UNITS_PER_MS)	///< time set by the master
+#define STEP_SETTLE_S		20			///< not checked after the time is set
+#define PHASE_MAX_US		1000			///< max difference between the lamps
+
+/** Random delays of one second of the schedule, the same for all the lamps */
+typedef struct {
+	double broadcast[LAMP_MAX];				///< delay of the broadcast per lamp in s
+	double request;							///< delay of the request in s
+	double loop;							///< until the reply is sent in s
+	double reply;							///< delay of the reply in s
+} second_t;
+
+/** Events of a lamp */
+enum {
+	EVENT_CHECK,							///< compare with the master
+	EVENT_BROADCAST,						///< "ts t1" received, not answered
+	EVENT_POLL,								///< "ts t1 t4" received, answered
+};
+
+/** An event of a lamp at a true time */
+typedef struct {
+	double time;							///< true time in s
+	int type;
+	int32_t t1;								///< of the request
+	uint32_t t3;							///< of the last reply, 0 = none
+	int32_t t4;								///< of the last reply
+} event_t;
+
+/** Result of a lamp */
+typedef struct {
+	int32_t info[TS_INFO_COUNT];
+	int32_t error[SECONDS_MAX * CHECK_PER_S];	///< scene - master in us
+} result_t;
+
+static second_t schedule[SECONDS_MAX];
+static int lamp_count = 4;
+static int seconds = 600;
+static event_t event[SECONDS_MAX * (CHECK_PER_S + 2)];
+static int event_count = 0;
+
+
+/******************************************************************************
+ * Functions
+ *****************************************************************************/
+
+/** ***************************************************************************
+ * @brief Random number
+ * @return 0 ... 1
+ *****************************************************************************/
+static double uniform(void) {
+	return (double)rand() / RAND_MAX;
+}
+
+/** ***************************************************************************
+ * @brief Time of the master
+ * @param [in] t true time in s
+ * @return time in TS_UNITS_PER_MS, set ahead half way
+ *****************************************************************************/
+static int32_t master_time(double t) {
+	int64_t time = (int64_t)floor(t * 1000 * TS_UNITS_PER_MS);
+	if (t >= seconds / 2) {
+		time += STEP_UNITS;
+	}
+	return (int32_t)time;
+}
+
+/** ***************************************************************************
+ * @brief Clock of a lamp
+ * @param [in] lamp number
+ * @param [in] t true time in s
+ * @return sleeptimer tick
+ *****************************************************************************/
+static uint32_t lamp_tick(int lamp, double t) {
+	double ppm = (lamp_count > 1) ? -DRIFT_PPM + 2.0 * DRIFT_PPM * lamp / (lamp_count - 1) : DRIFT_PPM;
+	double start = 1000.0 + 7919.0 * lamp;	// any time since the reset
+	return (uint32_t)(uint64_t)floor((t * (1 + ppm * 1e-6) + start) * TS_TICK_HZ);
+}
+
+/** ***************************************************************************
+ * @brief Add an event of a lamp
+ * @param [in] time true time in s
+ * @param [in] type of the event
+ * @param [in] t1 of a request
+ * @param [in] t3 of the previous reply, 0 = none
+ * @param [in] t4 of the previous reply
+ *****************************************************************************/
+static void add_event(double time, int type, int32_t t1, uint32_t t3, int32_t t4) {
+	event_t *e = &event[event_count++];
+	e->time = time;
+	e->type = type;
+	e->t1 = t1;
+	e->t3 = t3;
+	e->t4 = t4;
+}
+
+/** ***************************************************************************
+ * @brief Order of the events
+ *****************************************************************************/
+static int compare_events(const void *a, const void *b) {
+	double ta = ((const event_t *)a)->time;
+	double tb = ((const event_t *)b)->time;
+	return (ta > tb) - (ta < tb);
+}
+
+/** ***************************************************************************
+ * @brief Run one lamp through the schedule
+ * @param [in] lamp number
+ * @param [out] result of the lamp
+ *
+ * Per second: a broadcast at .0 and a check every 100 ms,
+ * a poll at .5 if it's the turn of this lamp.
+ * The lamp completes the last exchange with t4 of the next poll.
+ *****************************************************************************/
+static void run_lamp(int lamp, result_t *result) {
+	uint32_t t3 = 0;
+	int32_t t4 = 0;
+	event_count = 0;
+	for (int second = 0; second < seconds; second++) {
+		const second_t *s = &schedule[second];
+		for (int check = 0; check < CHECK_PER_S; check++) {
+			add_event(second + (double)check / CHECK_PER_S, EVENT_CHECK, 0, 0, 0);
+		}
+		add_event(second + s->broadcast[lamp], EVENT_BROADCAST, master_time(second), 0, 0);
+		if (second % lamp_count == lamp) {
+			double sent = second + 0.5;
+			double received = sent + s->request;
+			add_event(received, EVENT_POLL, master_time(sent), t3, t4);
+			double answered = received + s->loop + REPLY_MS / 1000;
+			t3 = lamp_tick(lamp, answered);
+			t4 = master_time(answered + s->reply);
+		}
+	}
+	qsort(event, event_count, sizeof(event[0]), compare_events);
+
+	for (int i = 0; i < event_count; i++) {
+		const event_t *e = &event[i];
+		uint32_t tick = lamp_tick(lamp, e->time);
+		switch (e->type) {
+		case EVENT_CHECK: {
+			int32_t scene = (int32_t)TS_SceneTime(tick);
+			int check = (int)lround(e->time * CHECK_PER_S);
+			result->error[check] = (scene - master_time(e->time)) * (1000 / TS_UNITS_PER_MS);
+			break;
+		}
+		case EVENT_BROADCAST:
+			TS_Request(e->t1, tick, false);
+			break;
+		default:							// like UI_cmd_ts()
+			if (e->t3) {
+				TS_Response(e->t3, e->t4);
+			}
+			TS_Request(e->t1, tick, true);
+			break;
+		}
+	}
+	for (int info = 0; info < TS_INFO_COUNT; info++) {
+		result->info[info] = TS_GetInfo(info);
+	}
+}
+
+/** ***************************************************************************
+ * @brief Check if a comparison counts, i.e. the lamps should have settled
+ * @param [in] check number of the comparison
+ * @return true = counts
+ *****************************************************************************/
+static int settled(int check) {
+	int second = check / CHECK_PER_S;
+	if (second < SETTLE_S) {
+		return 0;
+	}
+	return (second < seconds / 2) || (second >= seconds / 2 + STEP_SETTLE_S);
+}
+
+/** ***************************************************************************
+ * @brief Simulate the lamps and check their phase
+ *****************************************************************************/
+int main(int argc, char *argv[]) {
+	double jitter_ms = 2;
+	int separate = 0;
+	int position = 0;
+	for (int i = 1; i < argc; i++) {
+		if (0 == strcmp(argv[i], "-s")) {
+			separate = 1;
+		} else {
+			switch (position++) {
+			case 0:  lamp_count = atoi(argv[i]); break;
+			case 1:  jitter_ms = atof(argv[i]); break;
+			default: seconds = atoi(argv[i]); break;
+			}
+		}
+	}
+	if ((lamp_count < 1) || (lamp_count > LAMP_MAX)
+			|| (seconds < 2 * (SETTLE_S + STEP_SETTLE_S)) || (seconds > SECONDS_MAX)) {
+		fprintf(stderr, "usage: %s [lamps [jitter_ms [seconds]]] [-s]\n"
+				"lamps 1 ... %d, seconds %d ... %d\n", argv[0],
+				LAMP_MAX, 2 * (SETTLE_S + STEP_SETTLE_S), SECONDS_MAX);
+		return 1;
+	}
+
+	srand(1);
+	for (int second = 0; second < seconds; second++) {
+		second_t *s = &schedule[second];
+		double common = uniform() * jitter_ms;
+		for (int lamp = 0; lamp < lamp_count; lamp++) {
+			double jitter = separate ? uniform() * jitter_ms : common;
+			s->broadcast[lamp] = (BASE_DELAY_MS + jitter) / 1000;
+		}
+		s->request = (BASE_DELAY_MS + uniform() * jitter_ms) / 1000;
+		s->loop = uniform() * LOOP_MS / 1000;
+		s->reply = (BASE_DELAY_MS + uniform() * jitter_ms) / 1000;
+	}
+
+	static result_t result[LAMP_MAX];
+	for (int lamp = 0; lamp < lamp_count; lamp++) {
+		int fd[2];
+		if (pipe(fd)) {
+			perror("pipe");
+			return 1;
+		}
+		pid_t pid = fork();
+		if (0 == pid) {						// a lamp of its own
+			close(fd[0]);
+			run_lamp(lamp, &result[lamp]);
+			const char *p = (const char *)&result[lamp];
+			size_t n = sizeof(result[lamp]);
+			while (n) {
+				ssize_t w = write(fd[1], p, n);
+				if (w <= 0) {
+					_exit(1);
+				}
+				p += w;
+				n -= w;
+			}
+			_exit(0);
+		}
+		close(fd[1]);
+		char *p = (char *)&result[lamp];
+		size_t n = sizeof(result[lamp]);
+		while (n) {
+			ssize_t r = read(fd[0], p, n);
+			if (r <= 0) {
+				fprintf(stderr, "lamp %d failed\n", lamp);
+				return 1;
+			}
+			p += r;
+			n -= r;
+		}
+		close(fd[0]);
+		waitpid(pid, NULL, 0);
+	}
+
+	printf("%d lamps, %s, jitter %.1f ms, %d s, master time set ahead at %d s\n",
+			lamp_count, separate ? "separate links" : "bus", jitter_ms, seconds, seconds / 2);
+	printf("lamp  drift ppm  estimate  delay us  samples  outliers  steps  max error us\n");
+	for (int lamp = 0; lamp < lamp_count; lamp++) {
+		double ppm = (lamp_count > 1) ? -DRIFT_PPM + 2.0 * DRIFT_PPM * lamp / (lamp_count - 1) : DRIFT_PPM;
+		int32_t worst = 0;
+		for (int check = 0; check < seconds * CHECK_PER_S; check++) {
+			if (settled(check) && (abs(result[lamp].error[check]) > worst)) {
+				worst = abs(result[lamp].error[check]);
+			}
+		}
+		const int32_t *info = result[lamp].info;
+		printf("%4d  %9.1f  %8.1f  %8d  %7d  %8d  %5d  %12d\n", lamp + 1, ppm,
+				-info[TS_DRIFT_PPB] / 1000.0, info[TS_DELAY_US], info[TS_SAMPLES],
+				info[TS_OUTLIERS], info[TS_STEPS], worst);
+	}
+
+	int32_t phase = 0;
+	double sum = 0;
+	int count = 0;
+	for (int check = 0; check < seconds * CHECK_PER_S; check++) {
+		if (!settled(check)) {
+			continue;
+		}
+		int32_t low = result[0].error[check];
+		int32_t high = low;
+		for (int lamp = 1; lamp < lamp_count; lamp++) {
+			int32_t e = result[lamp].error[check];
+			if (e < low) { low = e; }
+			if (e > high) { high = e; }
+		}
+		if (high - low > phase) {
+			phase = high - low;
+		}
+		sum += (double)(high - low) * (high - low);
+		count++;
+	}
+	printf("phase between the lamps: max %d us, rms %.0f us (limit %d us)\n",
+			phase, sqrt(sum / count), PHASE_MAX_US);
+	if (phase > PHASE_MAX_US) {
+		printf("FAILED\n");
+		return 1;
+	}
+	printf("ok\n");
+	return 0;
+}